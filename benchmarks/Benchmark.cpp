@@ -0,0 +1,513 @@
+/*
+ * IEEE754 constexpr parser toy. Benchmarks.
+ * Thanks to Algolia for giving me the opportunity to develop this toy!
+ * @maintainer Xavier Roche (xavier dot roche at algolia.com)
+ */
+
+/**
+ * Conversion benchmarks, reporting time per value and throughput, against standard references.
+ * Usage: ieee754toy-benchmark [benchmark options] [corpus file ...]
+ * Corpus files are newline-separated values, benchmarked in addition to the generated corpora.
+ * The SIMD level used by the batch parsers can be forced with the IEEE754TOY_SIMD_LEVEL environment variable, and
+ * the "BatchParser@<level>" benchmarks compare every level supported by the CPU.
+ */
+
+#include "Corpora.h"
+
+#include "BatchParser.h"
+#include "BatchScanner.h"
+#include "NumericalFormatter.h"
+#include "NumericalParser.h"
+#include "ParseCache.h"
+#include "ParseSession.h"
+#include "StreamParser.h"
+
+#include <benchmark/benchmark.h>
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#if __has_include(<fast_float/fast_float.h>)
+#include <fast_float/fast_float.h>
+#define IEEE754TOY_BENCHMARK_FAST_FLOAT
+#endif
+
+namespace ieee754toy::benchmarks {
+
+/** Set time per value and throughput counters. **/
+void setCounters(benchmark::State& state, const Corpus& corpus)
+{
+    state.SetBytesProcessed(state.iterations() * corpus.bytes);
+    state.SetItemsProcessed(state.iterations() * corpus.values.size());
+    state.counters["time/value"] =
+        benchmark::Counter(corpus.values.size(), benchmark::Counter::kIsIterationInvariantRate |
+                                                     benchmark::Counter::kInvert);
+}
+
+/** Benchmark a per-value conversion function over a corpus. **/
+template<typename F>
+void run(benchmark::State& state, const Corpus& corpus, const F& convert)
+{
+    for (auto _ : state) {
+        for (const auto& value : corpus.values) {
+            benchmark::DoNotOptimize(convert(value));
+        }
+    }
+    setCounters(state, corpus);
+}
+
+/** Register a per-value conversion benchmark for every corpus. **/
+template<typename F>
+void add(const std::string& name, const std::vector<Corpus>& corpora, const F& convert)
+{
+    for (const auto& corpus : corpora) {
+        benchmark::RegisterBenchmark((name + "/" + corpus.name).c_str(),
+                                     [&corpus, convert](benchmark::State& state) { run(state, corpus, convert); });
+    }
+}
+
+void registerConversionBenchmarks(const std::vector<Corpus>& corpora)
+{
+    // This library
+    add("toDouble", corpora, [](std::string_view value) {
+        bool error;
+        return NumericalParser(value.data(), value.size()).toDouble(error);
+    });
+    add("parse", corpora, [](std::string_view value) {
+        return NumericalParser(value.data(), value.size()).parse<double>();
+    });
+
+    // Decimal outputs, without binary floating point
+    add("parse<ScaledInteger<4>>", corpora, [](std::string_view value) {
+        return NumericalParser(value.data(), value.size()).parse<ScaledInteger<4>>();
+    });
+    add("parse<Decimal64>", corpora, [](std::string_view value) {
+        return NumericalParser(value.data(), value.size()).parse<Decimal64>();
+    });
+
+    // Fixed-point prices with their compile-time format (the other corpora are not fixed-point numbers)
+    for (const auto& corpus : corpora) {
+        if (corpus.name == "prices") {
+            benchmark::RegisterBenchmark("toDouble<FixedFormat<7, 4>>/prices", [&corpus](benchmark::State& state) {
+                run(state, corpus, [](std::string_view value) {
+                    bool error;
+                    return NumericalParser<const char, FixedFormat<7, 4>>(value.data(), value.size())
+                        .toDouble(error);
+                });
+            });
+        }
+    }
+
+    // Single precision, against a double precision conversion rounded to single precision (which rounds twice),
+    // with the share of values not correctly rounded (strtof being the reference)
+    const auto addFloat = [&corpora](const std::string& name, const auto& convert) {
+        for (const auto& corpus : corpora) {
+            std::size_t misrounded = 0;
+            for (const auto& value : corpus.values) {
+                const float result = convert(value);
+                const float reference = std::strtof(value.data(), nullptr);
+                misrounded += result == reference || (std::isnan(result) && std::isnan(reference)) ? 0 : 1;
+            }
+            const double rate = corpus.values.empty() ? 0 : static_cast<double>(misrounded) / corpus.values.size();
+            benchmark::RegisterBenchmark((name + "/" + corpus.name).c_str(),
+                                         [&corpus, convert, rate](benchmark::State& state) {
+                                             run(state, corpus, convert);
+                                             state.counters["misrounded"] = rate;
+                                         });
+        }
+    };
+    addFloat("toAnyDouble<float>", [](std::string_view value) {
+        bool error;
+        return NumericalParser(value.data(), value.size()).toAnyDouble<float>(error);
+    });
+    addFloat("toAnyDouble<double>+cast", [](std::string_view value) {
+        bool error;
+        return static_cast<float>(NumericalParser(value.data(), value.size()).toAnyDouble<double>(error));
+    });
+
+    // The ten-to-two exponent conversion only, over pre-parsed numbers
+    for (const auto& corpus : corpora) {
+        using DecimalNumber = NumericalParser<const char>::DecimalNumber<double>;
+        auto numbers = std::make_shared<std::vector<DecimalNumber>>();
+        for (const auto& value : corpus.values) {
+            numbers->push_back(std::get<1>(NumericalParser(value.data(), value.size()).parseMantissaExponent()));
+        }
+        benchmark::RegisterBenchmark(("convertTwobase/" + corpus.name).c_str(),
+                                     [&corpus, numbers](benchmark::State& state) {
+                                         for (auto _ : state) {
+                                             for (const auto& number : *numbers) {
+                                                 benchmark::DoNotOptimize(number.convertTwobase().toFloat());
+                                             }
+                                         }
+                                         setCounters(state, corpus);
+                                     });
+    }
+
+    // The share of values whose rounding needs all their digits, and the cost of their conversion
+    for (const auto& corpus : corpora) {
+        using DecimalNumber = NumericalParser<const char>::DecimalNumber<double>;
+        auto numbers = std::make_shared<std::vector<std::tuple<std::string_view, std::size_t, DecimalNumber>>>();
+        std::size_t fallbacks = 0;
+        for (const auto& value : corpus.values) {
+            const auto [parsed, number] = NumericalParser(value.data(), value.size()).parseMantissaExponent();
+            numbers->emplace_back(value, parsed, number);
+            fallbacks += std::get<0>(number.convertTwobaseBounded()) ? 0 : 1;
+        }
+        const double rate = corpus.values.empty() ? 0 : static_cast<double>(fallbacks) / corpus.values.size();
+        benchmark::RegisterBenchmark(("convertTwobaseDigits/" + corpus.name).c_str(),
+                                     [&corpus, numbers, rate](benchmark::State& state) {
+                                         for (auto _ : state) {
+                                             for (const auto& [value, parsed, number] : *numbers) {
+                                                 const NumericalParser parser(value.data(), value.size());
+                                                 benchmark::DoNotOptimize(parser.convertTwobase(number, parsed));
+                                             }
+                                         }
+                                         setCounters(state, corpus);
+                                         state.counters["fallback"] = rate;
+                                     });
+    }
+
+    // The whole corpus at once
+    for (const auto& corpus : corpora) {
+        benchmark::RegisterBenchmark(("BatchParser/" + corpus.name).c_str(), [&corpus](benchmark::State& state) {
+            std::vector<double> values(corpus.values.size());
+            std::vector<ErrorBitmap::Word> errors(ErrorBitmap::words(values.size()));
+            const BatchParser parser(corpus.buffer.data(), corpus.buffer.size());
+            for (auto _ : state) {
+                benchmark::DoNotOptimize(parser.parse<double>('\n', values, errors));
+                benchmark::ClobberMemory();
+            }
+            setCounters(state, corpus);
+        });
+    }
+
+    // The whole corpus at once, through a parse cache (reporting its hit rate, "hits")
+    for (const auto& corpus : corpora) {
+        const auto run = [&corpus](benchmark::State& state) {
+            std::vector<double> values(corpus.values.size());
+            std::vector<ErrorBitmap::Word> errors(ErrorBitmap::words(values.size()));
+            const BatchParser parser(corpus.buffer.data(), corpus.buffer.size());
+            double rate = 0;
+            for (auto _ : state) {
+                ParseCache<double> cache;
+                benchmark::DoNotOptimize(parser.parse('\n', std::span(values), std::span(errors), cache));
+                benchmark::ClobberMemory();
+                rate = cache.hitRate();
+            }
+            setCounters(state, corpus);
+            state.counters["hits"] = rate;
+        };
+        benchmark::RegisterBenchmark(("BatchParser+cache/" + corpus.name).c_str(), run);
+    }
+
+    // The whole corpus at once, recording the errors through a reused parse session (reporting their number,
+    // "errors")
+    for (const auto& corpus : corpora) {
+        const auto run = [&corpus](benchmark::State& state) {
+            std::vector<double> values(corpus.values.size());
+            std::vector<ErrorBitmap::Word> errors(ErrorBitmap::words(values.size()));
+            const BatchParser parser(corpus.buffer.data(), corpus.buffer.size());
+            ParseSession<double> session;
+            for (auto _ : state) {
+                session.clear();
+                benchmark::DoNotOptimize(parser.parse('\n', std::span(values), std::span(errors), session));
+                benchmark::ClobberMemory();
+            }
+            setCounters(state, corpus);
+            state.counters["errors"] = static_cast<double>(session.errors().size());
+        };
+        benchmark::RegisterBenchmark(("BatchParser+session/" + corpus.name).c_str(), run);
+    }
+
+    // The whole corpus at once, into an Arrow column (64-byte aligned buffers)
+    const auto arrowBuffer = [](std::size_t bytes) {
+        bytes = (bytes + ArrowColumn::alignment - 1) / ArrowColumn::alignment * ArrowColumn::alignment;
+        return std::unique_ptr<std::uint8_t[], decltype(&std::free)>(
+            static_cast<std::uint8_t*>(std::aligned_alloc(ArrowColumn::alignment, bytes)), &std::free);
+    };
+    for (const auto& corpus : corpora) {
+        const auto run = [&corpus, arrowBuffer](benchmark::State& state) {
+            const std::size_t count = corpus.values.size();
+            const auto values = arrowBuffer(count * sizeof(double));
+            const auto validity = arrowBuffer(ArrowColumn::validityBytes(count));
+            const std::span column(reinterpret_cast<double*>(values.get()), count);
+            const std::span bitmap(validity.get(), ArrowColumn::validityBytes(count));
+            const BatchParser parser(corpus.buffer.data(), corpus.buffer.size());
+            for (auto _ : state) {
+                benchmark::DoNotOptimize(parser.parseArrow<double>('\n', column, bitmap));
+                benchmark::ClobberMemory();
+            }
+            setCounters(state, corpus);
+        };
+        benchmark::RegisterBenchmark(("BatchParser::parseArrow/" + corpus.name).c_str(), run);
+    }
+
+    // The whole corpus pre-pass: counting, and validating, without any conversion
+    for (const auto& corpus : corpora) {
+        const auto run = [&corpus](benchmark::State& state) {
+            const BatchScanner scanner(corpus.buffer.data(), corpus.buffer.size());
+            for (auto _ : state) {
+                benchmark::DoNotOptimize(scanner.count('\n'));
+            }
+            setCounters(state, corpus);
+        };
+        benchmark::RegisterBenchmark(("BatchScanner::count/" + corpus.name).c_str(), run);
+    }
+    for (const auto& corpus : corpora) {
+        const auto run = [&corpus](benchmark::State& state) {
+            std::vector<std::size_t> ends(corpus.values.size());
+            std::vector<ErrorBitmap::Word> errors(ErrorBitmap::words(ends.size()));
+            const BatchScanner scanner(corpus.buffer.data(), corpus.buffer.size());
+            for (auto _ : state) {
+                benchmark::DoNotOptimize(scanner.validate('\n', std::span(ends), std::span(errors)));
+                benchmark::ClobberMemory();
+            }
+            setCounters(state, corpus);
+        };
+        benchmark::RegisterBenchmark(("BatchScanner::validate/" + corpus.name).c_str(), run);
+    }
+
+    // The whole corpus as a stream of 4 KiB chunks, values being split across chunks
+    for (const auto& corpus : corpora) {
+        benchmark::RegisterBenchmark(("StreamParser/" + corpus.name).c_str(), [&corpus](benchmark::State& state) {
+            constexpr std::size_t chunkSize = 4096;
+            const std::span buffer(corpus.buffer.data(), corpus.buffer.size());
+            double sum = 0;
+            const auto emit = [&sum](const double value, bool) { sum += value; };
+            for (auto _ : state) {
+                StreamParser<const char> stream('\n');
+                for (std::size_t offset = 0; offset < buffer.size(); offset += chunkSize) {
+                    stream.feed(buffer.subspan(offset, std::min(chunkSize, buffer.size() - offset)), emit);
+                }
+                stream.finish(emit);
+                benchmark::DoNotOptimize(sum);
+            }
+            setCounters(state, corpus);
+        });
+    }
+
+    // References
+    add("strtod", corpora, [](std::string_view value) {
+        // Values are followed by a newline, which stops the parsing
+        return std::strtod(value.data(), nullptr);
+    });
+    add("strtof", corpora, [](std::string_view value) { return std::strtof(value.data(), nullptr); });
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    add("from_chars", corpora, [](std::string_view value) {
+        double result;
+        std::from_chars(value.data(), value.data() + value.size(), result);
+        return result;
+    });
+#endif
+#ifdef IEEE754TOY_BENCHMARK_FAST_FLOAT
+    add("fast_float", corpora, [](std::string_view value) {
+        double result;
+        fast_float::from_chars(value.data(), value.data() + value.size(), result);
+        return result;
+    });
+#endif
+}
+
+/** Widen a character string, code unit after code unit. **/
+template<typename C>
+std::basic_string<C> widen(std::string_view value)
+{
+    return std::basic_string<C>(value.begin(), value.end());
+}
+
+/** Register per-value and batch benchmarks over the corpora converted to the given character type. **/
+template<typename C>
+void registerCharacterTypeBenchmarks(const std::string& type, const std::vector<Corpus>& corpora)
+{
+    for (const auto& corpus : corpora) {
+        // Wide copies of the buffer and its values
+        const auto buffer = std::make_shared<const std::basic_string<C>>(widen<C>(corpus.buffer));
+        auto values = std::make_shared<std::vector<std::basic_string<C>>>();
+        for (const auto& value : corpus.values) {
+            values->push_back(widen<C>(value));
+        }
+
+        const std::string suffix = "<" + type + ">/" + corpus.name;
+        benchmark::RegisterBenchmark(("toDouble" + suffix).c_str(), [&corpus, values](benchmark::State& state) {
+            for (auto _ : state) {
+                for (const auto& value : *values) {
+                    bool error;
+                    benchmark::DoNotOptimize(NumericalParser(value.data(), value.size()).toDouble(error));
+                }
+            }
+            setCounters(state, corpus);
+        });
+
+        benchmark::RegisterBenchmark(("BatchParser" + suffix).c_str(), [&corpus, buffer](benchmark::State& state) {
+            std::vector<double> values(corpus.values.size());
+            std::vector<ErrorBitmap::Word> errors(ErrorBitmap::words(values.size()));
+            const BatchParser parser(buffer->data(), buffer->size());
+            for (auto _ : state) {
+                benchmark::DoNotOptimize(parser.template parse<double>(C('\n'), values, errors));
+                benchmark::ClobberMemory();
+            }
+            setCounters(state, corpus);
+        });
+    }
+}
+
+/**
+ * Register batch benchmarks for every SIMD level supported by the running CPU, over the corpora converted to the
+ * given character type (the other batch benchmarks use the level selected at runtime).
+ **/
+template<typename C>
+void registerSimdLevelBenchmarks(const std::string& type, const std::vector<Corpus>& corpora)
+{
+    for (const SimdLevel level : simdLevels) {
+        if (not simdLevelSupported(level)) {
+            continue;
+        }
+        for (const auto& corpus : corpora) {
+            const auto buffer = std::make_shared<const std::basic_string<C>>(widen<C>(corpus.buffer));
+            const std::string name =
+                "BatchParser" + type + "@" + std::string(simdLevelName(level)) + "/" + corpus.name;
+            benchmark::RegisterBenchmark(name.c_str(), [&corpus, buffer, level](benchmark::State& state) {
+                std::vector<double> values(corpus.values.size());
+                std::vector<ErrorBitmap::Word> errors(ErrorBitmap::words(values.size()));
+                const BatchParser parser(buffer->data(), buffer->size());
+                const SimdLevel selected = simdLevel();
+                forceSimdLevel(level);
+                for (auto _ : state) {
+                    benchmark::DoNotOptimize(parser.template parse<double>(C('\n'), values, errors));
+                    benchmark::ClobberMemory();
+                }
+                forceSimdLevel(selected);
+                setCounters(state, corpus);
+            });
+        }
+    }
+}
+
+void registerTokenizerBenchmarks(const std::vector<Corpus>& corpora)
+{
+    // Tokenize the whole buffer, value after value: each tokenizer returns the end of the value it parsed
+    const auto add = [&corpora](const std::string& name, const auto& tokenize) {
+        for (const auto& corpus : corpora) {
+            benchmark::RegisterBenchmark((name + "/" + corpus.name).c_str(),
+                                         [&corpus, tokenize](benchmark::State& state) {
+                                             const char* const begin = corpus.buffer.data();
+                                             const char* const end = begin + corpus.buffer.size();
+                                             for (auto _ : state) {
+                                                 double sum = 0;
+                                                 for (const char* s = begin; s < end;) {
+                                                     // Skip the delimiter
+                                                     s = tokenize(s, end, sum) + 1;
+                                                 }
+                                                 benchmark::DoNotOptimize(sum);
+                                             }
+                                             setCounters(state, corpus);
+                                         });
+        }
+    };
+
+    // Two passes: find the end of the token first, then parse the exact token
+    add("Tokenizer/twoPasses", [](const char* s, const char* end, double& sum) {
+        const auto* const delimiter = static_cast<const char*>(std::memchr(s, '\n', end - s));
+        const char* const last = delimiter != nullptr ? delimiter : end;
+        bool error;
+        sum += NumericalParser(s, last).toDouble(error);
+        return last;
+    });
+
+    // Single pass: parse the longest number prefix
+    add("Tokenizer/fromChars", [](const char* s, const char* end, double& sum) {
+        const auto result = fromChars(s, end);
+        sum += result.value;
+        return result.ptr;
+    });
+
+    // References
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    add("Tokenizer/from_chars", [](const char* s, const char* end, double& sum) {
+        double value = 0;
+        const auto result = std::from_chars(s, end, value);
+        sum += value;
+        return result.ptr;
+    });
+#endif
+    add("Tokenizer/strtod", [](const char* s, const char*, double& sum) {
+        char* last;
+        sum += std::strtod(s, &last);
+        return static_cast<const char*>(last);
+    });
+}
+
+void registerFormatterBenchmarks(const std::vector<Corpus>& corpora)
+{
+    // Format the parsed values back
+    const auto add = [&corpora](const std::string& name, const auto& format) {
+        for (const auto& corpus : corpora) {
+            auto values = std::make_shared<std::vector<double>>();
+            for (const auto& value : corpus.values) {
+                values->push_back(std::strtod(value.data(), nullptr));
+            }
+            benchmark::RegisterBenchmark((name + "/" + corpus.name).c_str(),
+                                         [&corpus, values, format](benchmark::State& state) {
+                                             char buffer[64];
+                                             for (auto _ : state) {
+                                                 for (const double value : *values) {
+                                                     benchmark::DoNotOptimize(format(buffer, value));
+                                                     benchmark::ClobberMemory();
+                                                 }
+                                             }
+                                             setCounters(state, corpus);
+                                         });
+        }
+    };
+
+    add("NumericalFormatter", [](char* buffer, double value) {
+        return NumericalFormatter(buffer, NumericalFormatter<char>::maxLength).format(value);
+    });
+    add("snprintf", [](char* buffer, double value) { return std::snprintf(buffer, 64, "%.17g", value); });
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    add("to_chars", [](char* buffer, double value) { return std::to_chars(buffer, buffer + 64, value).ptr; });
+#endif
+}
+
+}; // namespace ieee754toy::benchmarks
+
+int main(int argc, char** argv)
+{
+    using namespace ieee754toy::benchmarks;
+
+    benchmark::Initialize(&argc, argv);
+
+    // Generated corpora, and user-provided ones
+    auto corpora = generate(100000);
+    for (int i = 1; i < argc; i++) {
+        corpora.push_back(load(argv[i]));
+    }
+
+    benchmark::AddCustomContext("simd", std::string(ieee754toy::simdLevelName(ieee754toy::simdLevel())));
+#ifdef IEEE754TOY_COMPACT_TABLES
+    benchmark::AddCustomContext("tables", "compact");
+#else
+    benchmark::AddCustomContext("tables", "full");
+#endif
+
+    registerConversionBenchmarks(corpora);
+    registerCharacterTypeBenchmarks<char16_t>("char16_t", corpora);
+    registerCharacterTypeBenchmarks<char32_t>("char32_t", corpora);
+    registerSimdLevelBenchmarks<char>("", corpora);
+    registerSimdLevelBenchmarks<char16_t>("<char16_t>", corpora);
+    registerSimdLevelBenchmarks<char32_t>("<char32_t>", corpora);
+    registerTokenizerBenchmarks(corpora);
+    registerFormatterBenchmarks(corpora);
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,177 @@
+/*
+ * IEEE754 constexpr parser toy. Benchmark corpora.
+ * Thanks to Algolia for giving me the opportunity to develop this toy!
+ * @maintainer Xavier Roche (xavier dot roche at algolia.com)
+ */
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ieee754toy::benchmarks {
+
+/**
+ * A benchmark corpus: newline-separated values.
+ **/
+struct Corpus
+{
+    /** Corpus name **/
+    std::string name;
+
+    /** Values, each one followed by a newline **/
+    std::string buffer;
+
+    /** Values, pointing inside buffer (newline excluded) **/
+    std::vector<std::string_view> values;
+
+    /** Total size of values, in bytes (newlines excluded) **/
+    std::size_t bytes = 0;
+
+    /** Build a corpus from a newline-separated buffer. **/
+    static Corpus fromBuffer(std::string name, std::string buffer);
+
+    /** Build a corpus from formatted generated values. **/
+    template<typename Generator>
+    static Corpus generate(std::string name, std::size_t count, Generator&& generator);
+};
+
+inline Corpus Corpus::fromBuffer(std::string name, std::string buffer)
+{
+    Corpus corpus{ std::move(name), std::move(buffer), {}, 0 };
+    for (std::size_t begin = 0; begin < corpus.buffer.size();) {
+        std::size_t end = corpus.buffer.find('\n', begin);
+        end = end != std::string::npos ? end : corpus.buffer.size();
+        if (end != begin) {
+            corpus.values.emplace_back(corpus.buffer.data() + begin, end - begin);
+            corpus.bytes += end - begin;
+        }
+        begin = end + 1;
+    }
+    return corpus;
+}
+
+template<typename Generator>
+Corpus Corpus::generate(std::string name, std::size_t count, Generator&& generator)
+{
+    std::string buffer;
+    for (std::size_t i = 0; i < count; i++) {
+        buffer += generator();
+        buffer += '\n';
+    }
+    return fromBuffer(std::move(name), std::move(buffer));
+}
+
+/** Format a double with a printf format. **/
+inline std::string format(const char* format, double value)
+{
+    char buffer[64];
+    const int length = std::snprintf(buffer, sizeof(buffer), format, value);
+    return std::string(buffer, length);
+}
+
+/** Load a corpus from a newline-separated file. **/
+inline Corpus load(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    std::string buffer{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+    return Corpus::fromBuffer(filename, std::move(buffer));
+}
+
+/**
+ * Standard generated corpora:
+ * - uniform: uniform random doubles in [0, 1), with 17 significant digits
+ * - short: short decimals with at most two fractional digits (eg. "12.5", "1234.56")
+ * - coordinates: canada.json-style coordinates, ie. six-decimal latitudes/longitudes printed with 17 digits
+ * - mesh: mesh-style single-precision data, with 7 significant digits
+ * - extreme: subnormal and huge exponents, with 17 significant digits
+ * - placeholders: short decimals, one value out of four being a "NaN", "-Inf" or "Inf" placeholder
+ * - long: uniform random doubles exported with 25 significant digits, more than the mantissa can hold
+ * - halfway: values very close to half-way between two consecutive doubles, with 30 to 60 significant digits
+ * - halfwayFloat: values very close to half-way between two consecutive floats, with 17 significant digits (ie.
+ *   wrongly rounded when converted to double precision, then to single precision)
+ * - prices: fixed-point prices, with seven integral and four fractional digits (eg. "0001234.5600")
+ * - lowCardinality: a low-cardinality column, of status codes ("0.0", "1.0", "-1") and a hundred price points
+ **/
+inline std::vector<Corpus> generate(std::size_t count)
+{
+    std::mt19937_64 random(42);
+    std::uniform_real_distribution<double> unit(0, 1);
+
+    std::vector<Corpus> corpora;
+
+    corpora.push_back(Corpus::generate("uniform", count, [&] { return format("%.17g", unit(random)); }));
+
+    corpora.push_back(Corpus::generate("short", count, [&] {
+        const auto cents = random() % 1000000;
+        return cents % 4 == 0 ? std::to_string(cents / 100) : format("%.2f", cents / 100.0);
+    }));
+
+    corpora.push_back(Corpus::generate("coordinates", count, [&] {
+        const double coordinate = std::round((unit(random) * 360 - 180) * 1e6) / 1e6;
+        return format("%.17g", coordinate);
+    }));
+
+    corpora.push_back(Corpus::generate("mesh", count, [&] {
+        const float value = static_cast<float>(unit(random) * 100 - 50);
+        return format("%.7g", value);
+    }));
+
+    corpora.push_back(Corpus::generate("extreme", count, [&] {
+        // Random mantissa, with either a subnormal, a tiny or a huge exponent
+        const std::uint64_t mantissa = random() & ((std::uint64_t(1) << 52) - 1);
+        const std::uint64_t exponents[] = { 0, 1 + random() % 64, 2046 - random() % 64 };
+        const std::uint64_t exponent = exponents[random() % 3];
+        return format("%.17g", std::bit_cast<double>((exponent << 52) | mantissa));
+    }));
+
+    corpora.push_back(Corpus::generate("placeholders", count, [&] {
+        const char* const placeholders[] = { "NaN", "-Inf", "Inf" };
+        const auto choice = random() % 12;
+        return choice < 3 ? std::string(placeholders[choice]) : format("%.2f", (random() % 1000000) / 100.0);
+    }));
+
+    corpora.push_back(Corpus::generate("long", count, [&] { return format("%.25g", unit(random)); }));
+
+    corpora.push_back(Corpus::generate("halfway", count, [&] {
+        // The exact middle of two doubles needs one more bit, and fits in a long double on x86
+        const double value = unit(random);
+        const long double middle = (static_cast<long double>(value) + std::nextafter(value, 2.0)) / 2;
+        const int digits = 30 + static_cast<int>(random() % 31);
+        char buffer[128];
+        const int length = std::snprintf(buffer, sizeof(buffer), "%.*Lg", digits, middle);
+        return std::string(buffer, length);
+    }));
+
+    corpora.push_back(Corpus::generate("halfwayFloat", count, [&] {
+        // The exact middle of two floats is a double, which 17 digits do not write exactly
+        const auto value = static_cast<float>(unit(random));
+        const double middle = (static_cast<double>(value) + std::nextafter(value, 2.0f)) / 2;
+        return format("%.17g", middle);
+    }));
+
+    corpora.push_back(Corpus::generate("prices", count, [&] {
+        return format("%012.4f", (random() % 100000000000) / 10000.0);
+    }));
+
+    std::vector<std::string> points = { "0.0", "1.0", "-1" };
+    for (std::size_t i = 0; i < 100; i++) {
+        points.push_back(format("%.2f", (random() % 100000) / 100.0));
+    }
+    corpora.push_back(Corpus::generate("lowCardinality", count, [&] {
+        // Status codes are half of the values
+        return random() % 2 == 0 ? points[random() % 3] : points[random() % points.size()];
+    }));
+
+    return corpora;
+}
+
+}; // namespace ieee754toy::benchmarks
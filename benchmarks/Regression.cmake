@@ -0,0 +1,127 @@
+# IEEE754 constexpr parser toy. Benchmark regression gate.
+# Run the benchmarks matching FILTER, and compare their median time per value with the BASELINE (Google benchmark
+# JSON output): fail if any regresses by more than THRESHOLD percent. With UPDATE, record the baseline instead.
+# Usage: cmake -DBENCHMARK=<ieee754toy-benchmark> -DBASELINE=<file> [-DTHRESHOLD=<percent>] [-DFILTER=<regex>]
+#              [-DUPDATE=ON] -P Regression.cmake
+cmake_minimum_required(VERSION 3.20)
+
+if(NOT DEFINED THRESHOLD)
+  set(THRESHOLD 10)
+endif()
+if(NOT DEFINED FILTER)
+  set(FILTER ".")
+endif()
+if(NOT UPDATE AND NOT EXISTS "${BASELINE}")
+  # The test is then skipped (see its SKIP_REGULAR_EXPRESSION property)
+  message(STATUS "No benchmark baseline in ${BASELINE}: build the ieee754toy-benchmark-baseline target")
+  return()
+endif()
+
+# Medians over a few repetitions, which are less noisy than single runs
+get_filename_component(output "${BASELINE}" NAME_WE)
+set(output "${CMAKE_CURRENT_BINARY_DIR}/${output}-current.json")
+execute_process(COMMAND "${BENCHMARK}"
+                        "--benchmark_filter=${FILTER}"
+                        --benchmark_min_time=0.1
+                        --benchmark_repetitions=5
+                        --benchmark_report_aggregates_only=true
+                        "--benchmark_out=${output}"
+                        --benchmark_out_format=json
+                OUTPUT_QUIET
+                RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "${BENCHMARK} failed: ${result}")
+endif()
+
+if(UPDATE)
+  configure_file("${output}" "${BASELINE}" COPYONLY)
+  message(STATUS "Benchmark baseline recorded in ${BASELINE}")
+  return()
+endif()
+
+# Convert a time in seconds, as printed in the JSON output (eg. 2.5837e-08), into integer femtoseconds
+function(femtoseconds value out)
+  if(NOT value MATCHES "^([0-9]+)(\\.([0-9]*))?([eE]([-+]?[0-9]+))?$")
+    message(FATAL_ERROR "Invalid time: ${value}")
+  endif()
+  set(digits "${CMAKE_MATCH_1}${CMAKE_MATCH_3}")
+  string(LENGTH "${CMAKE_MATCH_3}" fraction)
+  set(exponent 0)
+  if(CMAKE_MATCH_5)
+    set(exponent "${CMAKE_MATCH_5}")
+  endif()
+  math(EXPR shift "${exponent} + 15 - ${fraction}")
+  string(REGEX REPLACE "^0+([0-9])" "\\1" digits "${digits}")
+  if(shift GREATER_EQUAL 0)
+    string(REPEAT "0" ${shift} zeros)
+    set(digits "${digits}${zeros}")
+  else()
+    math(EXPR keep "-(${shift})")
+    string(LENGTH "${digits}" length)
+    math(EXPR keep "${length} - ${keep}")
+    if(keep GREATER 0)
+      string(SUBSTRING "${digits}" 0 ${keep} digits)
+    else()
+      set(digits 0)
+    endif()
+  endif()
+  set(${out} ${digits} PARENT_SCOPE)
+endfunction()
+
+# Read the median time per value of every benchmark of a JSON output, as <name>_time variables
+function(times file names)
+  file(READ "${file}" json)
+  string(JSON count LENGTH "${json}" benchmarks)
+  set(list)
+  if(count GREATER 0)
+    math(EXPR last "${count} - 1")
+    foreach(i RANGE ${last})
+      string(JSON aggregate ERROR_VARIABLE error GET "${json}" benchmarks ${i} aggregate_name)
+      string(JSON time ERROR_VARIABLE error GET "${json}" benchmarks ${i} "time/value")
+      if(aggregate STREQUAL "median" AND NOT error)
+        string(JSON name GET "${json}" benchmarks ${i} run_name)
+        femtoseconds("${time}" time)
+        set("${name}_time" ${time} PARENT_SCOPE)
+        list(APPEND list "${name}")
+      endif()
+    endforeach()
+  endif()
+  set(${names} ${list} PARENT_SCOPE)
+endfunction()
+
+times("${output}" current)
+set(current_times)
+foreach(name IN LISTS current)
+  list(APPEND current_times ${${name}_time})
+endforeach()
+times("${BASELINE}" baseline)
+
+# Format femtoseconds as nanoseconds
+function(nanoseconds value out)
+  math(EXPR integral "${value} / 1000000")
+  math(EXPR fraction "${value} / 1000 % 1000 + 1000")
+  string(SUBSTRING "${fraction}" 1 3 fraction)
+  set(${out} "${integral}.${fraction} ns" PARENT_SCOPE)
+endfunction()
+
+# Benchmarks missing from the baseline (eg. new ones) are ignored
+set(regressions 0)
+foreach(name time IN ZIP_LISTS current current_times)
+  if(NOT name IN_LIST baseline)
+    continue()
+  endif()
+  set(reference ${${name}_time})
+  math(EXPR change "(${time} - ${reference}) * 100 / (${reference} + 1)")
+  nanoseconds(${reference} before)
+  nanoseconds(${time} after)
+  if(change GREATER THRESHOLD)
+    message(STATUS "REGRESSION ${name}: ${before} -> ${after} per value (+${change}%)")
+    math(EXPR regressions "${regressions} + 1")
+  else()
+    message(STATUS "${name}: ${before} -> ${after} per value (${change}%)")
+  endif()
+endforeach()
+
+if(regressions GREATER 0)
+  message(FATAL_ERROR "${regressions} benchmarks regressed by more than ${THRESHOLD}% against ${BASELINE}")
+endif()
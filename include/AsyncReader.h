@@ -0,0 +1,522 @@
+/*
+ * IEEE754 constexpr parser toy. Asynchronous file reader.
+ * Thanks to Algolia for giving me the opportunity to develop this toy!
+ * @maintainer Xavier Roche (xavier dot roche at algolia.com)
+ */
+#pragma once
+
+/**
+ * Asynchronous sequential file reading, overlapping reads with the processing of the data already read: a ring of
+ * buffers is filled ahead of the consumer, which pulls them in file order through a coroutine (see
+ * AsyncReader::buffers()). Reads are submitted with io_uring on Linux when available, and with pread() on a
+ * reader thread otherwise.
+ */
+
+#include <algorithm>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <cerrno>
+#include <sys/types.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define IEEE754TOY_IO_URING
+#include <atomic>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+namespace ieee754toy {
+
+/**
+ * A synchronous generator coroutine: the body runs until its next co_yield each time the following value is
+ * requested, a yielded value being valid until then.
+ **/
+template<typename T>
+class Generator
+{
+public:
+    struct promise_type
+    {
+        T value;
+
+        Generator get_return_object()
+        {
+            return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(T yielded)
+        {
+            value = std::move(yielded);
+            return {};
+        }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    /** Input iterator over the yielded values. **/
+    class iterator
+    {
+    public:
+        explicit iterator(std::coroutine_handle<promise_type> handle)
+          : handle(handle)
+        {}
+
+        const T& operator*() const { return handle.promise().value; }
+
+        iterator& operator++()
+        {
+            handle.resume();
+            return *this;
+        }
+
+        bool operator==(std::default_sentinel_t) const { return handle.done(); }
+
+    private:
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    Generator(Generator&& other) noexcept
+      : handle(std::exchange(other.handle, nullptr))
+    {}
+
+    ~Generator()
+    {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    iterator begin()
+    {
+        handle.resume();
+        return iterator(handle);
+    }
+
+    std::default_sentinel_t end() const { return {}; }
+
+private:
+    explicit Generator(std::coroutine_handle<promise_type> handle)
+      : handle(handle)
+    {}
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+/**
+ * Asynchronous reader options.
+ **/
+struct AsyncReaderOptions
+{
+    /** Size of a buffer, in bytes **/
+    std::size_t bufferSize = std::size_t(1) << 20;
+
+    /** Number of buffers, ie. of reads in flight while the consumer processes a buffer (at least two) **/
+    std::size_t depth = 4;
+
+    /** Submit reads with io_uring when available (otherwise, or upon failure, with pread()) **/
+    bool uring = true;
+};
+
+/**
+ * Asynchronous sequential reader of a file (which must support pread(), eg. a regular file), from its current
+ * beginning to its end.
+ **/
+class AsyncReader
+{
+public:
+    /**
+     * Create a new reader, and start reading.
+     * @param fd The file descriptor, which must stay open during the reader lifetime
+     **/
+    explicit AsyncReader(int fd, const AsyncReaderOptions& options = {});
+
+    ~AsyncReader();
+
+    AsyncReader(const AsyncReader&) = delete;
+    AsyncReader& operator=(const AsyncReader&) = delete;
+
+    /**
+     * Return the buffers in file order, until the end of the file or a read error (see error()). A buffer is valid
+     * until the next one is requested: it is then submitted again, to read the data following the buffers in
+     * flight. All buffers are full, except the last one.
+     * @warning Can only be iterated once.
+     **/
+    Generator<std::span<const char>> buffers();
+
+    /** Return the error (errno) of the read which stopped the buffers, or zero. **/
+    int error() const { return failure; }
+
+    /** Are reads submitted with io_uring ? **/
+    bool uring() const
+    {
+#ifdef IEEE754TOY_IO_URING
+        return ring.fd != -1;
+#else
+        return false;
+#endif
+    }
+
+private:
+    /** A buffer of the ring, and its read. **/
+    struct Slot
+    {
+        std::unique_ptr<char[]> data;
+
+        /** File offset of the read, and filled size **/
+        off_t offset = 0;
+        std::size_t filled = 0;
+
+        /** Is the read complete ? (the buffer is then full, or ends the file) **/
+        bool done = false;
+
+        /** Error (errno) of the read **/
+        int error = 0;
+
+#ifdef IEEE754TOY_IO_URING
+        /** The io_uring read vector **/
+        iovec vector{};
+#endif
+    };
+
+    /** Submit a read to fill the given slot from offset. **/
+    void submit(std::size_t slot, off_t offset);
+
+    /** Wait for the read of the given slot to complete. **/
+    void wait(std::size_t slot);
+
+    /** The pread() reader thread loop. **/
+    void readLoop();
+
+    const int fd;
+    const std::size_t bufferSize;
+    std::vector<Slot> slots;
+    int failure = 0;
+
+    /** The pread() backend: the reader thread, its queue of slots to read, and its lock **/
+    std::thread reader;
+    std::deque<std::size_t> queue;
+    std::mutex lock;
+    std::condition_variable submitted;
+    std::condition_variable completed;
+    bool stopping = false;
+
+#ifdef IEEE754TOY_IO_URING
+    /** The io_uring backend: a submission and a completion ring, mapped from the kernel. **/
+    struct Ring
+    {
+        int fd = -1;
+        void* sqMap = MAP_FAILED;
+        std::size_t sqSize = 0;
+        void* cqMap = MAP_FAILED;
+        std::size_t cqSize = 0;
+        io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+        std::size_t sqesSize = 0;
+        io_uring_params params{};
+
+        /** Ring fields **/
+        unsigned* sqTail = nullptr;
+        unsigned sqMask = 0;
+        unsigned* sqArray = nullptr;
+        unsigned* cqHead = nullptr;
+        unsigned* cqTail = nullptr;
+        unsigned cqMask = 0;
+        io_uring_cqe* cqes = nullptr;
+    } ring;
+
+    /** Set up the rings, and return @c false upon failure. **/
+    bool setupRing(unsigned entries);
+
+    /** Release the rings. **/
+    void closeRing();
+
+    /** Submit the read of a slot remainder to io_uring. **/
+    bool submitRing(std::size_t slot);
+
+    /** Handle the available completions, waiting for at least one if wait is @c true. **/
+    void reapRing(bool wait);
+#endif
+};
+
+inline AsyncReader::AsyncReader(const int fd, const AsyncReaderOptions& options)
+  : fd(fd)
+  , bufferSize(std::max<std::size_t>(options.bufferSize, 1))
+  , slots(std::max<std::size_t>(options.depth, 2))
+{
+    for (auto& slot : slots) {
+        slot.data = std::make_unique<char[]>(bufferSize);
+    }
+
+#ifdef IEEE754TOY_IO_URING
+    if (not options.uring || not setupRing(static_cast<unsigned>(slots.size()))) {
+        closeRing();
+    }
+#endif
+    if (not uring()) {
+        reader = std::thread([this] { readLoop(); });
+    }
+
+    for (std::size_t i = 0; i < slots.size(); i++) {
+        submit(i, static_cast<off_t>(i * bufferSize));
+    }
+}
+
+inline AsyncReader::~AsyncReader()
+{
+    // Wait for the reads in flight, which write into the buffers
+    for (std::size_t i = 0; i < slots.size(); i++) {
+        wait(i);
+    }
+    if (reader.joinable()) {
+        {
+            const std::lock_guard guard(lock);
+            stopping = true;
+        }
+        submitted.notify_one();
+        reader.join();
+    }
+#ifdef IEEE754TOY_IO_URING
+    closeRing();
+#endif
+}
+
+inline Generator<std::span<const char>> AsyncReader::buffers()
+{
+    for (std::size_t i = 0;; i = (i + 1) % slots.size()) {
+        wait(i);
+        Slot& slot = slots[i];
+        if (slot.error != 0) {
+            failure = slot.error;
+            co_return;
+        }
+        if (slot.filled != 0) {
+            co_yield std::span<const char>(slot.data.get(), slot.filled);
+        }
+
+        // The end of the file (the following slots are empty, or being read past the end)
+        if (slot.filled != bufferSize) {
+            co_return;
+        }
+        submit(i, slot.offset + static_cast<off_t>(slots.size() * bufferSize));
+    }
+}
+
+inline void AsyncReader::submit(const std::size_t i, const off_t offset)
+{
+    Slot& slot = slots[i];
+    slot.offset = offset;
+    slot.filled = 0;
+    slot.done = false;
+    slot.error = 0;
+
+#ifdef IEEE754TOY_IO_URING
+    if (uring()) {
+        if (not submitRing(i)) {
+            slot.done = true;
+        }
+        return;
+    }
+#endif
+    {
+        const std::lock_guard guard(lock);
+        queue.push_back(i);
+    }
+    submitted.notify_one();
+}
+
+inline void AsyncReader::wait(const std::size_t i)
+{
+#ifdef IEEE754TOY_IO_URING
+    if (uring()) {
+        while (not slots[i].done) {
+            reapRing(true);
+        }
+        return;
+    }
+#endif
+    std::unique_lock guard(lock);
+    completed.wait(guard, [this, i] { return slots[i].done; });
+}
+
+inline void AsyncReader::readLoop()
+{
+    for (;;) {
+        std::size_t i;
+        {
+            std::unique_lock guard(lock);
+            submitted.wait(guard, [this] { return stopping || not queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            i = queue.front();
+            queue.pop_front();
+        }
+
+        // Fill the buffer, or reach the end of the file
+        Slot& slot = slots[i];
+        int error = 0;
+        std::size_t filled = 0;
+        while (filled < bufferSize) {
+            const ssize_t length =
+                pread(fd, slot.data.get() + filled, bufferSize - filled, slot.offset + static_cast<off_t>(filled));
+            if (length < 0 && errno == EINTR) {
+                continue;
+            } else if (length < 0) {
+                error = errno;
+                break;
+            } else if (length == 0) {
+                break;
+            }
+            filled += static_cast<std::size_t>(length);
+        }
+
+        {
+            const std::lock_guard guard(lock);
+            slot.filled = filled;
+            slot.error = error;
+            slot.done = true;
+        }
+        completed.notify_one();
+    }
+}
+
+#ifdef IEEE754TOY_IO_URING
+
+inline bool AsyncReader::setupRing(const unsigned entries)
+{
+    ring.fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &ring.params));
+    if (ring.fd < 0) {
+        ring.fd = -1;
+        return false;
+    }
+
+    const auto& params = ring.params;
+    ring.sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring.cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    ring.sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    ring.sqMap = mmap(nullptr, ring.sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd,
+                      IORING_OFF_SQ_RING);
+    ring.cqMap = mmap(nullptr, ring.cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd,
+                      IORING_OFF_CQ_RING);
+    void* const sqes = mmap(nullptr, ring.sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd,
+                            IORING_OFF_SQES);
+    ring.sqes = static_cast<io_uring_sqe*>(sqes);
+    if (ring.sqMap == MAP_FAILED || ring.cqMap == MAP_FAILED || sqes == MAP_FAILED) {
+        return false;
+    }
+
+    auto* const sq = static_cast<char*>(ring.sqMap);
+    auto* const cq = static_cast<char*>(ring.cqMap);
+    ring.sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    ring.sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    ring.sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    ring.cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    ring.cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    ring.cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    ring.cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+}
+
+inline void AsyncReader::closeRing()
+{
+    if (ring.sqes != MAP_FAILED) {
+        munmap(ring.sqes, ring.sqesSize);
+    }
+    if (ring.cqMap != MAP_FAILED) {
+        munmap(ring.cqMap, ring.cqSize);
+    }
+    if (ring.sqMap != MAP_FAILED) {
+        munmap(ring.sqMap, ring.sqSize);
+    }
+    if (ring.fd != -1) {
+        close(ring.fd);
+    }
+    ring = Ring{};
+}
+
+inline bool AsyncReader::submitRing(const std::size_t i)
+{
+    Slot& slot = slots[i];
+    slot.vector = { slot.data.get() + slot.filled, bufferSize - slot.filled };
+
+    // At most one read per slot is in flight, and the ring has one entry per slot
+    const unsigned tail = *ring.sqTail;
+    const unsigned index = tail & ring.sqMask;
+    io_uring_sqe& sqe = ring.sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_READV;
+    sqe.fd = fd;
+    sqe.addr = reinterpret_cast<std::uintptr_t>(&slot.vector);
+    sqe.len = 1;
+    sqe.off = static_cast<std::uint64_t>(slot.offset) + slot.filled;
+    sqe.user_data = i;
+    ring.sqArray[index] = index;
+    std::atomic_ref(*ring.sqTail).store(tail + 1, std::memory_order_release);
+
+    for (;;) {
+        const long submitted = syscall(__NR_io_uring_enter, ring.fd, 1, 0, 0, nullptr, 0);
+        if (submitted >= 0 || errno != EINTR) {
+            if (submitted != 1) {
+                slot.error = submitted < 0 ? errno : EIO;
+                return false;
+            }
+            return true;
+        }
+    }
+}
+
+inline void AsyncReader::reapRing(const bool wait)
+{
+    unsigned head = *ring.cqHead;
+    if (wait && head == std::atomic_ref(*ring.cqTail).load(std::memory_order_acquire)) {
+        if (syscall(__NR_io_uring_enter, ring.fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 &&
+            errno != EINTR) {
+            // Should not happen: fail the reads in flight
+            for (auto& slot : slots) {
+                if (not slot.done) {
+                    slot.error = errno;
+                    slot.done = true;
+                }
+            }
+            return;
+        }
+    }
+
+    for (; head != std::atomic_ref(*ring.cqTail).load(std::memory_order_acquire); head++) {
+        const io_uring_cqe& cqe = ring.cqes[head & ring.cqMask];
+        Slot& slot = slots[cqe.user_data];
+        if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+            // Retry
+        } else if (cqe.res < 0) {
+            slot.error = -cqe.res;
+        } else {
+            slot.filled += static_cast<std::size_t>(cqe.res);
+        }
+
+        // Short reads are completed, unless they reached the end of the file
+        const bool retry = slot.error == 0 && slot.filled < bufferSize && cqe.res != 0;
+        std::atomic_ref(*ring.cqHead).store(head + 1, std::memory_order_release);
+        if (not retry || not submitRing(cqe.user_data)) {
+            slot.done = true;
+        }
+    }
+}
+
+#endif
+
+}; // namespace ieee754toy
@@ -0,0 +1,471 @@
+/*
+ * IEEE754 constexpr parser toy. Batch parser.
+ * Thanks to Algolia for giving me the opportunity to develop this toy!
+ * @maintainer Xavier Roche (xavier dot roche at algolia.com)
+ */
+#pragma once
+
+#include "NumericalParser.h"
+#include "ParseCache.h"
+#include "ParseSession.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <tuple>
+#include <type_traits>
+
+namespace ieee754toy {
+
+/**
+ * Error bitmap helpers: value #i is in error if bit (i % 64) of word (i / 64) is set.
+ **/
+struct ErrorBitmap
+{
+    /** Word type. **/
+    using Word = std::uint64_t;
+
+    /** Bits per word. **/
+    static constexpr std::size_t wordBits = 64;
+
+    /** Number of words needed to hold the given number of values. **/
+    static constexpr std::size_t words(std::size_t count) { return (count + wordBits - 1) / wordBits; }
+
+    /** Is the value #index in error ? **/
+    static constexpr bool test(std::span<const Word> bitmap, std::size_t index)
+    {
+        return (bitmap[index / wordBits] & (Word(1) << (index % wordBits))) != 0;
+    }
+};
+
+static_assert(ErrorBitmap::words(0) == 0 && ErrorBitmap::words(1) == 1 && ErrorBitmap::words(64) == 1 &&
+              ErrorBitmap::words(65) == 2);
+
+/**
+ * Apache Arrow fixed-width columns helpers: the value buffer is an array of values (eg. double for an Arrow
+ * float64 column), and the validity bitmap holds one bit per value, set if the value is valid (not null), the
+ * first value being the least significant bit of the first byte. BatchParser::parseArrow() writes the bitmap by
+ * 64-bit words, stored in little-endian order: they are the bitmap bytes, padded to a multiple of eight bytes
+ * (Arrow buffers being padded to a multiple of 64 bytes).
+ **/
+struct ArrowColumn
+{
+    /** Alignment of the Arrow buffers, in bytes (its recommended alignment and padding). **/
+    static constexpr std::size_t alignment = 64;
+
+    /** Number of validity bitmap bytes needed to hold the given number of values (whole words). **/
+    static constexpr std::size_t validityBytes(std::size_t count)
+    {
+        return ErrorBitmap::words(count) * sizeof(ErrorBitmap::Word);
+    }
+
+    /** Is the value #index valid ? **/
+    static constexpr bool valid(std::span<const std::uint8_t> validity, std::size_t index)
+    {
+        return (validity[index / 8] & (1u << (index % 8))) != 0;
+    }
+};
+
+static_assert(ArrowColumn::validityBytes(0) == 0 && ArrowColumn::validityBytes(1) == 8 &&
+              ArrowColumn::validityBytes(65) == 16);
+
+/**
+ * Batch numerical parser: parse a whole column of numbers at once into caller-owned buffers.
+ * Each value is converted through NumericalParser::toAnyDouble, and yields bit-identical results, except for empty
+ * values, which are errors (or nulls) as for NumericalParser::parse() (ParseError::Empty). Values may also be
+ * decimal outputs (eg. ScaledInteger<4>, see DecimalOutputs.h), saturated scaled integers being errors.
+ * Low-cardinality columns can be parsed through a cache of the recently parsed values (see ParseCache).
+ * No memory is allocated.
+ * The parsing loops are compiled for each SIMD level, and the level of the running CPU is selected once per call
+ * (see dispatchSimdLevel()).
+ * @comment Format The number format, see NumericalParser.
+ **/
+template<typename T, typename Format = DefaultNumberFormat>
+class BatchParser : private std::span<T>
+{
+public:
+    /** Create a new batch parser over a buffer **/
+    template<typename... Ts>
+    constexpr BatchParser(Ts&&... args)
+      : std::span<T>(std::forward<Ts>(args)...)
+    {}
+
+    /**
+     * Parse values separated by a delimiter (eg. '\n' or ',').
+     *
+     * @param delimiter The delimiter character. A trailing delimiter at the end of the buffer is ignored.
+     * @param[out] values The parsed values, @c 0 for values in error.
+     * @param[out] errors The error bitmap, holding at least ErrorBitmap::words(values.size()) words.
+     * @return A tuple of the number of values parsed, and the number of characters consumed (including the
+     * delimiters). If the values span is too small, parsing stops at the beginning of the first value that does
+     * not fit, and can be resumed at the returned offset.
+     * @comment Bits of the last error bitmap word beyond the number of values parsed are cleared.
+     */
+    template<typename N = double>
+    std::tuple<std::size_t, std::size_t> parse(T delimiter,
+                                               std::span<N> values,
+                                               std::span<ErrorBitmap::Word> errors) const
+    {
+        return dispatchSimdLevel([&]<SimdLevel Level>() {
+            const auto [count, offset, nulls] = parseLevel<N, Level, Bitmap::Errors>(delimiter, values, errors);
+            return std::make_tuple(count, offset);
+        });
+    }
+
+    /**
+     * Parse values separated by a delimiter, through a cache of the recently parsed short values (see ParseCache),
+     * for low-cardinality columns. See parse().
+     */
+    template<typename N, std::size_t Buckets>
+    std::tuple<std::size_t, std::size_t> parse(T delimiter,
+                                               std::span<N> values,
+                                               std::span<ErrorBitmap::Word> errors,
+                                               ParseCache<N, Buckets>& cache) const
+    {
+        return dispatchSimdLevel([&]<SimdLevel Level>() {
+            const auto [count, offset, nulls] =
+                parseLevel<N, Level, Bitmap::Errors>(delimiter, values, errors, &cache);
+            return std::make_tuple(count, offset);
+        });
+    }
+
+    /**
+     * Parse values separated by a delimiter, recording the errors of the values in error into a session (see
+     * ParseSession), their index and position being relative to this buffer. See parse().
+     */
+    template<typename N>
+    std::tuple<std::size_t, std::size_t> parse(T delimiter,
+                                               std::span<N> values,
+                                               std::span<ErrorBitmap::Word> errors,
+                                               ParseSession<N>& session) const;
+
+    /**
+     * Parse values delimited by an offsets array (the Arrow layout): value #i spans the characters
+     * [offsets[i], offsets[i + 1]).
+     *
+     * @param offsets The offsets, with one more entry than the number of values.
+     * @param[out] values The parsed values, @c 0 for values in error.
+     * @param[out] errors The error bitmap, holding at least ErrorBitmap::words(values.size()) words.
+     * @return The number of values parsed, ie. the number of values in offsets, at most values.size().
+     * @comment Bits of the last error bitmap word beyond the number of values parsed are cleared.
+     */
+    template<typename N = double>
+    std::size_t parse(std::span<const std::size_t> offsets,
+                      std::span<N> values,
+                      std::span<ErrorBitmap::Word> errors) const
+    {
+        return dispatchSimdLevel([&]<SimdLevel Level>() {
+            return std::get<0>(parseLevel<N, Level, Bitmap::Errors>(offsets, values, errors));
+        });
+    }
+
+    /**
+     * Parse values delimited by an offsets array, through a cache of the recently parsed short values (see
+     * ParseCache), for low-cardinality columns. See parse().
+     */
+    template<typename N, std::size_t Buckets>
+    std::size_t parse(std::span<const std::size_t> offsets,
+                      std::span<N> values,
+                      std::span<ErrorBitmap::Word> errors,
+                      ParseCache<N, Buckets>& cache) const
+    {
+        return dispatchSimdLevel([&]<SimdLevel Level>() {
+            return std::get<0>(parseLevel<N, Level, Bitmap::Errors>(offsets, values, errors, &cache));
+        });
+    }
+
+    /**
+     * Parse values separated by a delimiter straight into an Apache Arrow fixed-width column (see ArrowColumn), in
+     * a single pass: values in error, and optionally NaN values, are nulls.
+     *
+     * @param delimiter The delimiter character. A trailing delimiter at the end of the buffer is ignored.
+     * @param[out] values The value buffer, @c 0 for nulls, which should be aligned on ArrowColumn::alignment
+     * bytes.
+     * @param[out] validity The validity bitmap, holding at least ArrowColumn::validityBytes(values.size()) bytes.
+     * @param nanNulls If @c true, NaN values are nulls too.
+     * @return A tuple of the number of values parsed, the number of characters consumed (including the
+     * delimiters), and the number of nulls (the Arrow null count). See parse().
+     * @comment Bits of the last validity bitmap word beyond the number of values parsed are cleared.
+     */
+    template<typename N = double>
+    std::tuple<std::size_t, std::size_t, std::size_t> parseArrow(T delimiter,
+                                                                 std::span<N> values,
+                                                                 std::span<std::uint8_t> validity,
+                                                                 bool nanNulls = false) const
+    {
+        return dispatchSimdLevel([&]<SimdLevel Level>() {
+            return nanNulls ? parseLevel<N, Level, Bitmap::ValidityNaN>(delimiter, values, validity)
+                            : parseLevel<N, Level, Bitmap::Validity>(delimiter, values, validity);
+        });
+    }
+
+    /**
+     * Parse values delimited by an offsets array straight into an Apache Arrow fixed-width column, see
+     * parseArrow() and parse().
+     *
+     * @return A tuple of the number of values parsed, and the number of nulls.
+     */
+    template<typename N = double>
+    std::tuple<std::size_t, std::size_t> parseArrow(std::span<const std::size_t> offsets,
+                                                    std::span<N> values,
+                                                    std::span<std::uint8_t> validity,
+                                                    bool nanNulls = false) const
+    {
+        return dispatchSimdLevel([&]<SimdLevel Level>() {
+            return nanNulls ? parseLevel<N, Level, Bitmap::ValidityNaN>(offsets, values, validity)
+                            : parseLevel<N, Level, Bitmap::Validity>(offsets, values, validity);
+        });
+    }
+
+    /**
+     * Return the position of the next delimiter at or after offset, or the buffer size if none.
+     * @comment Level The SIMD level of the search kernel (see CpuDispatch.h)
+     */
+    template<SimdLevel Level = compiledSimdLevel>
+    inline std::size_t find(T delimiter, std::size_t offset) const;
+
+private:
+    using std::span<T>::size;
+    using std::span<T>::data;
+
+    /** The bitmap written by parseLevel(). **/
+    enum class Bitmap
+    {
+        Errors,      // Bits set for values in error
+        Validity,    // Bits set for valid values
+        ValidityNaN, // Bits set for valid values, NaN values being invalid
+    };
+
+    /**
+     * Delimited values parse() and parseArrow(), with the kernels of the given SIMD level, and the parse cache, if
+     * any (Cache being then a ParseCache pointer). The bitmap is made of error bitmap words, or of Arrow validity
+     * bitmap bytes.
+     * @return A tuple of the number of values parsed, the number of characters consumed, and the number of values
+     * in error (or nulls).
+     **/
+    template<typename N, SimdLevel Level, Bitmap Kind, typename Storage, typename Cache = std::nullptr_t>
+    inline std::tuple<std::size_t, std::size_t, std::size_t> parseLevel(T delimiter,
+                                                                        std::span<N> values,
+                                                                        std::span<Storage> bitmap,
+                                                                        Cache cache = nullptr) const;
+
+    /**
+     * Offsets array parse() and parseArrow(), with the kernels of the given SIMD level, and the parse cache, if
+     * any.
+     * @return A tuple of the number of values parsed, and the number of values in error (or nulls).
+     **/
+    template<typename N, SimdLevel Level, Bitmap Kind, typename Storage, typename Cache = std::nullptr_t>
+    inline std::tuple<std::size_t, std::size_t> parseLevel(std::span<const std::size_t> offsets,
+                                                           std::span<N> values,
+                                                           std::span<Storage> bitmap,
+                                                           Cache cache = nullptr) const;
+
+    /** Parse the value spanning [begin, end), and return it, setting null for values in error (or nulls). **/
+    template<typename N, SimdLevel Level, Bitmap Kind, typename Cache>
+    inline N parseValue(T* begin, T* end, bool& null, Cache cache) const
+    {
+        // An empty value (eg. an empty CSV cell) is a null, and not the zero of toAnyDouble
+        if (begin == end) [[unlikely]] {
+            null = true;
+            return N{};
+        }
+
+        N value;
+        if constexpr (std::is_null_pointer_v<Cache>) {
+            value = parseOne<N, Level>(begin, end, null);
+        } else {
+            value = cache->template parse<SimdNumberFormat<Format, Level>>(begin, end, data() + size(), null);
+        }
+        if constexpr (Kind == Bitmap::ValidityNaN) {
+            if (isNaN(value)) {
+                null = true;
+                value = N{};
+            }
+        }
+        return value;
+    }
+
+    /** Return the bitmap word for the given null bits, stored in little-endian order (see ArrowColumn). **/
+    template<Bitmap Kind>
+    static constexpr ErrorBitmap::Word bitmapWord(ErrorBitmap::Word nulls, std::size_t count)
+    {
+        if constexpr (Kind == Bitmap::Errors) {
+            return nulls;
+        } else {
+            // Bits beyond the number of values are cleared
+            const ErrorBitmap::Word validity =
+                count < ErrorBitmap::wordBits ? ~nulls & ((ErrorBitmap::Word(1) << count) - 1) : ~nulls;
+            if constexpr (std::endian::native == std::endian::big) {
+                return __builtin_bswap64(validity);
+            }
+            return validity;
+        }
+    }
+
+    /**
+     * Store the bitmap word #index for the given null bits (see bitmapWord()). Validity bitmap words are copied
+     * into the bytes, which do not need to be aligned.
+     **/
+    template<Bitmap Kind, typename Storage>
+    static void storeWord(std::span<Storage> bitmap,
+                          std::size_t index,
+                          ErrorBitmap::Word nulls,
+                          std::size_t count)
+    {
+        const ErrorBitmap::Word word = bitmapWord<Kind>(nulls, count);
+        if constexpr (Kind == Bitmap::Errors) {
+            bitmap[index] = word;
+        } else {
+            std::memcpy(bitmap.data() + index * sizeof(word), &word, sizeof(word));
+        }
+    }
+
+    /** Is the value NaN ? **/
+    template<typename N>
+    static constexpr bool isNaN(const N value)
+    {
+        if constexpr (std::is_same_v<N, Decimal64>) {
+            return value.isNaN();
+        } else if constexpr (isDecimalOutput<N>) {
+            return false;
+        } else {
+            // Above infinity, the sign being shifted out (see NumericalParser::outOfRange())
+            using Integer = typename IEEE754Number<N, 2>::Integer;
+            constexpr auto infinity = static_cast<Integer>(IEEE754BinaryNumber<N>::infinity() << 1);
+            return static_cast<Integer>(std::bit_cast<Integer>(value) << 1) > infinity;
+        }
+    }
+
+    /** Parse the value spanning [begin, end), and return it, setting error accordingly. **/
+    template<typename N, SimdLevel Level>
+    static inline N parseOne(T* begin, T* end, bool& error)
+    {
+        return NumericalParser<T, SimdNumberFormat<Format, Level>>(begin, end).template toAnyDouble<N>(error);
+    }
+};
+
+// Deduction guides.
+template<typename Type>
+explicit BatchParser(Type* begin, std::size_t size) -> BatchParser<Type>;
+template<typename Type>
+explicit BatchParser(Type* begin, Type* end) -> BatchParser<Type>;
+
+template<typename T, typename Format>
+template<SimdLevel Level>
+inline std::size_t BatchParser<T, Format>::find(T delimiter, std::size_t offset) const
+{
+    if constexpr (sizeof(T) == 1) {
+        // The C library already selects its own kernels at runtime
+        const auto* const begin = reinterpret_cast<const unsigned char*>(data());
+        const auto* const found =
+            std::memchr(begin + offset, static_cast<unsigned char>(delimiter), size() - offset);
+        return found != nullptr ? static_cast<const unsigned char*>(found) - begin : size();
+    } else if constexpr (sizeof(T) == 2 || sizeof(T) == 4) {
+        return offset + findUnit<Level>(data() + offset, size() - offset, delimiter);
+    } else {
+        return std::find(data() + offset, data() + size(), delimiter) - data();
+    }
+}
+
+template<typename T, typename Format>
+template<typename N>
+std::tuple<std::size_t, std::size_t> BatchParser<T, Format>::parse(T delimiter,
+                                                                   std::span<N> values,
+                                                                   std::span<ErrorBitmap::Word> errors,
+                                                                   ParseSession<N>& session) const
+{
+    // Parse one error bitmap word at a time, the values in error being recorded from their word
+    std::size_t count = 0;
+    std::size_t offset = 0;
+    while (count < values.size() && offset < size()) {
+        const std::size_t block = std::min(ErrorBitmap::wordBits, values.size() - count);
+        const BatchParser parser(data() + offset, size() - offset);
+        const auto word = errors.subspan(count / ErrorBitmap::wordBits, 1);
+        const auto [parsed, consumed] = parser.template parse<N>(delimiter, values.subspan(count, block), word);
+        if (word[0] != 0) {
+            session.template record<Format>(data() + offset, data() + size(), delimiter, word[0], count, offset);
+        }
+        count += parsed;
+        offset += consumed;
+    }
+    return { count, offset };
+}
+
+template<typename T, typename Format>
+template<typename N,
+         SimdLevel Level,
+         typename BatchParser<T, Format>::Bitmap Kind,
+         typename Storage,
+         typename Cache>
+inline std::tuple<std::size_t, std::size_t, std::size_t> BatchParser<T, Format>::parseLevel(
+    T delimiter,
+    std::span<N> values,
+    std::span<Storage> bitmap,
+    Cache cache) const
+{
+    std::size_t count = 0;
+    std::size_t offset = 0;
+    std::size_t nulls = 0;
+    ErrorBitmap::Word word = 0;
+
+    while (offset < size() && count < values.size()) {
+        const std::size_t next = find<Level>(delimiter, offset);
+
+        bool null = false;
+        values[count] = parseValue<N, Level, Kind>(data() + offset, data() + next, null, cache);
+        word |= ErrorBitmap::Word(null) << (count % ErrorBitmap::wordBits);
+
+        // Flush the bitmap word once complete
+        if (++count % ErrorBitmap::wordBits == 0) {
+            storeWord<Kind>(bitmap, count / ErrorBitmap::wordBits - 1, word, ErrorBitmap::wordBits);
+            nulls += std::popcount(word);
+            word = 0;
+        }
+
+        // Skip the delimiter
+        offset = next < size() ? next + 1 : next;
+    }
+
+    // Flush the incomplete bitmap word
+    if (count % ErrorBitmap::wordBits != 0) {
+        storeWord<Kind>(bitmap, count / ErrorBitmap::wordBits, word, count % ErrorBitmap::wordBits);
+        nulls += std::popcount(word);
+    }
+
+    return { count, offset, nulls };
+}
+
+template<typename T, typename Format>
+template<typename N,
+         SimdLevel Level,
+         typename BatchParser<T, Format>::Bitmap Kind,
+         typename Storage,
+         typename Cache>
+inline std::tuple<std::size_t, std::size_t> BatchParser<T, Format>::parseLevel(
+    std::span<const std::size_t> offsets,
+    std::span<N> values,
+    std::span<Storage> bitmap,
+    Cache cache) const
+{
+    const std::size_t count = offsets.empty() ? 0 : std::min(offsets.size() - 1, values.size());
+    std::size_t nulls = 0;
+
+    for (std::size_t base = 0; base < count; base += ErrorBitmap::wordBits) {
+        const std::size_t last = std::min(base + ErrorBitmap::wordBits, count);
+        ErrorBitmap::Word word = 0;
+        for (std::size_t i = base; i < last; i++) {
+            bool null = false;
+            values[i] = parseValue<N, Level, Kind>(data() + offsets[i], data() + offsets[i + 1], null, cache);
+            word |= ErrorBitmap::Word(null) << (i - base);
+        }
+        storeWord<Kind>(bitmap, base / ErrorBitmap::wordBits, word, last - base);
+        nulls += std::popcount(word);
+    }
+
+    return { count, nulls };
+}
+
+}; // namespace ieee754toy
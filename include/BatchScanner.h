@@ -0,0 +1,489 @@
+/*
+ * IEEE754 constexpr parser toy. Batch validating and counting pre-pass.
+ * Thanks to Algolia for giving me the opportunity to develop this toy!
+ * @maintainer Xavier Roche (xavier dot roche at algolia.com)
+ */
+#pragma once
+
+#include "BatchParser.h"
+#include "DigitScanner.h"
+#include "NumericalParser.h"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <tuple>
+
+namespace ieee754toy {
+
+/**
+ * Character classes of a block of 64 characters: bit #i of each mask is set if character #i is of the class.
+ **/
+struct CharacterClasses
+{
+    /** Number of characters of a block **/
+    static constexpr std::size_t blockSize = 64;
+
+    /** Classes **/
+    std::uint64_t digits = 0;
+    std::uint64_t signs = 0;      // '+' and '-'
+    std::uint64_t points = 0;     // The decimal point of the format
+    std::uint64_t exponents = 0;  // 'e' and 'E'
+    std::uint64_t separators = 0; // The digit separators of the format
+    std::uint64_t delimiters = 0;
+
+    /** The characters of none of the classes. **/
+    constexpr std::uint64_t others() const
+    {
+        return ~(digits | signs | points | exponents | separators | delimiters);
+    }
+};
+
+#if defined(IEEE754TOY_X86_KERNELS)
+/** Mask of the characters equal to value (AVX-512). **/
+[[gnu::target("avx512f,avx512bw,avx512vl")]] inline std::uint64_t equalMaskAVX512(const __m512i c,
+                                                                                   const char value)
+{
+    return _mm512_cmpeq_epi8_mask(c, _mm512_set1_epi8(value));
+}
+
+/** Classify 64 characters (AVX-512 kernel). **/
+template<typename Format>
+[[gnu::target("avx512f,avx512bw,avx512vl")]] inline CharacterClasses classifyCharactersAVX512(const char* s,
+                                                                                             char delimiter)
+{
+    const __m512i c = _mm512_loadu_si512(s);
+    CharacterClasses classes;
+    classes.digits = _mm512_cmple_epu8_mask(_mm512_sub_epi8(c, _mm512_set1_epi8('0')), _mm512_set1_epi8(9));
+    classes.signs = equalMaskAVX512(c, '+') | equalMaskAVX512(c, '-');
+    classes.points = equalMaskAVX512(c, Format::decimalPoint);
+    classes.exponents = equalMaskAVX512(c, 'e') | equalMaskAVX512(c, 'E');
+    for (const char separator : Format::digitSeparators) {
+        classes.separators |= equalMaskAVX512(c, separator);
+    }
+    classes.delimiters = equalMaskAVX512(c, delimiter);
+    return classes;
+}
+
+/** Mask of the characters equal to value (AVX2). **/
+[[gnu::target("avx2")]] inline std::uint64_t equalMaskAVX2(const __m256i c, const char value)
+{
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, _mm256_set1_epi8(value))));
+}
+
+/** Classify 32 characters (AVX2 kernel), the masks holding 32 bits. **/
+template<typename Format>
+[[gnu::target("avx2")]] inline CharacterClasses classifyCharactersAVX2(const char* s, char delimiter)
+{
+    const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+    const __m256i nine = _mm256_set1_epi8(9);
+    const __m256i digits = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+    CharacterClasses classes;
+    classes.digits = static_cast<std::uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(digits, nine), nine)));
+    classes.signs = equalMaskAVX2(c, '+') | equalMaskAVX2(c, '-');
+    classes.points = equalMaskAVX2(c, Format::decimalPoint);
+    classes.exponents = equalMaskAVX2(c, 'e') | equalMaskAVX2(c, 'E');
+    for (const char separator : Format::digitSeparators) {
+        classes.separators |= equalMaskAVX2(c, separator);
+    }
+    classes.delimiters = equalMaskAVX2(c, delimiter);
+    return classes;
+}
+
+/** Mask of the characters equal to value (SSE4.2). **/
+[[gnu::target("sse4.2")]] inline std::uint64_t equalMaskSSE42(const __m128i c, const char value)
+{
+    return static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(c, _mm_set1_epi8(value))));
+}
+
+/** Classify 16 characters (SSE4.2 kernel), the masks holding 16 bits. **/
+template<typename Format>
+[[gnu::target("sse4.2")]] inline CharacterClasses classifyCharactersSSE42(const char* s, char delimiter)
+{
+    const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i digits = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+    CharacterClasses classes;
+    classes.digits =
+        static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(digits, nine), nine)));
+    classes.signs = equalMaskSSE42(c, '+') | equalMaskSSE42(c, '-');
+    classes.points = equalMaskSSE42(c, Format::decimalPoint);
+    classes.exponents = equalMaskSSE42(c, 'e') | equalMaskSSE42(c, 'E');
+    for (const char separator : Format::digitSeparators) {
+        classes.separators |= equalMaskSSE42(c, separator);
+    }
+    classes.delimiters = equalMaskSSE42(c, delimiter);
+    return classes;
+}
+#endif
+
+#if defined(IEEE754TOY_NEON_KERNELS)
+/** Mask of the set bytes of a comparison result, one bit per byte (NEON). **/
+inline std::uint64_t byteMaskNEON(const uint8x16_t equal)
+{
+    // Gather one bit per byte with pairwise additions
+    constexpr std::uint8_t bits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    uint8x16_t sum = vandq_u8(equal, vld1q_u8(bits));
+    sum = vpaddq_u8(sum, sum);
+    sum = vpaddq_u8(sum, sum);
+    sum = vpaddq_u8(sum, sum);
+    return vgetq_lane_u16(vreinterpretq_u16_u8(sum), 0);
+}
+
+/** Mask of the characters equal to value (NEON). **/
+inline std::uint64_t equalMaskNEON(const uint8x16_t c, const char value)
+{
+    return byteMaskNEON(vceqq_u8(c, vdupq_n_u8(static_cast<std::uint8_t>(value))));
+}
+
+/** Classify 16 characters (NEON kernel), the masks holding 16 bits. **/
+template<typename Format>
+inline CharacterClasses classifyCharactersNEON(const char* s, char delimiter)
+{
+    const uint8x16_t c = vld1q_u8(reinterpret_cast<const std::uint8_t*>(s));
+    CharacterClasses classes;
+    classes.digits = byteMaskNEON(vcleq_u8(vsubq_u8(c, vdupq_n_u8('0')), vdupq_n_u8(9)));
+    classes.signs = equalMaskNEON(c, '+') | equalMaskNEON(c, '-');
+    classes.points = equalMaskNEON(c, Format::decimalPoint);
+    classes.exponents = equalMaskNEON(c, 'e') | equalMaskNEON(c, 'E');
+    for (const char separator : Format::digitSeparators) {
+        classes.separators |= equalMaskNEON(c, separator);
+    }
+    classes.delimiters = equalMaskNEON(c, delimiter);
+    return classes;
+}
+#endif
+
+/** Classify 64 characters (portable code). **/
+template<typename Format>
+inline CharacterClasses classifyCharactersScalar(const char* s, char delimiter)
+{
+    CharacterClasses classes;
+    for (std::size_t i = 0; i < CharacterClasses::blockSize; i++) {
+        const char c = s[i];
+        const std::uint64_t bit = std::uint64_t(1) << i;
+        classes.digits |= static_cast<unsigned char>(c - '0') < 10 ? bit : 0;
+        classes.signs |= c == '+' || c == '-' ? bit : 0;
+        classes.points |= c == Format::decimalPoint ? bit : 0;
+        classes.exponents |= c == 'e' || c == 'E' ? bit : 0;
+        classes.separators |= isDigitSeparator<Format>(c) ? bit : 0;
+        classes.delimiters |= c == delimiter ? bit : 0;
+    }
+    return classes;
+}
+
+/**
+ * Classify a block of CharacterClasses::blockSize characters.
+ * @comment Level The SIMD level of the kernel (see CpuDispatch.h)
+ * @comment Format The number format, defining the decimal point and the digit separators
+ * @param s The characters
+ * @param delimiter The values delimiter
+ * @return The classes of the characters
+ **/
+template<SimdLevel Level, typename Format>
+inline CharacterClasses classifyCharacters(const char* s, const char delimiter)
+{
+    // Narrower kernels classify the block in several parts
+    const auto combine = [s, delimiter](const auto& classify, const std::size_t part) {
+        CharacterClasses classes;
+        for (std::size_t i = 0; i < CharacterClasses::blockSize; i += part) {
+            const CharacterClasses partial = classify(s + i, delimiter);
+            classes.digits |= partial.digits << i;
+            classes.signs |= partial.signs << i;
+            classes.points |= partial.points << i;
+            classes.exponents |= partial.exponents << i;
+            classes.separators |= partial.separators << i;
+            classes.delimiters |= partial.delimiters << i;
+        }
+        return classes;
+    };
+#if defined(IEEE754TOY_X86_KERNELS)
+    if constexpr (Level == SimdLevel::AVX512) {
+        return classifyCharactersAVX512<Format>(s, delimiter);
+    } else if constexpr (Level == SimdLevel::AVX2) {
+        return combine(classifyCharactersAVX2<Format>, 32);
+    } else if constexpr (Level == SimdLevel::SSE42) {
+        return combine(classifyCharactersSSE42<Format>, 16);
+    }
+#elif defined(IEEE754TOY_NEON_KERNELS)
+    if constexpr (Level == SimdLevel::NEON) {
+        return combine(classifyCharactersNEON<Format>, 16);
+    }
+#endif
+    static_cast<void>(combine);
+    return classifyCharactersScalar<Format>(s, delimiter);
+}
+
+/**
+ * Batch numerical scanner: a pre-pass over a whole column of delimited numbers, without any numeric conversion,
+ * to count the values (eg. to size the output buffers beforehand), and to find the values and validate them (eg.
+ * to reject malformed files before parsing them).
+ * Validation follows the grammar of NumericalParser::parseMantissaExponent (as toAnyDouble does, special values
+ * excepted, which are invalid): characters are classified 64 at a time, and each value is
+ * checked against the classes masks (sign, mantissa digits with at most one decimal point, exponent marker, sign
+ * and digits). The values the masks can not decide (values longer than a block, exponents of more than four
+ * digits, hexadecimal floats, fixed-point formats, 16-bit or 32-bit code units) are checked by
+ * parseMantissaExponent itself.
+ * No memory is allocated.
+ * @comment Format The number format, see NumericalParser.
+ **/
+template<typename T, typename Format = DefaultNumberFormat>
+class BatchScanner : private std::span<T>
+{
+public:
+    /** Create a new batch scanner over a buffer **/
+    template<typename... Ts>
+    constexpr BatchScanner(Ts&&... args)
+      : std::span<T>(std::forward<Ts>(args)...)
+    {}
+
+    /**
+     * Count the values separated by a delimiter, as parsed by BatchParser::parse.
+     *
+     * @param delimiter The delimiter character. A trailing delimiter at the end of the buffer is ignored.
+     * @return The number of values.
+     */
+    std::size_t count(T delimiter) const
+    {
+        if (size() == 0) {
+            return 0;
+        }
+        const std::size_t delimiters =
+            dispatchSimdLevel([&]<SimdLevel Level>() { return countUnit<Level>(data(), size(), delimiter); });
+        return data()[size() - 1] != delimiter ? delimiters + 1 : delimiters;
+    }
+
+    /**
+     * Find and validate the values separated by a delimiter.
+     *
+     * @param delimiter The delimiter character. A trailing delimiter at the end of the buffer is ignored.
+     * @param[out] ends The end of each value: the position of its delimiter, or the buffer size for the last one.
+     * @param[out] errors The error bitmap (invalid values), holding at least ErrorBitmap::words(ends.size())
+     * words.
+     * @return A tuple of the number of values scanned, the number of characters consumed (including the
+     * delimiters), and the number of invalid values. If the ends span is too small, scanning stops at the
+     * beginning of the first value that does not fit, and can be resumed at the returned offset.
+     * @comment N The type whose exponent range is checked (see parseMantissaExponent).
+     * @comment Bits of the last error bitmap word beyond the number of values scanned are cleared.
+     */
+    template<typename N = double>
+    std::tuple<std::size_t, std::size_t, std::size_t> validate(T delimiter,
+                                                               std::span<std::size_t> ends,
+                                                               std::span<ErrorBitmap::Word> errors) const
+    {
+        return dispatchSimdLevel(
+            [&]<SimdLevel Level>() { return validateLevel<N, Level>(delimiter, ends, errors); });
+    }
+
+private:
+    using std::span<T>::size;
+    using std::span<T>::data;
+
+    /** Result of the validation of a value from the classes masks. **/
+    enum class Grammar
+    {
+        Valid,
+        Invalid,
+        Undecided, // To be checked by parseMantissaExponent
+    };
+
+    /** validate(), with the kernels of the given SIMD level. **/
+    template<typename N, SimdLevel Level>
+    inline std::tuple<std::size_t, std::size_t, std::size_t> validateLevel(
+        T delimiter,
+        std::span<std::size_t> ends,
+        std::span<ErrorBitmap::Word> errors) const;
+
+    /** Check the value spanning characters [begin, end) of a block, from its classes. **/
+    static constexpr Grammar check(const CharacterClasses& classes, std::size_t begin, std::size_t end);
+
+    /** Is the value spanning [begin, end) valid, as checked by parseMantissaExponent ? **/
+    template<typename N>
+    static constexpr bool valid(T* begin, T* end)
+    {
+        const auto [parsed, number] = NumericalParser<T, Format>(begin, end).template parseMantissaExponent<N>();
+        return parsed != 0 && parsed == static_cast<std::size_t>(end - begin);
+    }
+
+    /** Mask of the bits below the given position (at most 64). **/
+    static constexpr std::uint64_t bitsBelow(const std::size_t position)
+    {
+        return position < 64 ? (std::uint64_t(1) << position) - 1 : ~std::uint64_t(0);
+    }
+
+    /** Return the position of the next delimiter at or after offset, or size() if none. **/
+    template<SimdLevel Level>
+    inline std::size_t find(T delimiter, std::size_t offset) const
+    {
+        return BatchParser<T, Format>(data(), size()).template find<Level>(delimiter, offset);
+    }
+};
+
+// Deduction guides.
+template<typename Type>
+explicit BatchScanner(Type* begin, std::size_t size) -> BatchScanner<Type>;
+template<typename Type>
+explicit BatchScanner(Type* begin, Type* end) -> BatchScanner<Type>;
+
+template<typename T, typename Format>
+constexpr typename BatchScanner<T, Format>::Grammar BatchScanner<T, Format>::check(const CharacterClasses& classes,
+                                                                                   const std::size_t begin,
+                                                                                   const std::size_t end)
+{
+    const std::uint64_t value = bitsBelow(end) & ~bitsBelow(begin);
+    if (value == 0) {
+        return Grammar::Invalid;
+    } else if ((classes.others() & value) != 0) {
+        // Hexadecimal floats are left to the parser
+        return Format::hexFloats ? Grammar::Undecided : Grammar::Invalid;
+    }
+
+    // At most one exponent marker and one decimal point
+    const std::uint64_t exponents = classes.exponents & value;
+    const std::uint64_t points = classes.points & value;
+    if ((exponents & (exponents - 1)) != 0 || (points & (points - 1)) != 0) {
+        return Grammar::Invalid;
+    }
+
+    // The mantissa, before the exponent marker: at least one digit, and the point
+    const std::size_t marker = exponents != 0 ? std::countr_zero(exponents) : end;
+    const std::uint64_t mantissa = bitsBelow(marker) & value;
+    const std::uint64_t mantissaDigits = classes.digits & mantissa;
+    if (mantissaDigits == 0 || (points & ~mantissa) != 0) {
+        return Grammar::Invalid;
+    }
+
+    // Signs in front of the mantissa and of the exponent digits only
+    const std::uint64_t exponentSign = exponents << 1;
+    if ((classes.signs & value & ~((std::uint64_t(1) << begin) | exponentSign)) != 0) {
+        return Grammar::Invalid;
+    }
+
+    // The exponent digits, after the marker and its optional sign: long exponents may overflow
+    if (exponents != 0) {
+        const std::uint64_t exponent = value & ~mantissa & ~exponents;
+        const std::uint64_t exponentDigits = classes.digits & exponent;
+        if (exponentDigits == 0 || (exponent & ~exponentDigits & ~exponentSign) != 0) {
+            return Grammar::Invalid;
+        } else if (std::popcount(exponentDigits) > 4) {
+            return Grammar::Undecided;
+        }
+    }
+
+    // Digit separators between two mantissa digits
+    if constexpr (not Format::digitSeparators.empty()) {
+        const std::uint64_t separators = classes.separators & value;
+        if ((separators & ~mantissa) != 0 || (separators & ~(classes.digits << 1)) != 0 ||
+            (separators & ~(classes.digits >> 1)) != 0) {
+            return Grammar::Invalid;
+        }
+    }
+
+    // Leading and trailing decimal points, if disallowed by the format
+    if constexpr (not Format::leadingDot) {
+        if (points != 0 && (mantissaDigits & (points - 1)) == 0) {
+            return Grammar::Invalid;
+        }
+    }
+    if constexpr (not Format::trailingDot) {
+        if (points != 0 && (classes.digits & (points << 1)) == 0) {
+            return Grammar::Invalid;
+        }
+    }
+
+    return Grammar::Valid;
+}
+
+template<typename T, typename Format>
+template<typename N, SimdLevel Level>
+inline std::tuple<std::size_t, std::size_t, std::size_t> BatchScanner<T, Format>::validateLevel(
+    T delimiter,
+    std::span<std::size_t> ends,
+    std::span<ErrorBitmap::Word> errors) const
+{
+    std::size_t count = 0;
+    std::size_t offset = 0;
+    std::size_t invalid = 0;
+    ErrorBitmap::Word word = 0;
+
+    // Record a value, flushing the bitmap word once complete
+    const auto record = [&](const std::size_t end, const bool error) {
+        ends[count] = end;
+        word |= ErrorBitmap::Word(error) << (count % ErrorBitmap::wordBits);
+        if (++count % ErrorBitmap::wordBits == 0) {
+            errors[count / ErrorBitmap::wordBits - 1] = word;
+            invalid += std::popcount(word);
+            word = 0;
+        }
+    };
+
+    if constexpr (sizeof(T) == 1 && not Format::fixedPoint) {
+        // Each block starts with a value, and the values within the block are checked from the block classes
+        constexpr std::size_t blockSize = CharacterClasses::blockSize;
+        std::array<char, blockSize> padded;
+        while (offset < size() && count < ends.size()) {
+            const std::size_t available = std::min(blockSize, size() - offset);
+            const bool last = offset + available == size();
+            const char* block = reinterpret_cast<const char*>(data() + offset);
+            if (available < blockSize) {
+                padded.fill(static_cast<char>(delimiter));
+                std::memcpy(padded.data(), block, available);
+                block = padded.data();
+            }
+            const auto classes = classifyCharacters<Level, Format>(block, static_cast<char>(delimiter));
+            const auto checked = [&](const std::size_t begin, const std::size_t end) {
+                const Grammar grammar = check(classes, begin, end);
+                return grammar != Grammar::Undecided
+                           ? grammar == Grammar::Valid
+                           : valid<N>(data() + offset + begin, data() + offset + end);
+            };
+
+            // Values terminated within the block
+            std::size_t begin = 0;
+            for (auto delimiters = classes.delimiters & bitsBelow(available);
+                 delimiters != 0 && count < ends.size();
+                 delimiters &= delimiters - 1) {
+                const std::size_t end = std::countr_zero(delimiters);
+                record(offset + end, not checked(begin, end));
+                begin = end + 1;
+            }
+
+            if (count == ends.size()) {
+                offset += begin;
+            } else if (last) {
+                // The last value, unless after a trailing delimiter
+                if (begin < available) {
+                    record(size(), not checked(begin, available));
+                }
+                offset = size();
+            } else if (begin == 0) {
+                // A value longer than a block
+                const std::size_t end = find<Level>(delimiter, offset);
+                record(end, not valid<N>(data() + offset, data() + end));
+                offset = end < size() ? end + 1 : end;
+            } else {
+                offset += begin;
+            }
+        }
+    } else {
+        while (offset < size() && count < ends.size()) {
+            const std::size_t end = find<Level>(delimiter, offset);
+            record(end, not valid<N>(data() + offset, data() + end));
+            offset = end < size() ? end + 1 : end;
+        }
+    }
+
+    // Flush the incomplete bitmap word
+    if (count % ErrorBitmap::wordBits != 0) {
+        errors[count / ErrorBitmap::wordBits] = word;
+        invalid += std::popcount(word);
+    }
+
+    return { count, offset, invalid };
+}
+
+}; // namespace ieee754toy
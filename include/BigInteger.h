@@ -0,0 +1,213 @@
+/*
+ * IEEE754 constexpr parser toy. Fixed-width big integers.
+ * Thanks to Algolia for giving me the opportunity to develop this toy!
+ * @maintainer Xavier Roche (xavier dot roche at algolia.com)
+ */
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace ieee754toy {
+
+/**
+ * Fixed-width unsigned big integer, stored as little-endian 64-bit limbs.
+ * The number lives entirely inside the object (no allocation), so that it can be used in constexpr context.
+ *
+ * @comment Limbs Number of 64-bit limbs
+ * @warning Overflowing operations are silently truncated to the fixed width.
+ **/
+template<std::size_t Limbs>
+struct BigInteger
+{
+    using Limb = std::uint64_t;
+    using WideLimb = __uint128_t;
+
+    /** Number of bits per limb. **/
+    static constexpr std::size_t limbBits = sizeof(Limb) * 8;
+
+    /** Total number of bits. **/
+    static constexpr std::size_t bits = Limbs * limbBits;
+
+    /** Create a zero number. **/
+    constexpr BigInteger() = default;
+
+    /** Create a number from a single limb. **/
+    explicit constexpr BigInteger(Limb value)
+      : limbs{ value }
+    {}
+
+    /** Create a number from a big integer of another width (truncated to the fixed width). **/
+    template<std::size_t OtherLimbs>
+    explicit constexpr BigInteger(const BigInteger<OtherLimbs>& other)
+    {
+        for (std::size_t i = 0; i < Limbs && i < OtherLimbs; i++) {
+            limbs[i] = other.limbs[i];
+        }
+    }
+
+    /** Return 2**exponent. **/
+    static constexpr BigInteger powerOfTwo(std::size_t exponent)
+    {
+        BigInteger number;
+        number.limbs[exponent / limbBits] = Limb{ 1 } << (exponent % limbBits);
+        return number;
+    }
+
+    /** Return the number of significant bits (zero for zero). **/
+    constexpr std::size_t bitLength() const
+    {
+        const std::size_t size = significantLimbs();
+        return size != 0 ? (size - 1) * limbBits + std::bit_width(limbs[size - 1]) : 0;
+    }
+
+    /** Return the number of limbs, leading zero limbs excluded. **/
+    constexpr std::size_t significantLimbs() const
+    {
+        std::size_t size = Limbs;
+        while (size != 0 && limbs[size - 1] == 0) {
+            size--;
+        }
+        return size;
+    }
+
+    /** Compare with another number: return a negative value, zero, or a positive value. **/
+    constexpr int compare(const BigInteger& other) const
+    {
+        for (std::size_t i = Limbs; i != 0; i--) {
+            if (limbs[i - 1] != other.limbs[i - 1]) {
+                return limbs[i - 1] < other.limbs[i - 1] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    /** Multiply by a limb, and return the carry. **/
+    constexpr Limb multiply(Limb factor)
+    {
+        // Leading zero limbs are left untouched, only the carry may be stored in the first one
+        const std::size_t size = significantLimbs();
+        Limb carry = 0;
+        for (std::size_t i = 0; i < size; i++) {
+            const WideLimb product = WideLimb{ limbs[i] } * factor + carry;
+            limbs[i] = static_cast<Limb>(product);
+            carry = static_cast<Limb>(product >> limbBits);
+        }
+        if (size < Limbs) {
+            limbs[size] = carry;
+            return 0;
+        }
+        return carry;
+    }
+
+    /** Add a limb, and return the carry. **/
+    constexpr Limb add(Limb value)
+    {
+        for (auto& limb : limbs) {
+            limb += value;
+            if (limb >= value) {
+                return 0;
+            }
+            value = 1;
+        }
+        return value;
+    }
+
+    /** Divide by a (non-zero) limb, rounding toward zero, and return the remainder. **/
+    constexpr Limb divide(Limb divisor)
+    {
+        Limb remainder = 0;
+        for (std::size_t i = significantLimbs(); i != 0; i--) {
+            const WideLimb dividend = (WideLimb{ remainder } << limbBits) | limbs[i - 1];
+            limbs[i - 1] = static_cast<Limb>(dividend / divisor);
+            remainder = static_cast<Limb>(dividend % divisor);
+        }
+        return remainder;
+    }
+
+    /** Is any of the count least significant bits set ? **/
+    constexpr bool hasLowBits(std::size_t count) const
+    {
+        for (std::size_t i = 0; i < Limbs && count != 0; i++) {
+            const std::size_t bits = count < limbBits ? count : limbBits;
+            const Limb mask = bits < limbBits ? (Limb{ 1 } << bits) - 1 : ~Limb{ 0 };
+            if ((limbs[i] & mask) != 0) {
+                return true;
+            }
+            count -= bits;
+        }
+        return false;
+    }
+
+    /** Shift right by count bits. **/
+    constexpr void shiftRight(std::size_t count)
+    {
+        const std::size_t limbShift = count / limbBits;
+        const std::size_t bitShift = count % limbBits;
+        for (std::size_t i = 0; i < Limbs; i++) {
+            const std::size_t from = i + limbShift;
+            Limb limb = from < Limbs ? (limbs[from] >> bitShift) : 0;
+            if (bitShift != 0 && from + 1 < Limbs) {
+                limb |= limbs[from + 1] << (limbBits - bitShift);
+            }
+            limbs[i] = limb;
+        }
+    }
+
+    /** Shift left by count bits. **/
+    constexpr void shiftLeft(std::size_t count)
+    {
+        const std::size_t limbShift = count / limbBits;
+        const std::size_t bitShift = count % limbBits;
+
+        // Limbs above the shifted significant limbs stay zero
+        const std::size_t top = significantLimbs() + limbShift + 1;
+        for (std::size_t i = top < Limbs ? top : Limbs; i != 0; i--) {
+            const std::size_t to = i - 1;
+            Limb limb = to >= limbShift ? (limbs[to - limbShift] << bitShift) : 0;
+            if (bitShift != 0 && to >= limbShift + 1) {
+                limb |= limbs[to - limbShift - 1] >> (limbBits - bitShift);
+            }
+            limbs[to] = limb;
+        }
+    }
+
+    /** Return the 128 bits starting at bit offset, ie. (number >> offset) truncated to 128 bits. **/
+    constexpr WideLimb bits128(std::size_t offset) const
+    {
+        const auto limb = [this](std::size_t i) { return i < Limbs ? limbs[i] : Limb{ 0 }; };
+        const std::size_t index = offset / limbBits;
+        const std::size_t shift = offset % limbBits;
+        const WideLimb bits = (WideLimb{ limb(index + 1) } << limbBits) | limb(index);
+        return shift != 0 ? (bits >> shift) | (WideLimb{ limb(index + 2) } << (2 * limbBits - shift)) : bits;
+    }
+
+    /** Are all the count bits starting at bit offset set ? **/
+    constexpr bool hasAllBits(std::size_t offset, std::size_t count) const
+    {
+        for (std::size_t i = offset; i < offset + count;) {
+            const std::size_t shift = i % limbBits;
+            const std::size_t bits = limbBits - shift < offset + count - i ? limbBits - shift : offset + count - i;
+            const Limb mask = (bits < limbBits ? (Limb{ 1 } << bits) - 1 : ~Limb{ 0 }) << shift;
+            if (i / limbBits >= Limbs || (limbs[i / limbBits] & mask) != mask) {
+                return false;
+            }
+            i += bits;
+        }
+        return true;
+    }
+
+    /** Return the 128 least significant bits. **/
+    constexpr WideLimb low128() const
+    {
+        static_assert(Limbs >= 2);
+        return (WideLimb{ limbs[1] } << limbBits) | limbs[0];
+    }
+
+    /** Little-endian limbs. **/
+    std::array<Limb, Limbs> limbs{};
+};
+
+}; // namespace ieee754toy
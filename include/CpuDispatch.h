@@ -0,0 +1,218 @@
+/*
+ * IEEE754 constexpr parser toy. Runtime CPU dispatch.
+ * Thanks to Algolia for giving me the opportunity to develop this toy!
+ * @maintainer Xavier Roche (xavier dot roche at algolia.com)
+ */
+#pragma once
+
+/**
+ * SIMD levels of the digits scanning and batch parsing kernels. Kernels are selected at compile-time by a template
+ * parameter (see DefaultNumberFormat::simdLevel, following the compiler flags by default), and the batch parsers
+ * select the best level supported by the running CPU instead, once: the kernels of levels above the compiler flags
+ * are compiled with target attributes, so that a single binary can run on any CPU of the architecture.
+ * The level can be forced (eg. for benchmarking) with forceSimdLevel(), or with the IEEE754TOY_SIMD_LEVEL
+ * environment variable (eg. "scalar", or "sse4.2").
+ */
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define IEEE754TOY_X86_KERNELS
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define IEEE754TOY_NEON_KERNELS
+#endif
+
+namespace ieee754toy {
+
+/** SIMD levels, in increasing order on each architecture. **/
+enum class SimdLevel : std::uint8_t
+{
+    Scalar, // Portable code (eight digits at once in a 64-bit integer)
+    SSE42,  // x86-64 SSE4.2 (x86-64-v2)
+    AVX2,   // x86-64 AVX2 (x86-64-v3)
+    AVX512, // x86-64 AVX-512 F, BW and VL (x86-64-v4)
+    NEON,   // AArch64 Advanced SIMD
+};
+
+/** The level enabled by the compiler flags (eg. -march=native). **/
+inline constexpr SimdLevel compiledSimdLevel =
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512VL__)
+    SimdLevel::AVX512;
+#elif defined(__AVX2__)
+    SimdLevel::AVX2;
+#elif defined(__SSE4_2__)
+    SimdLevel::SSE42;
+#elif defined(IEEE754TOY_NEON_KERNELS)
+    SimdLevel::NEON;
+#else
+    SimdLevel::Scalar;
+#endif
+
+/** The levels of the current architecture, in increasing order. **/
+inline constexpr auto simdLevels = std::to_array<SimdLevel>({
+    SimdLevel::Scalar,
+#if defined(IEEE754TOY_X86_KERNELS)
+    SimdLevel::SSE42,
+    SimdLevel::AVX2,
+    SimdLevel::AVX512,
+#elif defined(IEEE754TOY_NEON_KERNELS)
+    SimdLevel::NEON,
+#endif
+});
+
+/** Return the level name (eg. "avx2"). **/
+inline constexpr std::string_view simdLevelName(const SimdLevel level)
+{
+    switch (level) {
+    case SimdLevel::Scalar:
+        return "scalar";
+    case SimdLevel::SSE42:
+        return "sse4.2";
+    case SimdLevel::AVX2:
+        return "avx2";
+    case SimdLevel::AVX512:
+        return "avx512";
+    case SimdLevel::NEON:
+        return "neon";
+    }
+    return "";
+}
+
+/** Return the level of the current architecture with the given name, if any. **/
+inline constexpr std::optional<SimdLevel> simdLevelFromName(const std::string_view name)
+{
+    for (const SimdLevel level : simdLevels) {
+        if (simdLevelName(level) == name) {
+            return level;
+        }
+    }
+    return std::nullopt;
+}
+
+static_assert(simdLevelFromName("scalar") == SimdLevel::Scalar);
+static_assert(not simdLevelFromName("mmx").has_value());
+
+/** Is the level supported by the running CPU ? **/
+inline bool simdLevelSupported(const SimdLevel level)
+{
+    switch (level) {
+    case SimdLevel::Scalar:
+        return true;
+#if defined(IEEE754TOY_X86_KERNELS)
+    case SimdLevel::SSE42:
+        return __builtin_cpu_supports("sse4.2");
+    case SimdLevel::AVX2:
+        return __builtin_cpu_supports("avx2");
+    case SimdLevel::AVX512:
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+               __builtin_cpu_supports("avx512vl");
+#elif defined(IEEE754TOY_NEON_KERNELS)
+    case SimdLevel::NEON:
+        // Advanced SIMD is mandatory on AArch64
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+/** Return the best level supported by the running CPU. **/
+inline SimdLevel detectSimdLevel()
+{
+    for (std::size_t i = simdLevels.size(); i-- > 1;) {
+        if (simdLevelSupported(simdLevels[i])) {
+            return simdLevels[i];
+        }
+    }
+    return SimdLevel::Scalar;
+}
+
+/**
+ * The level used by runtime dispatch, resolved once upon first use: the IEEE754TOY_SIMD_LEVEL environment
+ * variable if set to a supported level, or the best supported level.
+ **/
+inline std::atomic<SimdLevel>& selectedSimdLevel()
+{
+    static std::atomic<SimdLevel> level = [] {
+        const char* const name = std::getenv("IEEE754TOY_SIMD_LEVEL");
+        const auto forced = simdLevelFromName(name != nullptr ? name : "");
+        return forced.has_value() && simdLevelSupported(*forced) ? *forced : detectSimdLevel();
+    }();
+    return level;
+}
+
+/** Return the level used by runtime dispatch (see dispatchSimdLevel()). **/
+inline SimdLevel simdLevel()
+{
+    return selectedSimdLevel().load(std::memory_order_relaxed);
+}
+
+/**
+ * Force the level used by runtime dispatch (eg. for benchmarking).
+ * @return @c false if the level is not supported by the running CPU (the level is then unchanged)
+ * @comment Concurrent batch parsers may still use the previous level until they return.
+ **/
+inline bool forceSimdLevel(const SimdLevel level)
+{
+    if (not simdLevelSupported(level)) {
+        return false;
+    }
+    selectedSimdLevel().store(level, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * Per-level trampolines: the whole call tree is inlined (flatten attribute), and compiled for the level (target
+ * attribute), including the kernels of the level.
+ **/
+#if defined(IEEE754TOY_X86_KERNELS)
+template<typename F>
+[[gnu::target("sse4.2"), gnu::flatten]] inline decltype(auto) callSSE42(const F& f)
+{
+    return f.template operator()<SimdLevel::SSE42>();
+}
+
+template<typename F>
+[[gnu::target("avx2"), gnu::flatten]] inline decltype(auto) callAVX2(const F& f)
+{
+    return f.template operator()<SimdLevel::AVX2>();
+}
+
+template<typename F>
+[[gnu::target("avx512f,avx512bw,avx512vl"), gnu::flatten]] inline decltype(auto) callAVX512(const F& f)
+{
+    return f.template operator()<SimdLevel::AVX512>();
+}
+#endif
+
+/**
+ * Call a template function object with the level used by runtime dispatch (see simdLevel()).
+ * @param f The function object, called as f.template operator()<Level>() (eg. a template lambda)
+ * @return The value returned by f
+ **/
+template<typename F>
+inline decltype(auto) dispatchSimdLevel(const F& f)
+{
+    switch (simdLevel()) {
+#if defined(IEEE754TOY_X86_KERNELS)
+    case SimdLevel::AVX512:
+        return callAVX512(f);
+    case SimdLevel::AVX2:
+        return callAVX2(f);
+    case SimdLevel::SSE42:
+        return callSSE42(f);
+#elif defined(IEEE754TOY_NEON_KERNELS)
+    case SimdLevel::NEON:
+        return f.template operator()<SimdLevel::NEON>();
+#endif
+    default:
+        return f.template operator()<SimdLevel::Scalar>();
+    }
+}
+
+}; // namespace ieee754toy
@@ -0,0 +1,303 @@
+/*
+ * IEEE754 constexpr parser toy. Decimal outputs.
+ * Thanks to Algolia for giving me the opportunity to develop this toy!
+ * @maintainer Xavier Roche (xavier dot roche at algolia.com)
+ */
+#pragma once
+
+/**
+ * Decimal outputs: value types converted straight from the parsed base-10 form (mantissa · 10^exponent), without
+ * going through binary floating point (see NumericalParser::parseDecimal()). Their rounding is decimal (half to
+ * even), and exact whenever the value fits.
+ * References:
+ * <https://en.wikipedia.org/wiki/Decimal64_floating-point_format>
+ */
+
+#include "IEEE754.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+
+namespace ieee754toy {
+
+/**
+ * A fixed-scale integer: the value multiplied by 10^Scale (eg. ScaledInteger<4> holds 1234.56 as 12345600). It is
+ * layout-compatible with std::int64_t.
+ **/
+template<int Scale>
+struct ScaledInteger
+{
+    static constexpr int scale = Scale;
+
+    std::int64_t value;
+
+    constexpr bool operator==(const ScaledInteger&) const = default;
+};
+
+/**
+ * An IEEE 754-2008 decimal64 number, in the binary integer decimal (BID) encoding: storage only. The coefficient
+ * is not normalized: the parsed exponent is kept when possible (eg. "1.50" is 150 · 10^-2).
+ **/
+struct Decimal64
+{
+    /** Largest coefficient (sixteen digits) **/
+    static constexpr std::uint64_t maxCoefficient = 9999999999999999;
+
+    /** Exponents range of the integral coefficient **/
+    static constexpr int minExponent = -398;
+    static constexpr int maxExponent = 369;
+
+    std::uint64_t bits;
+
+    constexpr bool operator==(const Decimal64&) const = default;
+
+    /** Encode a number, the exponent being in range. **/
+    static constexpr Decimal64 encode(bool negative, std::uint64_t coefficient, int exponent);
+
+    /** Return signed infinity. **/
+    static constexpr Decimal64 infinity(const bool negative)
+    {
+        return { (negative ? std::uint64_t{ 1 } << 63 : 0) | 0x7800000000000000 };
+    }
+
+    /** Return a quiet NaN. **/
+    static constexpr Decimal64 nan() { return { 0x7C00000000000000 }; }
+
+    /** Is the number a NaN (quiet or signaling) ? **/
+    constexpr bool isNaN() const { return (bits & 0x7C00000000000000) == 0x7C00000000000000; }
+};
+
+/** Is the type a decimal output ? **/
+template<typename V>
+inline constexpr bool isDecimalOutput = false;
+template<int Scale>
+inline constexpr bool isDecimalOutput<ScaledInteger<Scale>> = true;
+template<>
+inline constexpr bool isDecimalOutput<Decimal64> = true;
+
+/** Accuracy of a decimal conversion, in the order of ParseError. **/
+enum class DecimalConversion : std::uint8_t
+{
+    /** The value is exactly the number **/
+    Exact,
+
+    /** The value is the number rounded (half to even) **/
+    Inexact,
+
+    /** A non-zero number was rounded to zero **/
+    Underflow,
+
+    /** The number is too large (the value is then saturated, or infinity) **/
+    Overflow,
+};
+
+/**
+ * The digits dropped after a truncated mantissa, compared with half a unit of its last digit: the number is the
+ * mantissa plus a tail, below one unit.
+ **/
+enum class DecimalTail : std::uint8_t
+{
+    Zero,
+    BelowHalf,
+    Half,
+    AboveHalf,
+};
+
+/**
+ * Divide a truncated mantissa by a power of ten, rounded half to even.
+ * @param mantissa The mantissa
+ * @param digits The number of digits to drop (at most 19)
+ * @param tail The digits dropped after the mantissa itself, if it holds the leading digits of a longer number
+ * @return A tuple of the quotient, and whether the division is exact.
+ **/
+inline constexpr std::tuple<std::uint64_t, bool> divideRounded(const std::uint64_t mantissa,
+                                                               const unsigned digits,
+                                                               const DecimalTail tail)
+{
+    const std::uint64_t divisor = power(std::uint64_t{ 10 }, digits);
+    const std::uint64_t quotient = mantissa / divisor;
+    const std::uint64_t remainder = mantissa % divisor;
+    const bool odd = (quotient & 1) != 0;
+
+    // The tail is below one unit of the mantissa: it only matters when the remainder is half-way, or zero
+    bool up;
+    if (digits == 0) {
+        up = tail == DecimalTail::AboveHalf || (tail == DecimalTail::Half && odd);
+    } else {
+        const std::uint64_t half = divisor / 2;
+        up = remainder > half || (remainder == half && (tail != DecimalTail::Zero || odd));
+    }
+    return { quotient + (up ? 1 : 0), remainder == 0 && tail == DecimalTail::Zero };
+}
+
+static_assert(divideRounded(1234, 2, DecimalTail::Zero) == std::make_tuple(12, false));
+static_assert(divideRounded(1250, 2, DecimalTail::Zero) == std::make_tuple(12, false));
+static_assert(divideRounded(1350, 2, DecimalTail::Zero) == std::make_tuple(14, false));
+static_assert(divideRounded(1250, 2, DecimalTail::BelowHalf) == std::make_tuple(13, false));
+static_assert(divideRounded(1200, 2, DecimalTail::Zero) == std::make_tuple(12, true));
+static_assert(divideRounded(1200, 2, DecimalTail::AboveHalf) == std::make_tuple(12, false));
+static_assert(divideRounded(12, 0, DecimalTail::Half) == std::make_tuple(12, false));
+static_assert(divideRounded(13, 0, DecimalTail::Half) == std::make_tuple(14, false));
+
+/** Return the number of decimal digits of a number (one for zero). **/
+inline constexpr int decimalDigits(const std::uint64_t number)
+{
+    // floor(log10(2^bits)), corrected by one
+    const int digits = (static_cast<int>(bitWidth(number | 1)) * 1233) >> 12;
+    return std::max(digits + (number >= power(std::uint64_t{ 10 }, digits) ? 1 : 0), 1);
+}
+
+static_assert(decimalDigits(0) == 1 && decimalDigits(9) == 1 && decimalDigits(10) == 2);
+static_assert(decimalDigits(999999999999999999) == 18 && decimalDigits(1000000000000000000) == 19);
+static_assert(decimalDigits(std::numeric_limits<std::uint64_t>::max()) == 20);
+
+/**
+ * Convert a base-10 number to a scaled integer, rounded half to even.
+ * @param tail The digits dropped after the mantissa, which is then truncated (see divideRounded())
+ * @return A tuple of the value, and the accuracy of the conversion.
+ **/
+template<typename V, typename N>
+inline constexpr std::tuple<V, DecimalConversion> toScaledInteger(const IEEE754Number<N, 10>& number,
+                                                                  const DecimalTail tail)
+{
+    const bool negative = number.negative;
+    const auto mantissa = static_cast<std::uint64_t>(number.mantissa);
+    static_assert(sizeof(number.mantissa) <= sizeof(mantissa));
+
+    // The magnitude limit, and the saturated value upon overflow
+    const std::uint64_t limit = std::uint64_t{ std::numeric_limits<std::int64_t>::max() } + (negative ? 1 : 0);
+    const auto value = [negative](const std::uint64_t magnitude) {
+        return V{ static_cast<std::int64_t>(negative ? std::uint64_t{ 0 } - magnitude : magnitude) };
+    };
+    const std::tuple<V, DecimalConversion> overflow = { value(limit), DecimalConversion::Overflow };
+
+    if (mantissa == 0) {
+        return { V{ 0 }, DecimalConversion::Exact };
+    }
+
+    const int exponent = static_cast<int>(number.exponent) + V::scale;
+    if (exponent >= 0) {
+        // The mantissa is at least one, and 10^19 does not fit
+        if (exponent > 18) {
+            return overflow;
+        }
+        const std::uint64_t factor = power(std::uint64_t{ 10 }, exponent);
+        if (mantissa > limit / factor) {
+            return overflow;
+        }
+
+        // Without fraction digits, the tail may still round the mantissa up
+        if (exponent == 0) {
+            const auto [rounded, exact] = divideRounded(mantissa, 0, tail);
+            if (rounded > limit) {
+                return overflow;
+            }
+            return { value(rounded), exact ? DecimalConversion::Exact : DecimalConversion::Inexact };
+        }
+        return { value(mantissa * factor),
+                 tail == DecimalTail::Zero ? DecimalConversion::Exact : DecimalConversion::Inexact };
+    }
+
+    // Below half the unit (the mantissa has at most twenty digits)
+    if (exponent < -19) {
+        return { V{ 0 }, DecimalConversion::Underflow };
+    }
+    const auto [quotient, exact] = divideRounded(mantissa, static_cast<unsigned>(-exponent), tail);
+    if (quotient > limit) {
+        return overflow;
+    }
+    return { value(quotient),
+             exact           ? DecimalConversion::Exact
+             : quotient != 0 ? DecimalConversion::Inexact
+                             : DecimalConversion::Underflow };
+}
+
+/**
+ * Convert a base-10 number to decimal64, rounded half to even to sixteen digits (and to the subnormal range).
+ * @param tail The digits dropped after the mantissa, which is then truncated (see divideRounded())
+ * @return A tuple of the value, and the accuracy of the conversion.
+ **/
+template<typename N>
+inline constexpr std::tuple<Decimal64, DecimalConversion> toDecimal64(const IEEE754Number<N, 10>& number,
+                                                                      const DecimalTail tail)
+{
+    const bool negative = number.negative;
+    const auto mantissa = static_cast<std::uint64_t>(number.mantissa);
+    static_assert(sizeof(number.mantissa) <= sizeof(mantissa));
+
+    // Drop the digits beyond sixteen, or below the smallest exponent, rounding once
+    int exponent = number.exponent;
+    const int drop = std::max({ decimalDigits(mantissa) - 16, Decimal64::minExponent - exponent, 0 });
+
+    std::uint64_t coefficient = mantissa;
+    bool exact = tail == DecimalTail::Zero;
+    if (drop > 19) {
+        // Below half the smallest subnormal number (the mantissa has at most twenty digits)
+        coefficient = 0;
+        exact = mantissa == 0;
+        exponent = Decimal64::minExponent;
+    } else if (drop > 0 || not exact) {
+        std::tie(coefficient, exact) = divideRounded(mantissa, static_cast<unsigned>(drop), tail);
+        exponent += drop;
+        if (coefficient > Decimal64::maxCoefficient) {
+            coefficient /= 10;
+            exponent++;
+        }
+    }
+
+    // Large exponents are first lowered into the coefficient, which may then overflow
+    if (coefficient == 0) {
+        exponent = std::clamp(exponent, Decimal64::minExponent, Decimal64::maxExponent);
+    }
+    while (exponent > Decimal64::maxExponent && coefficient <= Decimal64::maxCoefficient / 10) {
+        coefficient *= 10;
+        exponent--;
+    }
+    if (exponent > Decimal64::maxExponent) {
+        return { Decimal64::infinity(negative), DecimalConversion::Overflow };
+    }
+
+    return { Decimal64::encode(negative, coefficient, exponent),
+             exact                              ? DecimalConversion::Exact
+             : coefficient != 0 || mantissa == 0 ? DecimalConversion::Inexact
+                                                : DecimalConversion::Underflow };
+}
+
+/**
+ * Convert a base-10 number to a decimal output.
+ * @param tail The digits dropped after the mantissa, which is then truncated (see divideRounded())
+ * @return A tuple of the value, and the accuracy of the conversion.
+ **/
+template<typename V, typename N>
+inline constexpr std::tuple<V, DecimalConversion> toDecimalOutput(const IEEE754Number<N, 10>& number,
+                                                                  const DecimalTail tail = DecimalTail::Zero)
+{
+    static_assert(isDecimalOutput<V>);
+    if constexpr (std::is_same_v<V, Decimal64>) {
+        return toDecimal64(number, tail);
+    } else {
+        return toScaledInteger<V>(number, tail);
+    }
+}
+
+constexpr Decimal64 Decimal64::encode(const bool negative, const std::uint64_t coefficient, const int exponent)
+{
+    const std::uint64_t sign = negative ? std::uint64_t{ 1 } << 63 : 0;
+    const auto biased = static_cast<std::uint64_t>(exponent - minExponent);
+
+    // Coefficients of 54 bits have an implicit "100" prefix, the exponent being shifted by two bits
+    if (coefficient < std::uint64_t{ 1 } << 53) {
+        return { sign | biased << 53 | coefficient };
+    }
+    return { sign | std::uint64_t{ 3 } << 61 | biased << 51 | (coefficient & ((std::uint64_t{ 1 } << 51) - 1)) };
+}
+
+static_assert(Decimal64::encode(false, 1, 0).bits == 0x31C0000000000001);
+static_assert(Decimal64::encode(true, 15, -1).bits == 0xB1A000000000000F);
+static_assert(Decimal64::encode(false, Decimal64::maxCoefficient, Decimal64::maxExponent).bits ==
+              0x77FB86F26FC0FFFF);
+
+}; // namespace ieee754toy
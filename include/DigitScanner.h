@@ -0,0 +1,558 @@
+/*
+ * IEEE754 constexpr parser toy. Multiple digits scanning.
+ * Thanks to Algolia for giving me the opportunity to develop this toy!
+ * @maintainer Xavier Roche (xavier dot roche at algolia.com)
+ */
+#pragma once
+
+/**
+ * Digits scanning helpers, checking and converting several 8-bit digits at once, and code units search helpers.
+ * 16-bit and 32-bit code units (eg. UTF-16 or UTF-32 strings) are first narrowed to bytes, with a saturation that
+ * can not yield any digit.
+ * The SIMD kernels are selected by a template parameter (the compile-time level by default): kernels above the
+ * compiler flags are compiled with target attributes, and must only be called if the CPU supports them (see
+ * CpuDispatch.h).
+ * References:
+ * <https://lemire.me/blog/2022/01/21/swar-explained-parsing-eight-digits/>
+ * <http://0x80.pl/articles/simd-parsing-int-sequences.html>
+ */
+
+#include "CpuDispatch.h"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(IEEE754TOY_X86_KERNELS)
+#include <immintrin.h>
+#elif defined(IEEE754TOY_NEON_KERNELS)
+#include <arm_neon.h>
+#endif
+
+namespace ieee754toy {
+
+/** Load eight bytes, the first byte being the least significant one (little-endian order). **/
+inline std::uint64_t loadEightBytes(const char* s)
+{
+    std::uint64_t value;
+    std::memcpy(&value, s, sizeof(value));
+    if constexpr (std::endian::native == std::endian::big) {
+        value = __builtin_bswap64(value);
+    }
+    return value;
+}
+
+/** Load eight 8-bit code units, see loadEightBytes(). **/
+inline std::uint64_t loadEightUnits(const char* s)
+{
+    return loadEightBytes(s);
+}
+
+/**
+ * Load eight 16-bit code units, narrowed to bytes (the first unit being the least significant byte). Units above
+ * 0xFF are saturated to 0xFF, and are therefore never taken as digits.
+ **/
+inline std::uint64_t loadEightUnits(const char16_t* s)
+{
+#if defined(__SSE2__)
+    // Units between 0x8000 and 0xFFFF are taken as signed, and saturate to zero
+    const __m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+    std::uint64_t value;
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(&value), _mm_packus_epi16(units, units));
+    return value;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const uint8x8_t bytes = vqmovn_u16(vld1q_u16(reinterpret_cast<const std::uint16_t*>(s)));
+    return vget_lane_u64(vreinterpret_u64_u8(bytes), 0);
+#else
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < 8; i++) {
+        value |= std::uint64_t{ s[i] <= 0xFF ? static_cast<std::uint8_t>(s[i]) : std::uint8_t{ 0xFF } } << (i * 8);
+    }
+    return value;
+#endif
+}
+
+/**
+ * Load eight 32-bit code units, narrowed to bytes (the first unit being the least significant byte). Units above
+ * 0xFF are saturated to 0xFF (or zero), and are therefore never taken as digits.
+ **/
+inline std::uint64_t loadEightUnits(const char32_t* s)
+{
+#if defined(__SSE2__)
+    // Signed saturation to 16-bit (units above 0x7FFFFFFF saturate to zero), then to 8-bit
+    const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+    const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 4));
+    const __m128i shorts = _mm_packs_epi32(low, high);
+    std::uint64_t value;
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(&value), _mm_packus_epi16(shorts, shorts));
+    return value;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const auto* const units = reinterpret_cast<const std::uint32_t*>(s);
+    const uint16x8_t shorts = vcombine_u16(vqmovn_u32(vld1q_u32(units)), vqmovn_u32(vld1q_u32(units + 4)));
+    return vget_lane_u64(vreinterpret_u64_u8(vqmovn_u16(shorts)), 0);
+#else
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < 8; i++) {
+        value |= std::uint64_t{ s[i] <= 0xFF ? static_cast<std::uint8_t>(s[i]) : std::uint8_t{ 0xFF } } << (i * 8);
+    }
+    return value;
+#endif
+}
+
+/** Are the eight bytes (little-endian order) all ascii digits ? **/
+inline constexpr bool isEightDigits(std::uint64_t value)
+{
+    // Bytes above '9' overflow when adding 0x46, and bytes below '0' underflow when subtracting 0x30
+    return (((value + 0x4646464646464646) | (value - 0x3030303030303030)) & 0x8080808080808080) == 0;
+}
+
+/** Convert eight ascii digits (little-endian order, ie. the first digit is the least significant byte). **/
+inline constexpr std::uint32_t parseEightDigits(std::uint64_t value)
+{
+    constexpr std::uint64_t mask = 0x000000FF000000FF;
+    constexpr std::uint64_t mul1 = 100 + (std::uint64_t{ 1000000 } << 32);
+    constexpr std::uint64_t mul2 = 1 + (std::uint64_t{ 10000 } << 32);
+
+    // Digits values
+    value -= 0x3030303030303030;
+
+    // Pairs of digits (each 16-bit lane holds 10 * d0 + d1)
+    value = (value * 10) + (value >> 8);
+
+    // Combine the four pairs
+    return static_cast<std::uint32_t>((((value & mask) * mul1) + (((value >> 16) & mask) * mul2)) >> 32);
+}
+
+// Basic checks ("12345678" and "1234567/" in little-endian order)
+static_assert(isEightDigits(0x3837363534333231));
+static_assert(not isEightDigits(0x2F37363534333231));
+static_assert(not isEightDigits(0x3837363534333A31));
+static_assert(parseEightDigits(0x3837363534333231) == 12345678);
+static_assert(parseEightDigits(0x3030303030303030) == 0);
+static_assert(parseEightDigits(0x3939393939393939) == 99999999);
+
+/**
+ * Check and convert sixteen ascii digits, loaded as two eight bytes values (see loadEightUnits()).
+ * @param high The eight first characters
+ * @param low The eight last characters
+ * @param[out] value The converted value, if successful
+ * @return @c true if the characters were all digits
+ **/
+inline bool parseSixteenDigits(const std::uint64_t high, const std::uint64_t low, std::uint64_t& value)
+{
+    if (not isEightDigits(high) || not isEightDigits(low)) {
+        return false;
+    }
+    value = std::uint64_t{ parseEightDigits(high) } * 100000000 + parseEightDigits(low);
+    return true;
+}
+
+#if defined(IEEE754TOY_X86_KERNELS)
+/** Convert sixteen digits values (0 to 9), the first digit being the lowest byte. **/
+[[gnu::target("sse4.2")]] inline std::uint64_t convertSixteenDigitsSSE42(const __m128i digits)
+{
+    // Pairs, then quads, then octets of digits
+    const __m128i pairs =
+        _mm_maddubs_epi16(digits, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1));
+    const __m128i quads = _mm_madd_epi16(pairs, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+    const __m128i packed = _mm_packus_epi32(quads, quads);
+    const __m128i octets = _mm_madd_epi16(packed, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+
+    const auto high = static_cast<std::uint32_t>(_mm_cvtsi128_si32(octets));
+    const auto low = static_cast<std::uint32_t>(_mm_extract_epi32(octets, 1));
+    return std::uint64_t{ high } * 100000000 + low;
+}
+
+/**
+ * Check and convert sixteen ascii digits (SSE4.2 and AVX2 kernels).
+ * @param chunk The sixteen characters to be converted
+ * @param[out] value The converted value, if successful
+ * @return @c true if the characters were all digits
+ **/
+[[gnu::target("sse4.2")]] inline bool parseSixteenDigitsSSE42(const __m128i chunk, std::uint64_t& value)
+{
+    const __m128i digits = _mm_sub_epi8(chunk, _mm_set1_epi8('0'));
+
+    // Unsigned digits values below or equal to 9
+    const __m128i nine = _mm_set1_epi8(9);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(digits, nine), nine)) != 0xFFFF) {
+        return false;
+    }
+
+    value = convertSixteenDigitsSSE42(digits);
+    return true;
+}
+
+/** Check and convert sixteen ascii digits (AVX-512 kernel), see parseSixteenDigitsSSE42(). **/
+[[gnu::target("avx512f,avx512bw,avx512vl")]] inline bool parseSixteenDigitsAVX512(const __m128i chunk,
+                                                                                  std::uint64_t& value)
+{
+    const __m128i digits = _mm_sub_epi8(chunk, _mm_set1_epi8('0'));
+    if (_mm_cmpgt_epu8_mask(digits, _mm_set1_epi8(9)) != 0) {
+        return false;
+    }
+
+    value = convertSixteenDigitsSSE42(digits);
+    return true;
+}
+
+/** Narrow sixteen 16-bit code units to bytes, see loadEightUnits(). **/
+[[gnu::target("sse4.2")]] inline __m128i loadSixteenUnitsSSE42(const char16_t* s)
+{
+    const auto* const units = reinterpret_cast<const __m128i*>(s);
+    return _mm_packus_epi16(_mm_loadu_si128(units), _mm_loadu_si128(units + 1));
+}
+
+/** Narrow sixteen 32-bit code units to bytes, see loadEightUnits(). **/
+[[gnu::target("sse4.2")]] inline __m128i loadSixteenUnitsSSE42(const char32_t* s)
+{
+    const auto* const units = reinterpret_cast<const __m128i*>(s);
+    const __m128i low = _mm_packs_epi32(_mm_loadu_si128(units), _mm_loadu_si128(units + 1));
+    const __m128i high = _mm_packs_epi32(_mm_loadu_si128(units + 2), _mm_loadu_si128(units + 3));
+    return _mm_packus_epi16(low, high);
+}
+
+/** Narrow sixteen 16-bit code units to bytes, with a single 256-bit load. **/
+[[gnu::target("avx2")]] inline __m128i loadSixteenUnitsAVX2(const char16_t* s)
+{
+    // Packing is done within each 128-bit lane: the eight first bytes of each lane are then gathered
+    const __m256i units = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+    const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(units, units), 0x08);
+    return _mm256_castsi256_si128(packed);
+}
+
+/** Narrow sixteen 32-bit code units to bytes, with two 256-bit loads. **/
+[[gnu::target("avx2")]] inline __m128i loadSixteenUnitsAVX2(const char32_t* s)
+{
+    // Each 128-bit lane holds four units of each half, once packed: gather them in order
+    const auto* const units = reinterpret_cast<const __m256i*>(s);
+    const __m256i shorts = _mm256_packs_epi32(_mm256_loadu_si256(units), _mm256_loadu_si256(units + 1));
+    const __m256i bytes = _mm256_packus_epi16(shorts, shorts);
+    const __m256i gathered = _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+    return _mm256_castsi256_si128(gathered);
+}
+
+/** Narrow sixteen 16-bit code units to bytes, with unsigned saturation (units above 0xFF yield 0xFF). **/
+[[gnu::target("avx512f,avx512bw,avx512vl")]] inline __m128i loadSixteenUnitsAVX512(const char16_t* s)
+{
+    return _mm256_maskz_cvtusepi16_epi8(0xFFFF, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s)));
+}
+
+/** Narrow sixteen 32-bit code units to bytes, with unsigned saturation (units above 0xFF yield 0xFF). **/
+[[gnu::target("avx512f,avx512bw,avx512vl")]] inline __m128i loadSixteenUnitsAVX512(const char32_t* s)
+{
+    return _mm512_maskz_cvtusepi32_epi8(0xFFFF, _mm512_loadu_si512(s));
+}
+#endif
+
+#if defined(IEEE754TOY_NEON_KERNELS)
+/** Check and convert sixteen ascii digits (NEON kernel), see parseSixteenDigits(). **/
+inline bool parseSixteenDigitsNEON(const char* s, std::uint64_t& value)
+{
+    // Check the sixteen digits at once
+    const uint8x16_t digits = vsubq_u8(vld1q_u8(reinterpret_cast<const std::uint8_t*>(s)), vdupq_n_u8('0'));
+    if (vmaxvq_u8(digits) > 9) {
+        return false;
+    }
+    const std::uint64_t high = loadEightBytes(s);
+    const std::uint64_t low = loadEightBytes(s + 8);
+    value = std::uint64_t{ parseEightDigits(high) } * 100000000 + parseEightDigits(low);
+    return true;
+}
+#endif
+
+/**
+ * Check and convert sixteen ascii digits.
+ * @comment Level The SIMD level of the kernel (see CpuDispatch.h)
+ * @param s The sixteen characters to be converted
+ * @param[out] value The converted value, if successful
+ * @return @c true if the characters were all digits
+ **/
+template<SimdLevel Level = compiledSimdLevel>
+inline bool parseSixteenDigits(const char* s, std::uint64_t& value)
+{
+#if defined(IEEE754TOY_X86_KERNELS)
+    if constexpr (Level == SimdLevel::AVX512) {
+        return parseSixteenDigitsAVX512(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s)), value);
+    } else if constexpr (Level == SimdLevel::AVX2 || Level == SimdLevel::SSE42) {
+        return parseSixteenDigitsSSE42(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s)), value);
+    }
+#elif defined(IEEE754TOY_NEON_KERNELS)
+    if constexpr (Level == SimdLevel::NEON) {
+        return parseSixteenDigitsNEON(s, value);
+    }
+#endif
+    return parseSixteenDigits(loadEightBytes(s), loadEightBytes(s + 8), value);
+}
+
+/**
+ * Check and convert sixteen ascii digits, from 16-bit code units.
+ * @comment Level The SIMD level of the kernel (see CpuDispatch.h)
+ * @param s The sixteen characters to be converted
+ * @param[out] value The converted value, if successful
+ * @return @c true if the characters were all digits
+ **/
+template<SimdLevel Level = compiledSimdLevel>
+inline bool parseSixteenDigits(const char16_t* s, std::uint64_t& value)
+{
+#if defined(IEEE754TOY_X86_KERNELS)
+    if constexpr (Level == SimdLevel::AVX512) {
+        return parseSixteenDigitsAVX512(loadSixteenUnitsAVX512(s), value);
+    } else if constexpr (Level == SimdLevel::AVX2) {
+        return parseSixteenDigitsSSE42(loadSixteenUnitsAVX2(s), value);
+    } else if constexpr (Level == SimdLevel::SSE42) {
+        return parseSixteenDigitsSSE42(loadSixteenUnitsSSE42(s), value);
+    }
+#endif
+    return parseSixteenDigits(loadEightUnits(s), loadEightUnits(s + 8), value);
+}
+
+/**
+ * Check and convert sixteen ascii digits, from 32-bit code units.
+ * @comment Level The SIMD level of the kernel (see CpuDispatch.h)
+ * @param s The sixteen characters to be converted
+ * @param[out] value The converted value, if successful
+ * @return @c true if the characters were all digits
+ **/
+template<SimdLevel Level = compiledSimdLevel>
+inline bool parseSixteenDigits(const char32_t* s, std::uint64_t& value)
+{
+#if defined(IEEE754TOY_X86_KERNELS)
+    if constexpr (Level == SimdLevel::AVX512) {
+        return parseSixteenDigitsAVX512(loadSixteenUnitsAVX512(s), value);
+    } else if constexpr (Level == SimdLevel::AVX2) {
+        return parseSixteenDigitsSSE42(loadSixteenUnitsAVX2(s), value);
+    } else if constexpr (Level == SimdLevel::SSE42) {
+        return parseSixteenDigitsSSE42(loadSixteenUnitsSSE42(s), value);
+    }
+#endif
+    return parseSixteenDigits(loadEightUnits(s), loadEightUnits(s + 8), value);
+}
+
+#if defined(IEEE754TOY_X86_KERNELS)
+/** Find a 16-bit or 32-bit code unit in a block of 16 bytes (SSE4.2 kernel), and return its index, or count. **/
+template<typename T>
+[[gnu::target("sse4.2")]] inline std::size_t findUnitSSE42(const T* s, std::size_t count, T unit)
+{
+    constexpr std::size_t step = 16 / sizeof(T);
+    const __m128i needle = sizeof(T) == 2 ? _mm_set1_epi16(static_cast<short>(unit))
+                                          : _mm_set1_epi32(static_cast<int>(unit));
+    for (std::size_t i = 0; i + step <= count; i += step) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        const __m128i equal = sizeof(T) == 2 ? _mm_cmpeq_epi16(block, needle) : _mm_cmpeq_epi32(block, needle);
+        if (const auto mask = static_cast<unsigned>(_mm_movemask_epi8(equal)); mask != 0) {
+            return i + std::countr_zero(mask) / sizeof(T);
+        }
+    }
+    return count - count % step;
+}
+
+/** Find a 16-bit or 32-bit code unit, 32 bytes at a time (AVX2 kernel), see findUnitSSE42(). **/
+template<typename T>
+[[gnu::target("avx2")]] inline std::size_t findUnitAVX2(const T* s, std::size_t count, T unit)
+{
+    constexpr std::size_t step = 32 / sizeof(T);
+    const __m256i needle = sizeof(T) == 2 ? _mm256_set1_epi16(static_cast<short>(unit))
+                                          : _mm256_set1_epi32(static_cast<int>(unit));
+    for (std::size_t i = 0; i + step <= count; i += step) {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        const __m256i equal =
+            sizeof(T) == 2 ? _mm256_cmpeq_epi16(block, needle) : _mm256_cmpeq_epi32(block, needle);
+        if (const auto mask = static_cast<unsigned>(_mm256_movemask_epi8(equal)); mask != 0) {
+            return i + std::countr_zero(mask) / sizeof(T);
+        }
+    }
+    return count - count % step;
+}
+
+/** Find a 16-bit or 32-bit code unit, 64 bytes at a time (AVX-512 kernel), see findUnitSSE42(). **/
+template<typename T>
+[[gnu::target("avx512f,avx512bw,avx512vl")]] inline std::size_t findUnitAVX512(const T* s,
+                                                                              std::size_t count,
+                                                                              T unit)
+{
+    constexpr std::size_t step = 64 / sizeof(T);
+    for (std::size_t i = 0; i + step <= count; i += step) {
+        const __m512i block = _mm512_loadu_si512(s + i);
+        const std::uint64_t mask =
+            sizeof(T) == 2 ? _mm512_cmpeq_epi16_mask(block, _mm512_set1_epi16(static_cast<short>(unit)))
+                           : _mm512_cmpeq_epi32_mask(block, _mm512_set1_epi32(static_cast<int>(unit)));
+        if (mask != 0) {
+            return i + std::countr_zero(mask);
+        }
+    }
+    return count - count % step;
+}
+#endif
+
+#if defined(IEEE754TOY_NEON_KERNELS)
+/** Find a 16-bit or 32-bit code unit in a block of 16 bytes (NEON kernel), see findUnitSSE42(). **/
+template<typename T>
+inline std::size_t findUnitNEON(const T* s, std::size_t count, T unit)
+{
+    constexpr std::size_t step = 16 / sizeof(T);
+    for (std::size_t i = 0; i + step <= count; i += step) {
+        // Narrow the comparison result to one byte (16-bit units) or two bytes (32-bit units) per unit
+        std::uint64_t mask;
+        if constexpr (sizeof(T) == 2) {
+            const uint16x8_t block = vld1q_u16(reinterpret_cast<const std::uint16_t*>(s + i));
+            mask = vget_lane_u64(vreinterpret_u64_u8(vmovn_u16(vceqq_u16(block, vdupq_n_u16(unit)))), 0);
+        } else {
+            const uint32x4_t block = vld1q_u32(reinterpret_cast<const std::uint32_t*>(s + i));
+            mask = vget_lane_u64(vreinterpret_u64_u16(vmovn_u32(vceqq_u32(block, vdupq_n_u32(unit)))), 0);
+        }
+        if (mask != 0) {
+            return i + std::countr_zero(mask) / (4 * sizeof(T));
+        }
+    }
+    return count - count % step;
+}
+#endif
+
+/**
+ * Find a 16-bit or 32-bit code unit (eg. a delimiter).
+ * @comment Level The SIMD level of the kernel (see CpuDispatch.h)
+ * @param s The code units
+ * @param count The number of code units
+ * @param unit The code unit to be found
+ * @return The index of the first occurrence of unit, or count if none
+ **/
+template<SimdLevel Level = compiledSimdLevel, typename T>
+inline std::size_t findUnit(const T* s, const std::size_t count, const T unit)
+{
+    static_assert(sizeof(T) == 2 || sizeof(T) == 4);
+
+    // Whole blocks, then the remaining units one by one
+    std::size_t i = 0;
+#if defined(IEEE754TOY_X86_KERNELS)
+    if constexpr (Level == SimdLevel::AVX512) {
+        i = findUnitAVX512(s, count, unit);
+    } else if constexpr (Level == SimdLevel::AVX2) {
+        i = findUnitAVX2(s, count, unit);
+    } else if constexpr (Level == SimdLevel::SSE42) {
+        i = findUnitSSE42(s, count, unit);
+    }
+#elif defined(IEEE754TOY_NEON_KERNELS)
+    if constexpr (Level == SimdLevel::NEON) {
+        i = findUnitNEON(s, count, unit);
+    }
+#endif
+    while (i < count && s[i] != unit) {
+        i++;
+    }
+    return i;
+}
+
+#if defined(IEEE754TOY_X86_KERNELS)
+/** Count the occurrences of a code unit in blocks of 16 bytes (SSE4.2 kernel), up to the last whole block. **/
+template<typename T>
+[[gnu::target("sse4.2")]] inline std::size_t countUnitSSE42(const T* s, std::size_t count, T unit)
+{
+    constexpr std::size_t step = 16 / sizeof(T);
+    const __m128i needle = sizeof(T) == 1   ? _mm_set1_epi8(static_cast<char>(unit))
+                           : sizeof(T) == 2 ? _mm_set1_epi16(static_cast<short>(unit))
+                                            : _mm_set1_epi32(static_cast<int>(unit));
+    std::size_t found = 0;
+    for (std::size_t i = 0; i + step <= count; i += step) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        const __m128i equal = sizeof(T) == 1   ? _mm_cmpeq_epi8(block, needle)
+                              : sizeof(T) == 2 ? _mm_cmpeq_epi16(block, needle)
+                                               : _mm_cmpeq_epi32(block, needle);
+        found += std::popcount(static_cast<unsigned>(_mm_movemask_epi8(equal)));
+    }
+    return found / sizeof(T);
+}
+
+/** Count the occurrences of a code unit, 32 bytes at a time (AVX2 kernel), see countUnitSSE42(). **/
+template<typename T>
+[[gnu::target("avx2")]] inline std::size_t countUnitAVX2(const T* s, std::size_t count, T unit)
+{
+    constexpr std::size_t step = 32 / sizeof(T);
+    const __m256i needle = sizeof(T) == 1   ? _mm256_set1_epi8(static_cast<char>(unit))
+                           : sizeof(T) == 2 ? _mm256_set1_epi16(static_cast<short>(unit))
+                                            : _mm256_set1_epi32(static_cast<int>(unit));
+    std::size_t found = 0;
+    for (std::size_t i = 0; i + step <= count; i += step) {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        const __m256i equal = sizeof(T) == 1   ? _mm256_cmpeq_epi8(block, needle)
+                              : sizeof(T) == 2 ? _mm256_cmpeq_epi16(block, needle)
+                                               : _mm256_cmpeq_epi32(block, needle);
+        found += std::popcount(static_cast<unsigned>(_mm256_movemask_epi8(equal)));
+    }
+    return found / sizeof(T);
+}
+
+/** Count the occurrences of a code unit, 64 bytes at a time (AVX-512 kernel), see countUnitSSE42(). **/
+template<typename T>
+[[gnu::target("avx512f,avx512bw,avx512vl")]] inline std::size_t countUnitAVX512(const T* s,
+                                                                               std::size_t count,
+                                                                               T unit)
+{
+    constexpr std::size_t step = 64 / sizeof(T);
+    std::size_t found = 0;
+    for (std::size_t i = 0; i + step <= count; i += step) {
+        const __m512i block = _mm512_loadu_si512(s + i);
+        const std::uint64_t mask =
+            sizeof(T) == 1   ? _mm512_cmpeq_epi8_mask(block, _mm512_set1_epi8(static_cast<char>(unit)))
+            : sizeof(T) == 2 ? _mm512_cmpeq_epi16_mask(block, _mm512_set1_epi16(static_cast<short>(unit)))
+                             : _mm512_cmpeq_epi32_mask(block, _mm512_set1_epi32(static_cast<int>(unit)));
+        found += std::popcount(mask);
+    }
+    return found;
+}
+#endif
+
+#if defined(IEEE754TOY_NEON_KERNELS)
+/** Count the occurrences of an 8-bit code unit in blocks of 16 bytes (NEON kernel), see countUnitSSE42(). **/
+inline std::size_t countUnitNEON(const char* s, std::size_t count, char unit)
+{
+    std::size_t found = 0;
+    for (std::size_t i = 0; i + 16 <= count; i += 16) {
+        const uint8x16_t block = vld1q_u8(reinterpret_cast<const std::uint8_t*>(s + i));
+        found += vaddvq_u8(vandq_u8(vceqq_u8(block, vdupq_n_u8(static_cast<std::uint8_t>(unit))), vdupq_n_u8(1)));
+    }
+    return found;
+}
+#endif
+
+/**
+ * Count the occurrences of a code unit (eg. a delimiter).
+ * @comment Level The SIMD level of the kernel (see CpuDispatch.h)
+ * @param s The code units
+ * @param count The number of code units
+ * @param unit The code unit to be counted
+ * @return The number of occurrences of unit
+ **/
+template<SimdLevel Level = compiledSimdLevel, typename T>
+inline std::size_t countUnit(const T* s, const std::size_t count, const T unit)
+{
+    static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4);
+
+    // Whole blocks, then the remaining units one by one
+    std::size_t found = 0;
+    std::size_t i = 0;
+#if defined(IEEE754TOY_X86_KERNELS)
+    if constexpr (Level == SimdLevel::AVX512) {
+        found = countUnitAVX512(s, count, unit);
+        i = count - count % (64 / sizeof(T));
+    } else if constexpr (Level == SimdLevel::AVX2) {
+        found = countUnitAVX2(s, count, unit);
+        i = count - count % (32 / sizeof(T));
+    } else if constexpr (Level == SimdLevel::SSE42) {
+        found = countUnitSSE42(s, count, unit);
+        i = count - count % (16 / sizeof(T));
+    }
+#elif defined(IEEE754TOY_NEON_KERNELS)
+    if constexpr (Level == SimdLevel::NEON && sizeof(T) == 1) {
+        found = countUnitNEON(reinterpret_cast<const char*>(s), count, static_cast<char>(unit));
+        i = count - count % 16;
+    }
+#endif
+    for (; i < count; i++) {
+        found += s[i] == unit ? 1 : 0;
+    }
+    return found;
+}
+
+}; // namespace ieee754toy
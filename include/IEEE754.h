@@ -13,13 +13,25 @@
  * <https://babbage.cs.qc.cuny.edu/IEEE-754/>
  */
 
+#include "BigInteger.h"
+#include "Instrumentation.h"
+#include "PowersOfTen.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cassert>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <tuple>
 #include <type_traits>
 
+#if defined(__STDCPP_BFLOAT16_T__) && __has_include(<stdfloat>)
+#include <stdfloat>
+#endif
+
 namespace ieee754toy {
 
 /**
@@ -30,12 +42,25 @@ namespace ieee754toy {
  * The integral number if a bitfield (platform-endianness) with the following layout:
  *   [sign][exponentBits][mantissaBits]
  *   The sign is always 1 bit.
- * @comment Mantissa Integral type used to represent the mantissa in either two or ten exponent base.
+ * @comment Mantissa Integral type used to represent the mantissa in either two or ten exponent base. Types
+ * narrower than double precision still accumulate decimal digits in a 64-bit mantissa (19 digits), as for double
+ * precision: the parser truncation is then very unlikely to make the rounding ambiguous.
  * @comment Exponent Integral type used to represent the exponent in either two or ten exponent base.
  * @comment ReducedMantissa Integral type used to handle the mantissa when converting exponent base, without losing
  * precision.
+ * @comment ExactType Floating-point type used by the exact fast path: either Type, or a wider type whose result is
+ * then rounded to Type
  * @comment mantissaBits Number of bits for mantissa in IEE754
  * @comment exponentBits Number of bits for exponent in IEE754
+ * @comment minPowerOfTen Smallest power of ten with which a (64-bit, or Mantissa if wider) mantissa may still not
+ * round to zero
+ * @comment maxPowerOfTen Largest power of ten with which a non-zero mantissa may still not overflow to infinity
+ * @comment minRoundToEvenPowerOfTen Smallest power of ten with which a mantissa can be exactly half-way between
+ * two floating-point numbers
+ * @comment maxRoundToEvenPowerOfTen Largest power of ten with which a mantissa can be exactly half-way between
+ * two floating-point numbers
+ * @comment maxExactPowerOfTen Largest power of ten exactly representable as a floating-point number
+ * @comment arithmetic If @c true, Type has correctly rounded floating-point operations (possibly emulated)
  **/
 template<typename T>
 struct IEEE754Traits;
@@ -47,13 +72,26 @@ struct IEEE754Traits<float>
     using Type = float;
     using IntegerType = std::uint32_t;
 
-    using Mantissa = std::uint32_t;
+    // A 64-bit decimal mantissa (see IEEE754Traits): the table-driven conversion only needs a 64-bit by 64-bit
+    // multiplication
+    using Mantissa = std::uint64_t;
     using Exponent = std::int16_t;
 
-    using ReducedMantissa = std::uint64_t;
+    using ReducedMantissa = __uint128_t;
+
+    // The exact fast path is computed in double precision, then rounded to single precision (see toFloatExact())
+    using ExactType = double;
 
     static constexpr std::size_t mantissaBits = 23;
     static constexpr std::size_t exponentBits = 8;
+
+    static constexpr int minPowerOfTen = -65;
+    static constexpr int maxPowerOfTen = 38;
+    static constexpr int minRoundToEvenPowerOfTen = -17;
+    static constexpr int maxRoundToEvenPowerOfTen = 10;
+    static constexpr int maxExactPowerOfTen = 10;
+
+    static constexpr bool arithmetic = true;
 };
 
 /** IEEE754 Double precision (aka "double") **/
@@ -67,10 +105,129 @@ struct IEEE754Traits<double>
     using Exponent = std::int32_t;
 
     using ReducedMantissa = __uint128_t;
+    using ExactType = double;
 
     static constexpr std::size_t mantissaBits = 52;
     static constexpr std::size_t exponentBits = 11;
+
+    static constexpr int minPowerOfTen = -342;
+    static constexpr int maxPowerOfTen = 308;
+    static constexpr int minRoundToEvenPowerOfTen = -4;
+    static constexpr int maxRoundToEvenPowerOfTen = 23;
+    static constexpr int maxExactPowerOfTen = 22;
+
+    static constexpr bool arithmetic = true;
+};
+
+#ifdef __FLT16_MANT_DIG__
+/** IEEE754 Half precision (aka. "binary16", "_Float16", "std::float16_t") **/
+template<>
+struct IEEE754Traits<_Float16>
+{
+    using Type = _Float16;
+    using IntegerType = std::uint16_t;
+
+    // A 64-bit decimal mantissa (see IEEE754Traits)
+    using Mantissa = std::uint64_t;
+    using Exponent = std::int16_t;
+
+    using ReducedMantissa = __uint128_t;
+    using ExactType = _Float16;
+
+    static constexpr std::size_t mantissaBits = 10;
+    static constexpr std::size_t exponentBits = 5;
+
+    static constexpr int minPowerOfTen = -27;
+    static constexpr int maxPowerOfTen = 4;
+    static constexpr int minRoundToEvenPowerOfTen = -22;
+    static constexpr int maxRoundToEvenPowerOfTen = 5;
+    static constexpr int maxExactPowerOfTen = 4;
+
+    // Operations may be emulated in single precision: the double rounding is innocuous (24 >= 2 * 11 + 2)
+    static constexpr bool arithmetic = true;
 };
+#endif
+
+/**
+ * Brain floating-point storage type (aka. "bfloat16"): the 16 leading bits of a single precision number.
+ * Used when the compiler has no std::bfloat16_t.
+ **/
+struct BFloat16
+{
+    /** The IEEE754 integer value **/
+    std::uint16_t bits;
+
+    /** Widen to single precision (exact). **/
+    constexpr explicit operator float() const { return std::bit_cast<float>(std::uint32_t{ bits } << 16); }
+
+    constexpr bool operator==(const BFloat16&) const = default;
+};
+
+/** Brain floating-point format (aka. "bfloat16") **/
+template<typename T>
+struct IEEE754BFloat16Traits
+{
+    using Type = T;
+    using IntegerType = std::uint16_t;
+
+    // A 64-bit decimal mantissa (see IEEE754Traits)
+    using Mantissa = std::uint64_t;
+    using Exponent = std::int16_t;
+
+    using ReducedMantissa = __uint128_t;
+    using ExactType = T;
+
+    static constexpr std::size_t mantissaBits = 7;
+    static constexpr std::size_t exponentBits = 8;
+
+    static constexpr int minPowerOfTen = -60;
+    static constexpr int maxPowerOfTen = 38;
+    static constexpr int minRoundToEvenPowerOfTen = -24;
+    static constexpr int maxRoundToEvenPowerOfTen = 3;
+    static constexpr int maxExactPowerOfTen = 3;
+
+    static constexpr bool arithmetic = std::is_floating_point_v<T>;
+};
+
+template<>
+struct IEEE754Traits<BFloat16> : IEEE754BFloat16Traits<BFloat16>
+{};
+
+#ifdef __STDCPP_BFLOAT16_T__
+template<>
+struct IEEE754Traits<std::bfloat16_t> : IEEE754BFloat16Traits<std::bfloat16_t>
+{};
+#endif
+
+#ifdef __SIZEOF_FLOAT128__
+/**
+ * IEEE754 Quadruple precision (aka. "binary128", "__float128").
+ * There is no wider native integer type for the reduced mantissa: conversions use big integers.
+ **/
+template<>
+struct IEEE754Traits<__float128>
+{
+    using Type = __float128;
+    using IntegerType = __uint128_t;
+
+    using Mantissa = __uint128_t;
+    using Exponent = std::int32_t;
+
+    using ReducedMantissa = __uint128_t;
+    using ExactType = __float128;
+
+    static constexpr std::size_t mantissaBits = 112;
+    static constexpr std::size_t exponentBits = 15;
+
+    static constexpr int minPowerOfTen = -5005;
+    static constexpr int maxPowerOfTen = 4932;
+    static constexpr int minRoundToEvenPowerOfTen = -6;
+    static constexpr int maxRoundToEvenPowerOfTen = 49;
+    static constexpr int maxExactPowerOfTen = 48;
+
+    static constexpr bool arithmetic = true;
+};
+#endif
 
 /** An IEEE754 binary (2-based) representation. **/
 template<typename N>
@@ -97,7 +254,8 @@ struct IEEE754BinaryNumber
     static constexpr Exponent exponentSubnormalBase = 1 - exponentBase;
 
     /** Minimum overall subnormal exponent (ie. when least significant bit is the only one set) **/
-    static constexpr Exponent exponentSubnormalMin = exponentSubnormalBase - Base::mantissaBits;
+    static constexpr Exponent exponentSubnormalMin =
+        exponentSubnormalBase - static_cast<Exponent>(Base::mantissaBits);
 
     /**
      * Return the packed IEEE754 number, as the integer representation.
@@ -167,10 +325,43 @@ struct IEEE754Number
     using Exponent = typename Traits::Exponent;
     using Integer = typename Traits::IntegerType;
     using ReducedMantissa = typename Traits::ReducedMantissa;
+    using ExactTraits = IEEE754Traits<typename Traits::ExactType>;
 
     /** Number of bits of precision for internal computation on the mantissa. **/
     static constexpr Exponent reducedMantissaBits = sizeof(ReducedMantissa) * 8;
 
+    /**
+     * Is the table-driven conversion available ? We need the mantissa, plus the (encoded) leading bit and two
+     * rounding bits, to fit in the 64-bit high part of the product.
+     **/
+    static constexpr bool tableConversion =
+        Traits::mantissaBits + 3 < 64 && sizeof(Mantissa) <= sizeof(std::uint64_t);
+
+    /**
+     * Is the big integer conversion needed ? When the reduced mantissa is not wider than the mantissa, the
+     * iterative method would lose precision.
+     **/
+    static constexpr bool bigConversion = sizeof(ReducedMantissa) <= sizeof(Mantissa);
+
+    /**
+     * Number of significant digits deciding the rounding of any decimal number: the half-way points between two
+     * consecutive numbers, (2 · mantissa + 1) · 2^(exponent - 1), have less significant digits (1234/4096 and
+     * 2864/4096 being upper bounds of log10(2) and log10(5)), and the following digits only matter if they are not
+     * all zero.
+     **/
+    static constexpr std::size_t maxDigits =
+        ((Traits::mantissaBits + 2) * 1234 >> 12) +
+        ((1 - static_cast<std::size_t>(IEEE754BinaryNumber<N>::exponentSubnormalMin)) * 2864 >> 12) + 2;
+
+    /**
+     * Big integer wide enough for maxDigits digits, and for the half-way comparisons of roundDigits(): a half-way
+     * point multiplied by 5^-tenexponent, the ten-exponent being bounded by the number of digits and the smallest
+     * power of ten (9511/4096 being an upper bound of log2(5)).
+     **/
+    static constexpr std::size_t digitsBits =
+        Traits::mantissaBits + 3 + ((maxDigits + static_cast<std::size_t>(-Traits::minPowerOfTen)) * 9511 >> 12);
+    using DigitsInteger = BigInteger<digitsBits / 64 + 2>;
+
     /**
      * Create a new IEE754 number.
      * @param n Negative sign
@@ -193,6 +384,158 @@ struct IEEE754Number
      */
     constexpr ieee754toy::IEEE754Number<N, 2> convertTwobase() const;
 
+    /**
+     * Convert the current number to base-2, the mantissa being possibly rounded by the parser: when the mantissa
+     * is about to overflow, the parser stops accumulating digits, and rounds the mantissa using the next digit.
+     * The real value is then strictly between (mantissa - 1) and (mantissa + 1), and the conversion is only
+     * correct if both bounds convert to the same number.
+     * @return A tuple of @c true if the converted number is correctly rounded whatever the digits rounded away,
+     * and the converted number. Failure is only reported close to half-way points (see roundDigits()).
+     * @warning The only supported converion currently is from base 10 to base 2.
+     */
+    constexpr std::tuple<bool, ieee754toy::IEEE754Number<N, 2>> convertTwobaseBounded() const;
+
+    /**
+     * Convert the current number to base-2, using the table-driven (Eisel-Lemire) method: the mantissa is
+     * multiplied once by a normalized 128-bit power of ten, and the rounding is decided on the product.
+     * @return A tuple of @c true upon success, and the converted number. Failure is only reported for the (very
+     * rare) ambiguous cases where the truncated power of ten can not decide the rounding.
+     * @warning The only supported converion currently is from base 10 to base 2.
+     *
+     * @comment <https://arxiv.org/abs/2101.11408>
+     */
+    constexpr std::tuple<bool, ieee754toy::IEEE754Number<N, 2>> convertTwobaseTable() const;
+
+    /**
+     * Is the exact fast path available for this number ? This is the case when both the mantissa and the power of
+     * ten are exactly representable as floating-point numbers (of the exact fast path type, see ExactTraits): a
+     * single multiplication (or division) is then correctly rounded.
+     * @comment <https://www.cesura17.net/~will/professional/research/papers/howtoread.pdf> (William D. Clinger)
+     **/
+    constexpr bool exactConversion() const
+    {
+        return mantissa <= (Mantissa{ 1 } << (ExactTraits::mantissaBits + 1)) &&
+               exponent >= -ExactTraits::maxExactPowerOfTen && exponent <= ExactTraits::maxExactPowerOfTen;
+    }
+
+    /**
+     * Convert the current number to base-2, using the exact fast path with integer arithmetic (constexpr-safe
+     * variant of toFloatExact()).
+     * @warning Only available when exactConversion() is @c true.
+     */
+    constexpr ieee754toy::IEEE754Number<N, 2> convertTwobaseExact() const;
+
+    /**
+     * Convert the current number to a floating-point representation, using the exact fast path: one
+     * floating-point multiplication or division by an exactly representable power of ten. When the exact fast
+     * path type is wider (eg. double precision for single precision numbers), its result is rounded once more,
+     * unless it lies exactly half-way between two numbers, where a double rounding could be wrong.
+     * @warning Only available when exactConversion() is @c true.
+     */
+    inline N toFloatExact() const;
+
+    /**
+     * Convert the current number to base-2, using the iterative method (slow, but always available).
+     * @warning The only supported converion currently is from base 10 to base 2.
+     */
+    constexpr ieee754toy::IEEE754Number<N, 2> convertTwobaseIterative() const;
+
+    /**
+     * Convert the current number to base-2, using exact big integer arithmetic: the mantissa is multiplied by
+     * 5^exponent, or shifted and divided by 5^-exponent, and the result is rounded once.
+     * @warning The only supported converion currently is from base 10 to base 2.
+     */
+    constexpr ieee754toy::IEEE754Number<N, 2> convertTwobaseBig() const;
+
+    /**
+     * Convert the current number to base-2, using exact big integer arithmetic, with enough limbs for powers of
+     * ten up to maxPowerOfTen (in absolute value).
+     */
+    template<int maxPowerOfTen>
+    constexpr ieee754toy::IEEE754Number<N, 2> convertTwobaseBig() const;
+
+    /**
+     * Round a decimal number of any length, v = digits · 10^tenexponent, knowing that it rounds either to
+     * candidate or to the following number: v is compared with the half-way point between both, using big
+     * integers (no allocation, the integers being bounded by maxDigits).
+     * @param candidate The lower possible rounding (eg. the rounding of a lower bound of v)
+     * @param digits The significant digits, at most maxDigits of them (see DigitsInteger)
+     * @param tenexponent The ten-exponent of the least significant digit
+     * @param truncated If @c true, non-zero digits were dropped after digits (v is then slightly above)
+     * @return The base-2 number, rounded half to even.
+     * @warning The only supported converion currently is from base 10 to base 2.
+     **/
+    template<std::size_t Limbs>
+    static constexpr ieee754toy::IEEE754Number<N, 2> roundDigits(const ieee754toy::IEEE754Number<N, 2>& candidate,
+                                                                 const BigInteger<Limbs>& digits,
+                                                                 Exponent tenexponent,
+                                                                 bool truncated);
+
+    /**
+     * Compare a decimal number of any length, digits · 10^tenexponent, with binary · 2^twoexponent, using big
+     * integers (no allocation, the integers being bounded by maxDigits).
+     * @param digits The significant digits, at most maxDigits of them (see DigitsInteger)
+     * @param tenexponent The ten-exponent of the least significant digit, at least minPowerOfTen - maxDigits
+     * @param binary The binary mantissa
+     * @param twoexponent The two-exponent of the binary mantissa
+     * @return A negative value if the decimal number is lower, zero if they are equal, and a positive value
+     * otherwise.
+     * @warning Unless one of them is much larger, both numbers are expected to be close to the same normal or
+     * subnormal number (a half-way point, or the number itself).
+     **/
+    template<std::size_t Limbs>
+    static constexpr int compareDigits(const BigInteger<Limbs>& digits,
+                                       Exponent tenexponent,
+                                       Mantissa binary,
+                                       Exponent twoexponent);
+
+    /** The compareDigits() comparison, using big integers of the given width. **/
+    template<typename Big, std::size_t Limbs>
+    static constexpr int compareDigits(const BigInteger<Limbs>& digits,
+                                       Exponent tenexponent,
+                                       Mantissa binary,
+                                       Exponent twoexponent);
+
+    /**
+     * Is the current number exactly equal to its conversion to base 2, ie. is the conversion exact ?
+     * @param bits The IEEE754 integer value of the (correctly rounded) converted number
+     * @warning The mantissa must hold all the significant digits, ie. must not have been rounded by the parser
+     * (see exactDigits() otherwise).
+     **/
+    constexpr bool exactlyConverted(Integer bits) const;
+
+    /**
+     * Is a decimal number of any length, v = digits · 10^tenexponent, exactly equal to its conversion to base 2 ?
+     * @param bits The IEEE754 integer value of the (correctly rounded) converted number
+     * @param digits The significant digits, at most maxDigits of them (see roundDigits())
+     * @param tenexponent The ten-exponent of the least significant digit
+     * @param truncated If @c true, non-zero digits were dropped after digits
+     **/
+    template<std::size_t Limbs>
+    static constexpr bool exactDigits(Integer bits,
+                                      const BigInteger<Limbs>& digits,
+                                      Exponent tenexponent,
+                                      bool truncated);
+
+    /**
+     * Split a floating-point number into v = odd · 2^twoexponent, odd being odd.
+     * @param bits The IEEE754 integer value
+     * @return A tuple of the odd mantissa (zero for zero, infinity and NaN), and the two-exponent.
+     **/
+    static constexpr std::tuple<Mantissa, Exponent> oddMantissa(Integer bits);
+
+    /**
+     * Normalize a two-exponent number into a base-2 number, using a single shift.
+     * @param negative If @c true, the number is negative
+     * @param varmantissa The mantissa, of any width
+     * @param twoexponent The two-exponent, such that v = varmantissa · 2^twoexponent
+     * @return The base-2 number, with the leading mantissa bit on the (mantissaBits + 1)-th position (unless the
+     * number is subnormal), the dropped bits being rounded half to even.
+     **/
+    static constexpr ieee754toy::IEEE754Number<N, 2> normalize(bool negative,
+                                                               ReducedMantissa varmantissa,
+                                                               Exponent twoexponent);
+
     /**
      * Augment the ten-exponent using factor of tenFactor (10**tenFactor), reducing two-exponent by a factor of
      * twoexponent (2**twoexponent)
@@ -306,6 +649,72 @@ inline constexpr T power(const T& t, std::size_t exp)
 }
 static_assert(power(2, 4) == 16);
 
+/*
+ * Return the number of bits needed to represent a number (zero for zero).
+ */
+template<typename Integer>
+inline constexpr std::size_t bitWidth(const Integer& number)
+{
+    if constexpr (sizeof(Integer) > sizeof(std::uint64_t)) {
+        static_assert(sizeof(Integer) == 2 * sizeof(std::uint64_t));
+        const auto high = static_cast<std::uint64_t>(number >> 64);
+        return high != 0 ? 64 + std::bit_width(high) : std::bit_width(static_cast<std::uint64_t>(number));
+    } else {
+        return std::bit_width(static_cast<std::uint64_t>(number));
+    }
+}
+static_assert(bitWidth(0U) == 0);
+static_assert(bitWidth(5U) == 3);
+static_assert(bitWidth(__uint128_t{ 1 } << 100) == 101);
+
+/*
+ * Return the number of trailing zero bits of a non-zero number.
+ */
+template<typename Integer>
+inline constexpr std::size_t trailingZeros(const Integer& number)
+{
+    if constexpr (sizeof(Integer) > sizeof(std::uint64_t)) {
+        static_assert(sizeof(Integer) == 2 * sizeof(std::uint64_t));
+        const auto low = static_cast<std::uint64_t>(number);
+        return low != 0 ? std::countr_zero(low) : 64 + std::countr_zero(static_cast<std::uint64_t>(number >> 64));
+    } else {
+        return std::countr_zero(static_cast<std::uint64_t>(number));
+    }
+}
+static_assert(trailingZeros(8U) == 3);
+static_assert(trailingZeros(__uint128_t{ 1 } << 100) == 100);
+
+/*
+ * Shift right, rounding half to even using all the dropped bits (the leading dropped bit being the rounding bit,
+ * and the other ones the sticky bits).
+ */
+template<typename Integer>
+inline constexpr Integer shiftRightRounded(const Integer& number, std::size_t shift)
+{
+    constexpr std::size_t bits = sizeof(Integer) * 8;
+    if (shift == 0) {
+        return number;
+    } else if (shift > bits) {
+        return 0;
+    }
+
+    const Integer half = Integer{ 1 } << (shift - 1);
+    const Integer dropped = number & (half + (half - 1));
+    Integer result = shift < bits ? number >> shift : 0;
+
+    // Above half-way, or half-way and odd: round to upper value
+    if (dropped > half || (dropped == half && (result & 1) != 0)) {
+        result++;
+    }
+    return result;
+}
+static_assert(shiftRightRounded(0b1011U, 2) == 0b11);
+static_assert(shiftRightRounded(0b1010U, 2) == 0b10);
+static_assert(shiftRightRounded(0b1110U, 2) == 0b100);
+static_assert(shiftRightRounded(0b1001U, 2) == 0b10);
+static_assert(shiftRightRounded(0b1000U, 4) == 0);
+static_assert(shiftRightRounded(0b1001U, 4) == 1);
+
 template<typename N, std::size_t Base>
 template<typename ieee754toy::IEEE754Number<N, Base>::Exponent tenFactor,
          typename ieee754toy::IEEE754Number<N, Base>::Exponent twoFactor>
@@ -339,6 +748,7 @@ constexpr void ieee754toy::IEEE754Number<N, Base>::decreaseTenExponent(ReducedMa
 
         // Divide by decreasing ten-exponent
         tenexponent -= tenFactor;
+        instrumentIterations(1);
 
         // Multiply through varmantissa
         varmantissa *= tenMultiplier;
@@ -379,6 +789,7 @@ constexpr void ieee754toy::IEEE754Number<N, Base>::increaseTenExponent(ReducedMa
 
         // Multiply by increasing ten-exponent
         tenexponent += tenFactor;
+        instrumentIterations(1);
 
         // Divide through varmantissa
         divideBy(varmantissa, tenMultiplier);
@@ -391,11 +802,262 @@ inline constexpr ieee754toy::IEEE754Number<N, 2> ieee754toy::IEEE754Number<N, Ba
     if constexpr (Base == 2) {
         return *this;
     } else if constexpr (Base == 10) {
-        using Number = ieee754toy::IEEE754Number<N, Base>;
-        using BinaryNumber = ieee754toy::IEEE754BinaryNumber<N>;
+        // No wide enough integral type for the iterative method
+        if constexpr (bigConversion) {
+            const auto binary = convertTwobaseBig();
+            instrumentConversion(ConversionPath::Table);
+            return binary;
+        }
+
+        // Fast table-driven conversion first, iterative method for the rare ambiguous cases
+        const auto [converted, number] = convertTwobaseBounded();
+        const auto binary = converted ? number : convertTwobaseIterative();
+        instrumentConversion(converted ? ConversionPath::Table : ConversionPath::Iterative);
+        return binary;
+    }
+}
+
+template<typename N, std::size_t Base>
+constexpr std::tuple<bool, ieee754toy::IEEE754Number<N, 2>>
+ieee754toy::IEEE754Number<N, Base>::convertTwobaseBounded() const
+{
+    static_assert(Base == 10);
+
+    using Number = ieee754toy::IEEE754Number<N, Base>;
+    using TwoBaseNumber = ieee754toy::IEEE754Number<N, 2>;
+
+    // Exact conversion of a mantissa, unless ambiguous
+    const auto convert = [](const Number& number) -> std::tuple<bool, TwoBaseNumber> {
+        if constexpr (bigConversion) {
+            return { true, number.convertTwobaseBig() };
+        } else if constexpr (tableConversion) {
+            return number.convertTwobaseTable();
+        } else {
+            return { false, TwoBaseNumber(number.negative, 0, 0) };
+        }
+    };
+
+    const auto [converted, number] = convert(*this);
+    if (not converted) {
+        return { false, number };
+    }
+
+    // The mantissa can not have been rounded
+    if (mantissa < std::numeric_limits<Mantissa>::max() / 10) {
+        return { true, number };
+    }
+
+    // If both bounds do not convert to the same number, the rounding is ambiguous
+    if (mantissa != std::numeric_limits<Mantissa>::max()) {
+        const auto [lowerConverted, lower] = convert(Number(negative, mantissa - 1, exponent));
+        const auto [upperConverted, upper] = convert(Number(negative, mantissa + 1, exponent));
+        if (lowerConverted && upperConverted && lower.mantissa == upper.mantissa &&
+            lower.exponent == upper.exponent) {
+            return { true, number };
+        }
+    }
+    return { false, number };
+}
+
+template<typename N, std::size_t Base>
+constexpr std::tuple<bool, ieee754toy::IEEE754Number<N, 2>>
+ieee754toy::IEEE754Number<N, Base>::convertTwobaseTable() const
+{
+    static_assert(Base == 10);
+    static_assert(tableConversion);
+    static_assert(Traits::minPowerOfTen >= PowersOfTen::smallestPowerOfTen);
+    static_assert(Traits::maxPowerOfTen <= PowersOfTen::largestPowerOfTen);
+
+    using BinaryNumber = ieee754toy::IEEE754BinaryNumber<N>;
+    using TwoBaseNumber = ieee754toy::IEEE754Number<N, 2>;
+
+    constexpr std::size_t mantissaBits = Traits::mantissaBits;
+
+    // Biased exponent for infinity
+    constexpr int infinityExponent = (1 << Traits::exponentBits) - 1;
+
+    const std::uint64_t w = mantissa;
+    const int q = exponent;
 
-        constexpr std::size_t mantissaBits = Number::Traits::mantissaBits;
+    // Zero is zero, and very small numbers too
+    if (w == 0 || q < Traits::minPowerOfTen) {
+        return { true, TwoBaseNumber(negative, 0, 0) };
+    }
+
+    // Very large numbers overflow
+    if (q > Traits::maxPowerOfTen) {
+        return { true, TwoBaseNumber(negative, Mantissa{ 1 } << mantissaBits, BinaryNumber::exponentMax + 1) };
+    }
+
+    // Normalize the mantissa so that the leading bit is the 64th bit
+    const int leadingZeros = std::countl_zero(w);
+    const std::uint64_t normalized = w << leadingZeros;
+
+    // Multiply with the 64 leading bits of the normalized power of ten: we need mantissaBits + 3 exact bits
+    // (leading bit, mantissa, rounding bit, and one possible extra leading bit)
+    const auto& power = PowersOfTen::get(q);
+    const __uint128_t firstProduct = __uint128_t{ normalized } * power.high;
+    auto high = static_cast<std::uint64_t>(firstProduct >> 64);
+    auto low = static_cast<std::uint64_t>(firstProduct);
+
+    // Correction step: if the lower bits of the high part are all ones, adding the contribution of the 64 trailing
+    // bits of the power of ten may carry into our precision window
+    constexpr std::uint64_t precisionMask = ~std::uint64_t{ 0 } >> (mantissaBits + 3);
+    if ((high & precisionMask) == precisionMask) {
+        const __uint128_t secondProduct = __uint128_t{ normalized } * power.low;
+        const auto secondHigh = static_cast<std::uint64_t>(secondProduct >> 64);
+        low += secondHigh;
+        if (secondHigh > low) {
+            high++;
+        }
+    }
+
+    // Still ambiguous: the truncated power of ten is not precise enough to decide, unless the power is exact
+    // (5**q < 2**128 for positive powers), or its 128-bit reciprocal is (5**-q < 2**64 for negative powers)
+    if (low == ~std::uint64_t{ 0 } && (q < -27 || q > 55)) {
+        return { false, TwoBaseNumber(negative, 0, 0) };
+    }
+
+    // Keep mantissaBits + 2 bits (leading bit and rounding bit)
+    const int upperBit = static_cast<int>(high >> 63);
+    const int shift = upperBit + 64 - static_cast<int>(mantissaBits) - 3;
+    std::uint64_t m = high >> shift;
+
+    // Biased two-exponent
+    int twoexponent = PowersOfTen::binaryExponent(q) + upperBit - leadingZeros + BinaryNumber::exponentBase;
+
+    // Subnormal numbers
+    if (twoexponent <= 0) {
+        // Too small, this is zero
+        if (-twoexponent + 1 >= 64) {
+            return { true, TwoBaseNumber(negative, 0, 0) };
+        }
+
+        // Shift to subnormal position, keeping a rounding bit, and round
+        m >>= -twoexponent + 1;
+        m += m & 1;
+        m >>= 1;
+
+        // Note: rounding may yield the smallest normal number, which has the same (minimal) exponent
+        return { true, TwoBaseNumber(negative, static_cast<Mantissa>(m), m != 0 ? BinaryNumber::exponentMin : 0) };
+    }
+
+    // Exact half-way case: only possible for small powers of ten, when the dropped bits are all zero. We then need
+    // to round to even, and not upward.
+    if (low <= 1 && q >= Traits::minRoundToEvenPowerOfTen && q <= Traits::maxRoundToEvenPowerOfTen &&
+        (m & 3) == 1 && (m << shift) == high) {
+        m &= ~std::uint64_t{ 1 };
+    }
 
+    // Round using the rounding bit
+    m += m & 1;
+    m >>= 1;
+
+    // Rounding overflowed the mantissa
+    if (m >= (std::uint64_t{ 2 } << mantissaBits)) {
+        m = std::uint64_t{ 1 } << mantissaBits;
+        twoexponent++;
+    }
+
+    // Overflow (+/-Inf)
+    if (twoexponent >= infinityExponent) {
+        return { true, TwoBaseNumber(negative, Mantissa{ 1 } << mantissaBits, BinaryNumber::exponentMax + 1) };
+    }
+
+    return { true, TwoBaseNumber(negative, static_cast<Mantissa>(m), twoexponent - BinaryNumber::exponentBase) };
+}
+
+template<typename N, std::size_t Base>
+constexpr ieee754toy::IEEE754Number<N, 2> ieee754toy::IEEE754Number<N, Base>::convertTwobaseExact() const
+{
+    static_assert(Base == 10);
+
+    // We need the exact product of the mantissa and 5**maxExactPowerOfTen to fit in the reduced mantissa, or we
+    // need big integers
+    static_assert(bigConversion || reducedMantissaBits >= ExactTraits::mantissaBits + 1 +
+                                                              bitWidth(power(std::uint64_t{ 5 },
+                                                                             ExactTraits::maxExactPowerOfTen)));
+
+    assert(exactConversion());
+
+    if constexpr (bigConversion) {
+        return convertTwobaseBig();
+    }
+
+    // Zero is zero
+    if (mantissa == 0) {
+        return ieee754toy::IEEE754Number<N, 2>(negative, 0, 0);
+    }
+
+    // v = mantissa · 10^exponent = mantissa · 5^exponent · 2^exponent
+    const auto fivePower = power(ReducedMantissa{ 5 }, exponent >= 0 ? exponent : -exponent);
+
+    // The product is exact, and only needs to be rounded once
+    if (exponent >= 0) {
+        return normalize(negative, ReducedMantissa{ mantissa } * fivePower, exponent);
+    }
+
+    // Move the mantissa to the leftmost position to keep as many bits as possible in the quotient, and set the
+    // least significant bit (sticky bit) if the division is inexact
+    const auto shift = static_cast<Exponent>(reducedMantissaBits - 1 - bitWidth(mantissa));
+    const ReducedMantissa dividend = ReducedMantissa{ mantissa } << shift;
+    ReducedMantissa quotient = dividend / fivePower;
+    if (dividend % fivePower != 0) {
+        quotient |= 1;
+    }
+    return normalize(negative, quotient, exponent - shift);
+}
+
+template<typename N, std::size_t Base>
+inline N ieee754toy::IEEE754Number<N, Base>::toFloatExact() const
+{
+    static_assert(Base == 10);
+    assert(exactConversion());
+
+#ifdef __FAST_MATH__
+    // Floating-point operations can not be trusted to be correctly rounded
+    return convertTwobaseExact().toFloat();
+#else
+    if constexpr (not Traits::arithmetic) {
+        // No floating-point operations (storage-only type)
+        return convertTwobaseExact().toFloat();
+    } else {
+        using Exact = typename Traits::ExactType;
+        static constexpr auto powers = [] {
+            std::array<Exact, ExactTraits::maxExactPowerOfTen + 1> powers{};
+            for (std::size_t i = 0; i < powers.size(); i++) {
+                powers[i] = power(Exact{ 10 }, i);
+            }
+            return powers;
+        }();
+
+        // Both the mantissa and the power of ten are exact, and the operation is correctly rounded
+        const auto value = static_cast<Exact>(mantissa);
+        const Exact result = exponent >= 0 ? value * powers[exponent] : value / powers[-exponent];
+        if constexpr (not std::is_same_v<Exact, N>) {
+            // The result is a normal number, and a normal number once rounded (10^±maxExactPowerOfTen · 2^53 is
+            // within the range of N): only the dropped bits matter. If they are exactly half-way, the result may
+            // have been rounded to the half-way point, and rounding it again would be wrong.
+            using ExactInteger = typename ExactTraits::IntegerType;
+            constexpr std::size_t droppedBits = ExactTraits::mantissaBits - Traits::mantissaBits;
+            constexpr ExactInteger droppedMask = (ExactInteger{ 1 } << droppedBits) - 1;
+            if ((std::bit_cast<ExactInteger>(result) & droppedMask) == (ExactInteger{ 1 } << (droppedBits - 1)))
+                [[unlikely]] {
+                return convertTwobaseExact().toFloat();
+            }
+        }
+        const auto rounded = static_cast<N>(result);
+        return negative ? -rounded : rounded;
+    }
+#endif
+}
+
+template<typename N, std::size_t Base>
+constexpr ieee754toy::IEEE754Number<N, 2> ieee754toy::IEEE754Number<N, Base>::convertTwobaseIterative() const
+{
+    if constexpr (Base == 2) {
+        return *this;
+    } else if constexpr (Base == 10) {
         // Principle: we have a number that is:
         // v = mantissa · 10^tenexponent
         //
@@ -424,6 +1086,11 @@ inline constexpr ieee754toy::IEEE754Number<N, 2> ieee754toy::IEEE754Number<N, Ba
         // expand variable mantissa precision to avoid loss of precision during iterations
         ReducedMantissa varmantissa = mantissa;
 
+        // Zero is zero
+        if (varmantissa == 0) {
+            return ieee754toy::IEEE754Number<N, 2>(negative, 0, 0);
+        }
+
         // Decrease 10-base exponent
         if (tenexponent > 0) {
             // Execute large steps first to be faster, then decrease
@@ -444,53 +1111,360 @@ inline constexpr ieee754toy::IEEE754Number<N, 2> ieee754toy::IEEE754Number<N, Ba
         // At this stage we have no longer ten-exponent: we have only a two-exponent number
         assert(tenexponent == 0);
 
-        // Zero is zero
-        if (varmantissa == 0) {
-            return ieee754toy::IEEE754Number<N, 2>(negative, 0, 0);
-        }
-
         // Now we have a two-exponent number, let's normalize it (ie. find the leftmost bit equal to 1)
+        return normalize(negative, varmantissa, twoexponent);
+    }
+}
+
+template<typename N, std::size_t Base>
+constexpr ieee754toy::IEEE754Number<N, 2> ieee754toy::IEEE754Number<N, Base>::convertTwobaseBig() const
+{
+    // Use the smallest big integers for the usual powers of ten
+    const int tenexponent = exponent >= 0 ? exponent : -exponent;
+    if (tenexponent <= 64) {
+        return convertTwobaseBig<64>();
+    } else if (tenexponent <= 512) {
+        return convertTwobaseBig<512>();
+    }
+    return convertTwobaseBig<std::max(-Traits::minPowerOfTen, Traits::maxPowerOfTen)>();
+}
+
+template<typename N, std::size_t Base>
+template<int maxPowerOfTen>
+constexpr ieee754toy::IEEE754Number<N, 2> ieee754toy::IEEE754Number<N, Base>::convertTwobaseBig() const
+{
+    static_assert(Base == 10);
+
+    using BinaryNumber = ieee754toy::IEEE754BinaryNumber<N>;
+    using TwoBaseNumber = ieee754toy::IEEE754Number<N, 2>;
 
-        constexpr std::size_t oneForEncoded = 1; // One bit is encoded through exponent
-        constexpr std::size_t mantissaBitsKept = mantissaBits + oneForEncoded;
-
-        // Now keep only leftmost 53 bit of varmantissa. First bit is implicitly equal to one, unless we have very
-        // small (subnormal) numbers.
-
-        // If no shift is done, leading bit at leftmost position is a 1^(mantissaBits + oneForEncoded - 1)
-        Exponent position = mantissaBits + oneForEncoded - 1;
-
-        // Attempt to reduce varmantissa to have at most <mantissaBits + 1> precision when 1 is leading
-        // Exponent shift = 0;
-        // for (; (varmantissa >> shift) >= (ReducedMantissa{ 1 } << mantissaBitsKept); shift++)
-        //     ;
-        // if (shift != 0) {
-        //     divideBy(varmantissa, ReducedMantissa{ 1 } << shift);
-        //     position += shift;
-        // }
-        while (varmantissa >= (ReducedMantissa{ 1 } << mantissaBitsKept)) {
-            divideBy(varmantissa, 2);
-            position++;
+    // Minimum number of bits of the quotient: the mantissa, the leading and rounding bits, and some sticky bits
+    constexpr int quotientBits = Traits::mantissaBits + 8;
+
+    // Upper bound of the number of bits of 5**q (9511/4096 > log2(5))
+    constexpr auto fivePowerBits = [](int q) { return ((q * 9511) >> 12) + 1; };
+
+    // Enough limbs for the mantissa multiplied by 5**maxPowerOfTen, or shifted before division by 5**maxPowerOfTen
+    using Big = BigInteger<(sizeof(Mantissa) * 8 + quotientBits + fivePowerBits(maxPowerOfTen)) / 64 + 1>;
+
+    // Largest power of five fitting in a limb
+    constexpr int fiveStep = 27;
+    constexpr std::uint64_t fiveStepPower = power(std::uint64_t{ 5 }, fiveStep);
+
+    // Zero is zero, and very small numbers too
+    if (mantissa == 0 || exponent < Traits::minPowerOfTen) {
+        return TwoBaseNumber(negative, 0, 0);
+    }
+
+    // Very large numbers overflow
+    if (exponent > Traits::maxPowerOfTen) {
+        return TwoBaseNumber(negative, Mantissa{ 1 } << Traits::mantissaBits, BinaryNumber::exponentMax + 1);
+    }
+
+    assert(exponent <= maxPowerOfTen && -exponent <= maxPowerOfTen);
+
+    Big number(static_cast<std::uint64_t>(mantissa));
+    if constexpr (sizeof(Mantissa) > sizeof(std::uint64_t)) {
+        number.limbs[1] = static_cast<std::uint64_t>(mantissa >> 64);
+    }
+
+    // v = mantissa · 5^exponent · 2^exponent
+    instrumentIterations(static_cast<std::size_t>(std::max<int>(exponent, -exponent) + fiveStep - 1) / fiveStep);
+    Exponent twoexponent = exponent;
+    bool inexact = false;
+    if (exponent >= 0) {
+        // The product is exact
+        for (int q = exponent; q > 0; q -= fiveStep) {
+            number.multiply(q >= fiveStep ? fiveStepPower : power(std::uint64_t{ 5 }, q));
+        }
+    } else {
+        // Shift the mantissa so that the quotient has at least quotientBits bits, and divide step by step, as
+        // floor(floor(a / b) / c) == floor(a / (b · c)): the division is inexact if any remainder is not zero
+        const int shift =
+            std::max(fivePowerBits(-exponent) + quotientBits - static_cast<int>(bitWidth(mantissa)), 0);
+        number.shiftLeft(shift);
+        twoexponent -= shift;
+        for (int q = -exponent; q > 0; q -= fiveStep) {
+            inexact |= number.divide(q >= fiveStep ? fiveStepPower : power(std::uint64_t{ 5 }, q)) != 0;
         }
+    }
+
+    // Keep the leading bits in the reduced mantissa, the dropped bits being sticky bits
+    constexpr int keptBits = reducedMantissaBits - 1;
+    if (const int width = static_cast<int>(number.bitLength()); width > keptBits) {
+        const int drop = width - keptBits;
+        inexact |= number.hasLowBits(drop);
+        number.shiftRight(drop);
+        twoexponent += drop;
+    }
+
+    auto varmantissa = static_cast<ReducedMantissa>(number.limbs[0]);
+    if constexpr (sizeof(ReducedMantissa) > sizeof(std::uint64_t)) {
+        varmantissa |= static_cast<ReducedMantissa>(number.limbs[1]) << 64;
+    }
+
+    // The sticky bit is far below the rounding bit, and is only needed to break ties
+    if (inexact) {
+        varmantissa |= 1;
+    }
+
+    return normalize(negative, varmantissa, twoexponent);
+}
+
+template<typename N, std::size_t Base>
+template<std::size_t Limbs>
+constexpr ieee754toy::IEEE754Number<N, 2>
+ieee754toy::IEEE754Number<N, Base>::roundDigits(const ieee754toy::IEEE754Number<N, 2>& candidate,
+                                                const BigInteger<Limbs>& digits,
+                                                const Exponent tenexponent,
+                                                const bool truncated)
+{
+    static_assert(Base == 10);
+
+    using BinaryNumber = ieee754toy::IEEE754BinaryNumber<N>;
+    using TwoBaseNumber = ieee754toy::IEEE754Number<N, 2>;
+
+    constexpr std::size_t mantissaBits = Traits::mantissaBits;
+
+    // Infinity is the largest number
+    if (candidate.exponent > BinaryNumber::exponentMax) {
+        return candidate;
+    }
+
+    // The following number: the mantissa may carry to the next exponent (and to infinity), and zero is followed
+    // by the smallest subnormal number
+    const Mantissa mantissa = candidate.mantissa;
+    const Exponent exponent = mantissa != 0 ? candidate.exponent : BinaryNumber::exponentMin;
+    const bool carry = mantissa + 1 == (Mantissa{ 2 } << mantissaBits);
+    const TwoBaseNumber next(candidate.negative,
+                             not carry ? mantissa + 1 : Mantissa{ 1 } << mantissaBits,
+                             not carry ? exponent : exponent + 1);
+
+    // Numbers far below the smallest half-way point, or above the largest number
+    if (digits.bitLength() == 0 || tenexponent < Traits::minPowerOfTen - static_cast<Exponent>(maxDigits)) {
+        return candidate;
+    } else if (tenexponent > Traits::maxPowerOfTen) {
+        return next;
+    }
+
+    // Compare with the half-way point h = (2 · mantissa + 1) · 2^(exponent - mantissaBits - 1), rounding half to
+    // even, the dropped digits being above the half-way point
+    const auto twoexponent = static_cast<Exponent>(exponent - static_cast<Exponent>(mantissaBits) - 1);
+    const int comparison = compareDigits(digits, tenexponent, 2 * mantissa + 1, twoexponent);
+    if (comparison < 0 || (comparison == 0 && not truncated && (mantissa & 1) == 0)) {
+        return candidate;
+    }
+    return next;
+}
+
+template<typename N, std::size_t Base>
+template<std::size_t Limbs>
+constexpr int ieee754toy::IEEE754Number<N, Base>::compareDigits(const BigInteger<Limbs>& digits,
+                                                                const Exponent tenexponent,
+                                                                const Mantissa binary,
+                                                                const Exponent twoexponent)
+{
+    static_assert(Base == 10);
+
+    // v = digits · 5^tenexponent · 2^tenexponent: move the power of five to one side, and the power of two to the
+    // other one, and estimate the width of both sides (9511/4096 being an upper bound of log2(5), the estimations
+    // are at most two bits above)
+    const int fiveBits = ((tenexponent >= 0 ? tenexponent : -tenexponent) * 9511 >> 12) + 1;
+    const int digitsBits = static_cast<int>(digits.bitLength()) + (tenexponent >= 0 ? fiveBits : 0) +
+                           std::max(tenexponent - twoexponent, 0);
+    const int binaryBits = static_cast<int>(bitWidth(binary)) + (tenexponent < 0 ? fiveBits : 0) +
+                           std::max(twoexponent - tenexponent, 0);
+    if (digitsBits > binaryBits + 2) {
+        return 1;
+    } else if (binaryBits > digitsBits + 2) {
+        return -1;
+    }
+
+    // Use the smallest big integers for the usual numbers
+    const int bits = std::max(digitsBits, binaryBits);
+    if (bits + 2 <= 8 * 64) {
+        return compareDigits<BigInteger<8>>(digits, tenexponent, binary, twoexponent);
+    } else if (bits + 2 <= 16 * 64) {
+        return compareDigits<BigInteger<16>>(digits, tenexponent, binary, twoexponent);
+    }
+    return compareDigits<DigitsInteger>(digits, tenexponent, binary, twoexponent);
+}
+
+template<typename N, std::size_t Base>
+template<typename Big, std::size_t Limbs>
+constexpr int ieee754toy::IEEE754Number<N, Base>::compareDigits(const BigInteger<Limbs>& digits,
+                                                                const Exponent tenexponent,
+                                                                const Mantissa binary,
+                                                                const Exponent twoexponent)
+{
+    static_assert(Base == 10);
+
+    // Largest power of five fitting in a limb
+    constexpr int fiveStep = 27;
+    constexpr std::uint64_t fiveStepPower = power(std::uint64_t{ 5 }, fiveStep);
+
+    Big value(digits);
+    Big other(static_cast<std::uint64_t>(binary));
+    if constexpr (sizeof(Mantissa) > sizeof(std::uint64_t)) {
+        other.limbs[1] = static_cast<std::uint64_t>(binary >> 64);
+    }
+
+    // Move the power of five to one side, and the power of two to the other one
+    Big& fiveSide = tenexponent >= 0 ? value : other;
+    for (int q = tenexponent >= 0 ? tenexponent : -tenexponent; q > 0; q -= fiveStep) {
+        fiveSide.multiply(q >= fiveStep ? fiveStepPower : power(std::uint64_t{ 5 }, q));
+    }
+    if (tenexponent >= twoexponent) {
+        value.shiftLeft(static_cast<std::size_t>(tenexponent - twoexponent));
+    } else {
+        other.shiftLeft(static_cast<std::size_t>(twoexponent - tenexponent));
+    }
+
+    return value.compare(other);
+}
 
-        // Attempt to get the leading bit on leftmost position, unless we hit the exponent limit (subnormal case)
-        while (varmantissa < (Mantissa{ 1 } << (mantissaBitsKept - 1)) &&
-               twoexponent + position > BinaryNumber::exponentMin) {
-            varmantissa *= 2;
-            position--;
+template<typename N, std::size_t Base>
+constexpr bool ieee754toy::IEEE754Number<N, Base>::exactlyConverted(const Integer bits) const
+{
+    static_assert(Base == 10);
+
+    // Zero is converted to zero
+    if (mantissa == 0) {
+        return true;
+    }
+
+    // v = mantissa · 5^exponent · 2^exponent = (mantissa / 2^zeros) · 5^exponent · 2^(exponent + zeros), the
+    // power of five and the mantissa without its trailing zeros being odd: it must have the same two-exponent as
+    // the odd mantissa of the converted number
+    const auto [odd, twoexponent] = oddMantissa(bits);
+    const auto zeros = static_cast<Exponent>(trailingZeros(mantissa));
+    if (odd == 0 || exponent + zeros != twoexponent) {
+        return false;
+    }
+
+    // And the same odd part: multiply the smallest one by five until both are equal, or it exceeds the largest one
+    const Mantissa decimal = mantissa >> zeros;
+    Mantissa product = exponent >= 0 ? decimal : odd;
+    const Mantissa target = exponent >= 0 ? odd : decimal;
+    for (int q = exponent >= 0 ? exponent : -exponent; q > 0; q--) {
+        if (product > target / 5) {
+            return false;
         }
+        product *= 5;
+    }
+    return product == target;
+}
 
-        // Fix exponent after shift
-        twoexponent += position;
+template<typename N, std::size_t Base>
+template<std::size_t Limbs>
+constexpr bool ieee754toy::IEEE754Number<N, Base>::exactDigits(const Integer bits,
+                                                               const BigInteger<Limbs>& digits,
+                                                               const Exponent tenexponent,
+                                                               const bool truncated)
+{
+    static_assert(Base == 10);
+
+    // Any non-zero dropped digit makes the number longer than any floating-point number (see maxDigits)
+    const auto [odd, twoexponent] = oddMantissa(bits);
+    if (truncated || (odd == 0) != (digits.bitLength() == 0)) {
+        return false;
+    } else if (odd == 0) {
+        return true;
+    }
+
+    // Numbers far below the smallest floating-point number, or above the largest one
+    if (tenexponent < Traits::minPowerOfTen - static_cast<Exponent>(maxDigits) ||
+        tenexponent > Traits::maxPowerOfTen) {
+        return false;
+    }
+
+    // v = digits · 5^tenexponent · 2^tenexponent, the power of five being odd: the digits must have exactly
+    // twoexponent - tenexponent trailing zero bits (see exactlyConverted()), which rejects most numbers without
+    // any multiplication
+    const int zeros = twoexponent - tenexponent;
+    if (zeros < 0 || digits.hasLowBits(static_cast<std::size_t>(zeros)) ||
+        not digits.hasLowBits(static_cast<std::size_t>(zeros) + 1)) {
+        return false;
+    }
 
-        // We need to take care of possibly overflowing exponent, too.
-        while (twoexponent < BinaryNumber::exponentMin) {
-            divideBy(varmantissa, 2);
-            twoexponent++;
+    // Likewise, a negative ten-exponent can only be compensated by digits multiple of five (the limbs being summed
+    // modulo five, as 2^64 is 1 modulo five)
+    if (tenexponent < 0) {
+        std::uint64_t remainder = 0;
+        for (const auto limb : digits.limbs) {
+            remainder += limb % 5;
         }
+        if (remainder % 5 != 0) {
+            return false;
+        }
+    }
+
+    return compareDigits(digits, tenexponent, odd, twoexponent) == 0;
+}
+
+template<typename N, std::size_t Base>
+constexpr std::tuple<typename ieee754toy::IEEE754Number<N, Base>::Mantissa,
+                     typename ieee754toy::IEEE754Number<N, Base>::Exponent>
+ieee754toy::IEEE754Number<N, Base>::oddMantissa(const Integer bits)
+{
+    using BinaryNumber = ieee754toy::IEEE754BinaryNumber<N>;
+
+    constexpr std::size_t mantissaBits = Traits::mantissaBits;
+    constexpr auto exponentMask = static_cast<Exponent>((1 << Traits::exponentBits) - 1);
+
+    // Infinity and NaN
+    const auto biasedExponent = static_cast<Exponent>((bits >> mantissaBits) & exponentMask);
+    if (biasedExponent == exponentMask) {
+        return { 0, 0 };
+    }
 
-        return ieee754toy::IEEE754Number<N, 2>(negative, varmantissa, twoexponent);
+    // Subnormal numbers have the exponent of the smallest normal numbers, without the implicit leading bit
+    const auto fraction = static_cast<Mantissa>(bits & ((Integer{ 1 } << mantissaBits) - 1));
+    const Mantissa mantissa = biasedExponent != 0 ? fraction | (Mantissa{ 1 } << mantissaBits) : fraction;
+    if (mantissa == 0) {
+        return { 0, 0 };
     }
+    const auto zeros = static_cast<Exponent>(trailingZeros(mantissa));
+    const auto exponent =
+        static_cast<Exponent>(std::max<Exponent>(biasedExponent, 1) - BinaryNumber::exponentBase);
+    return { mantissa >> zeros, static_cast<Exponent>(exponent - static_cast<Exponent>(mantissaBits) + zeros) };
+}
+
+template<typename N, std::size_t Base>
+constexpr ieee754toy::IEEE754Number<N, 2>
+ieee754toy::IEEE754Number<N, Base>::normalize(bool negative, ReducedMantissa varmantissa, Exponent twoexponent)
+{
+    using BinaryNumber = ieee754toy::IEEE754BinaryNumber<N>;
+
+    constexpr std::size_t mantissaBits = Traits::mantissaBits;
+
+    // Zero is zero
+    if (varmantissa == 0) {
+        return ieee754toy::IEEE754Number<N, 2>(negative, 0, 0);
+    }
+
+    // We have v = varmantissa · 2^twoexponent, and we want v = mantissa · 2^(exponent - mantissaBits), with the
+    // leading bit of mantissa on the (mantissaBits + 1)-th position (the one encoded through exponent), unless we
+    // hit the minimal exponent (subnormal case).
+    const auto width = static_cast<Exponent>(bitWidth(varmantissa));
+    const Exponent exponent = std::max<Exponent>(twoexponent + width - 1, BinaryNumber::exponentMin);
+
+    // Number of bits to drop (or to add, when negative) to get the final mantissa
+    const Exponent shift = exponent - static_cast<Exponent>(mantissaBits) - twoexponent;
+    if (shift <= 0) {
+        return ieee754toy::IEEE754Number<N, 2>(negative, static_cast<Mantissa>(varmantissa << -shift), exponent);
+    }
+
+    // Drop all bits at once, rounding half to even
+    const ReducedMantissa rounded = shiftRightRounded(varmantissa, shift);
+
+    // Rounding may carry to an additional leading bit: the mantissa is then a power of two, and can be shifted
+    // without loss
+    if (rounded >= (ReducedMantissa{ 1 } << (mantissaBits + 1))) {
+        return ieee754toy::IEEE754Number<N, 2>(negative, static_cast<Mantissa>(rounded >> 1), exponent + 1);
+    }
+
+    return ieee754toy::IEEE754Number<N, 2>(negative, static_cast<Mantissa>(rounded), exponent);
 }
 
 template<typename N, std::size_t Base>
@@ -0,0 +1,381 @@
+/*
+ * IEEE754 constexpr parser toy. Hot path instrumentation.
+ * Thanks to Algolia for giving me the opportunity to develop this toy!
+ * @maintainer Xavier Roche (xavier dot roche at algolia.com)
+ */
+#pragma once
+
+/**
+ * Opt-in instrumentation of the parsing hot path, compiled out unless IEEE754TOY_INSTRUMENTATION is defined: the
+ * cycles spent in each stage, the conversion path taken by each value, and the distributions of digit counts,
+ * decimal exponents and conversion loop iterations, and the parse cache hits and misses (see ParseCache).
+ * Counters are per thread, and only written by their thread (without atomic read-modify-write, nor shared cache
+ * lines). They are aggregated without locks by instrumentationSnapshot(), which can be called at any time from any
+ * thread (eg. to export them periodically from a canary host).
+ * @comment Reading the cycle counter costs a few dozens of cycles, four times per value: enabling the
+ * instrumentation roughly doubles the parsing time of short numbers, even though the measured stages do not
+ * include it. The counter is not serializing, and is only meant to size optimizations statistically.
+ */
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#elif not defined(__aarch64__)
+#include <chrono>
+#endif
+
+namespace ieee754toy {
+
+/** Instrumented stages of the parsing hot path. **/
+enum class InstrumentedStage : std::uint8_t
+{
+    Mantissa,      // Digits of the mantissa, and the decimal point (NumericalParser::parseDigits)
+    Exponent,      // Explicit exponent (NumericalParser::parseExponent)
+    Conversion,    // Ten-exponent to two-exponent conversion (NumericalParser::convertTwobase, or the exact path)
+    Normalization, // Rounding and packing of the base-2 number (IEEE754Number::toFloat)
+};
+
+/** Conversion paths of decimal numbers (see NumericalParser::convertTwobase). **/
+enum class ConversionPath : std::uint8_t
+{
+    Exact,     // Exact fast path: one floating-point operation (IEEE754Number::toFloatExact)
+    Table,     // Table-driven (or big integers) conversion of the mantissa (IEEE754Number::convertTwobaseBounded)
+    Iterative, // Ambiguous rounding, without the digits: iterative method (IEEE754Number::convertTwobaseIterative)
+    Digits,    // Ambiguous rounding: all the digits are scanned again (NumericalParser::convertTwobaseDigits)
+};
+
+/** Aggregated instrumentation counters (see instrumentationSnapshot()). **/
+struct InstrumentationSnapshot
+{
+    static constexpr std::size_t stages = 4;
+    static constexpr std::size_t paths = 4;
+
+    /** Digit counts histogram buckets: one per count, the last one being for longer mantissas **/
+    static constexpr std::size_t digitBuckets = 64;
+
+    /** Decimal exponent histogram buckets: one per exponent from minExponent, the first and last ones saturate **/
+    static constexpr std::size_t exponentBuckets = 128;
+    static constexpr int minExponent = -64;
+
+    /** Loop iterations histogram buckets: one per count, the last one being for longer conversions **/
+    static constexpr std::size_t iterationBuckets = 64;
+
+    /** Cycles (cycle counter ticks) spent in each stage (see InstrumentedStage) **/
+    std::array<std::uint64_t, stages> cycles{};
+
+    /** Number of measures of each stage **/
+    std::array<std::uint64_t, stages> calls{};
+
+    /** Number of decimal values converted through each path (see ConversionPath) **/
+    std::array<std::uint64_t, paths> conversions{};
+
+    /** Number of decimal values per mantissa digit count (leading zeros and digit separators included) **/
+    std::array<std::uint64_t, digitBuckets> digits{};
+
+    /** Number of decimal values per ten-exponent of their integral mantissa (eg. -3 for "1.250") **/
+    std::array<std::uint64_t, exponentBuckets> exponents{};
+
+    /** Number of conversions per count of iterative or big integer conversion loop iterations **/
+    std::array<std::uint64_t, iterationBuckets> iterations{};
+
+    /** Number of values found in a parse cache, and parsed by a parse cache (see ParseCache) **/
+    std::uint64_t cacheHits = 0;
+    std::uint64_t cacheMisses = 0;
+
+    /** Number of counters blocks: the peak number of threads which recorded counters **/
+    std::uint64_t threads = 0;
+};
+
+static_assert(InstrumentationSnapshot::stages == static_cast<std::size_t>(InstrumentedStage::Normalization) + 1);
+static_assert(InstrumentationSnapshot::paths == static_cast<std::size_t>(ConversionPath::Digits) + 1);
+
+/** Stage names, for dumps. **/
+inline constexpr std::array<const char*, InstrumentationSnapshot::stages> instrumentedStageNames = {
+    "mantissa", "exponent", "conversion", "normalization"
+};
+
+/** Conversion path names, for dumps. **/
+inline constexpr std::array<const char*, InstrumentationSnapshot::paths> conversionPathNames = {
+    "exact", "table", "iterative", "digits"
+};
+
+/**
+ * Counters of a thread. Blocks are never freed: the block of an exited thread is kept in the aggregation, and
+ * reused by the next new thread, so that the number of blocks is bounded by the peak number of threads.
+ **/
+class InstrumentationCounters
+{
+public:
+    /** Return the counters block of the current thread. **/
+    static InstrumentationCounters& local();
+
+    /** Aggregate all blocks. **/
+    static InstrumentationSnapshot snapshot();
+
+    /** Add cycles to a stage. **/
+    void addCycles(const InstrumentedStage stage, const std::uint64_t cycles)
+    {
+        add(cycles_[static_cast<std::size_t>(stage)], cycles);
+        add(calls_[static_cast<std::size_t>(stage)], 1);
+    }
+
+    /** Count a parsed decimal number. **/
+    void addNumber(const std::size_t digits, const int exponent)
+    {
+        constexpr int maxExponent =
+            InstrumentationSnapshot::minExponent + static_cast<int>(InstrumentationSnapshot::exponentBuckets) - 1;
+        const int bucket = exponent < InstrumentationSnapshot::minExponent ? InstrumentationSnapshot::minExponent
+                           : exponent > maxExponent                       ? maxExponent
+                                                                          : exponent;
+        add(digits_[digits < InstrumentationSnapshot::digitBuckets ? digits
+                                                                   : InstrumentationSnapshot::digitBuckets - 1],
+            1);
+        add(exponents_[static_cast<std::size_t>(bucket - InstrumentationSnapshot::minExponent)], 1);
+    }
+
+    /** Count a conversion, and its pending loop iterations. **/
+    void addConversion(const ConversionPath path)
+    {
+        add(conversions_[static_cast<std::size_t>(path)], 1);
+        add(iterations_[pendingIterations < InstrumentationSnapshot::iterationBuckets
+                            ? pendingIterations
+                            : InstrumentationSnapshot::iterationBuckets - 1],
+            1);
+        pendingIterations = 0;
+    }
+
+    /** Count a parse cache lookup. **/
+    void addCacheLookup(const bool hit) { add(hit ? cacheHits_ : cacheMisses_, 1); }
+
+    /** Count conversion loop iterations, until the next conversion is counted. **/
+    void addIterations(const std::size_t iterations) { pendingIterations += iterations; }
+
+private:
+    using Counter = std::atomic<std::uint64_t>;
+
+    /** Increment a counter written by this thread only: a plain addition, which readers see atomically. **/
+    static void add(Counter& counter, const std::uint64_t value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    /** Head of the list of all blocks, which only grows. **/
+    static std::atomic<InstrumentationCounters*>& head()
+    {
+        static std::atomic<InstrumentationCounters*> blocks{ nullptr };
+        return blocks;
+    }
+
+    /** Take an unowned block, or allocate a new one. **/
+    static InstrumentationCounters* acquire();
+
+    /** Owns the block of a thread, until the thread exits. **/
+    struct Owner
+    {
+        Owner()
+          : counters(acquire())
+        {}
+        ~Owner() { counters->owned.store(false, std::memory_order_release); }
+        InstrumentationCounters* const counters;
+    };
+
+    alignas(64) std::array<Counter, InstrumentationSnapshot::stages> cycles_{};
+    std::array<Counter, InstrumentationSnapshot::stages> calls_{};
+    std::array<Counter, InstrumentationSnapshot::paths> conversions_{};
+    std::array<Counter, InstrumentationSnapshot::digitBuckets> digits_{};
+    std::array<Counter, InstrumentationSnapshot::exponentBuckets> exponents_{};
+    std::array<Counter, InstrumentationSnapshot::iterationBuckets> iterations_{};
+    Counter cacheHits_{ 0 };
+    Counter cacheMisses_{ 0 };
+    std::size_t pendingIterations = 0;
+    std::atomic<bool> owned{ true };
+    InstrumentationCounters* next = nullptr;
+};
+
+inline InstrumentationCounters* InstrumentationCounters::acquire()
+{
+    for (auto* block = head().load(std::memory_order_acquire); block != nullptr; block = block->next) {
+        bool owned = false;
+        if (block->owned.compare_exchange_strong(owned, true, std::memory_order_acquire)) {
+            block->pendingIterations = 0;
+            return block;
+        }
+    }
+
+    auto* const block = new InstrumentationCounters();
+    block->next = head().load(std::memory_order_relaxed);
+    while (not head().compare_exchange_weak(block->next, block, std::memory_order_release)) {
+    }
+    return block;
+}
+
+inline InstrumentationCounters& InstrumentationCounters::local()
+{
+    static thread_local const Owner owner;
+    return *owner.counters;
+}
+
+inline InstrumentationSnapshot InstrumentationCounters::snapshot()
+{
+    InstrumentationSnapshot snapshot;
+    const auto sum = []<std::size_t Size>(std::array<std::uint64_t, Size>& total,
+                                          const std::array<Counter, Size>& counters) {
+        for (std::size_t i = 0; i < Size; i++) {
+            total[i] += counters[i].load(std::memory_order_relaxed);
+        }
+    };
+    for (auto* block = head().load(std::memory_order_acquire); block != nullptr; block = block->next) {
+        sum(snapshot.cycles, block->cycles_);
+        sum(snapshot.calls, block->calls_);
+        sum(snapshot.conversions, block->conversions_);
+        sum(snapshot.digits, block->digits_);
+        sum(snapshot.exponents, block->exponents_);
+        sum(snapshot.iterations, block->iterations_);
+        snapshot.cacheHits += block->cacheHits_.load(std::memory_order_relaxed);
+        snapshot.cacheMisses += block->cacheMisses_.load(std::memory_order_relaxed);
+        snapshot.threads++;
+    }
+    return snapshot;
+}
+
+/** Is the instrumentation compiled in ? **/
+inline constexpr bool instrumentationEnabled =
+#ifdef IEEE754TOY_INSTRUMENTATION
+    true;
+#else
+    false;
+#endif
+
+/** Read the cycle counter (the time-stamp counter on x86, the virtual counter on AArch64, or nanoseconds). **/
+inline std::uint64_t readCycleCounter()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    std::uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+/**
+ * The hooks of the hot path: no-ops when the instrumentation is compiled out, and in constexpr context.
+ * A stage is measured from the value returned by instrumentationStart() to the instrumentStage() call.
+ * @warning The start must not be stored in a const variable, whose initializer would be constant-evaluated (the
+ * start would then always be zero).
+ **/
+constexpr std::uint64_t instrumentationStart()
+{
+    if constexpr (instrumentationEnabled) {
+        if (not std::is_constant_evaluated()) {
+            return readCycleCounter();
+        }
+    }
+    return 0;
+}
+
+constexpr void instrumentStage([[maybe_unused]] const InstrumentedStage stage,
+                               [[maybe_unused]] const std::uint64_t start)
+{
+    if constexpr (instrumentationEnabled) {
+        if (not std::is_constant_evaluated()) {
+            InstrumentationCounters::local().addCycles(stage, readCycleCounter() - start);
+        }
+    }
+}
+
+constexpr void instrumentNumber([[maybe_unused]] const std::size_t digits, [[maybe_unused]] const int exponent)
+{
+    if constexpr (instrumentationEnabled) {
+        if (not std::is_constant_evaluated()) {
+            InstrumentationCounters::local().addNumber(digits, exponent);
+        }
+    }
+}
+
+constexpr void instrumentConversion([[maybe_unused]] const ConversionPath path)
+{
+    if constexpr (instrumentationEnabled) {
+        if (not std::is_constant_evaluated()) {
+            InstrumentationCounters::local().addConversion(path);
+        }
+    }
+}
+
+constexpr void instrumentIterations([[maybe_unused]] const std::size_t iterations)
+{
+    if constexpr (instrumentationEnabled) {
+        if (not std::is_constant_evaluated()) {
+            InstrumentationCounters::local().addIterations(iterations);
+        }
+    }
+}
+
+constexpr void instrumentCacheLookup([[maybe_unused]] const bool hit)
+{
+    if constexpr (instrumentationEnabled) {
+        if (not std::is_constant_evaluated()) {
+            InstrumentationCounters::local().addCacheLookup(hit);
+        }
+    }
+}
+
+/** Return the counters of all threads, aggregated (all zero when the instrumentation is compiled out). **/
+inline InstrumentationSnapshot instrumentationSnapshot()
+{
+    return InstrumentationCounters::snapshot();
+}
+
+/**
+ * Write the aggregated counters, one "name value" line per non-zero counter (eg. "stage.mantissa.cycles 1234",
+ * "path.exact 12", "digits.17 3", "exponent.-16 3", "iterations.2 1" or "cache.hits 12").
+ * @param file The output file (eg. stderr)
+ **/
+inline void dumpInstrumentation(std::FILE* const file)
+{
+    const InstrumentationSnapshot snapshot = instrumentationSnapshot();
+    std::fprintf(file, "threads %llu\n", static_cast<unsigned long long>(snapshot.threads));
+    const auto dump = [file](const char* name, const auto key, const std::uint64_t value) {
+        if (value != 0) {
+            if constexpr (std::is_integral_v<decltype(key)>) {
+                std::fprintf(
+                    file, "%s.%d %llu\n", name, static_cast<int>(key), static_cast<unsigned long long>(value));
+            } else {
+                std::fprintf(file, "%s.%s %llu\n", name, key, static_cast<unsigned long long>(value));
+            }
+        }
+    };
+    for (std::size_t i = 0; i < InstrumentationSnapshot::stages; i++) {
+        std::fprintf(file,
+                     "stage.%s.calls %llu\nstage.%s.cycles %llu\n",
+                     instrumentedStageNames[i],
+                     static_cast<unsigned long long>(snapshot.calls[i]),
+                     instrumentedStageNames[i],
+                     static_cast<unsigned long long>(snapshot.cycles[i]));
+    }
+    for (std::size_t i = 0; i < InstrumentationSnapshot::paths; i++) {
+        dump("path", conversionPathNames[i], snapshot.conversions[i]);
+    }
+    for (std::size_t i = 0; i < InstrumentationSnapshot::digitBuckets; i++) {
+        dump("digits", i, snapshot.digits[i]);
+    }
+    for (std::size_t i = 0; i < InstrumentationSnapshot::exponentBuckets; i++) {
+        dump("exponent", static_cast<int>(i) + InstrumentationSnapshot::minExponent, snapshot.exponents[i]);
+    }
+    for (std::size_t i = 0; i < InstrumentationSnapshot::iterationBuckets; i++) {
+        dump("iterations", i, snapshot.iterations[i]);
+    }
+    dump("cache", "hits", snapshot.cacheHits);
+    dump("cache", "misses", snapshot.cacheMisses);
+}
+
+}; // namespace ieee754toy
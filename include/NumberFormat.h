@@ -0,0 +1,102 @@
+/*
+ * IEEE754 constexpr parser toy. Number format policies.
+ * Thanks to Algolia for giving me the opportunity to develop this toy!
+ * @maintainer Xavier Roche (xavier dot roche at algolia.com)
+ */
+#pragma once
+
+#include "CpuDispatch.h"
+
+#include <cstddef>
+#include <string_view>
+
+namespace ieee754toy {
+
+/**
+ * The default number format: C-locale decimal numbers (eg. "-12.5e3"), with a dot as decimal point, no digit
+ * separators, and no hexadecimal floats.
+ * Other formats are defined by inheriting from this one and overriding some of its members, for example:
+ * @code
+ * struct DecimalCommaFormat : DefaultNumberFormat
+ * {
+ *     static constexpr char decimalPoint = ',';
+ * };
+ * @endcode
+ * The format is a template parameter of NumericalParser: it is resolved at compile-time, and the parsing loops
+ * stay specialized for it.
+ **/
+struct DefaultNumberFormat
+{
+    /** The decimal point (eg. ',' for most European locales) **/
+    static constexpr char decimalPoint = '.';
+
+    /**
+     * Digit separators, ignored between two digits of the mantissa (eg. "_'" for "1_000" or "1'000"). A separator
+     * not surrounded by digits ends the number.
+     **/
+    static constexpr std::string_view digitSeparators = "";
+
+    /**
+     * Parse C99 hexadecimal floats too (eg. "0x1.8p3", the binary exponent being optional). Hexadecimal floats
+     * are converted exactly, without the ten-to-two exponent conversion.
+     **/
+    static constexpr bool hexFloats = false;
+
+    /** Accept a mantissa without digits before the decimal point (eg. ".5") **/
+    static constexpr bool leadingDot = true;
+
+    /** Accept a mantissa without digits after the decimal point (eg. "5.") **/
+    static constexpr bool trailingDot = true;
+
+    /**
+     * Fixed-point inputs (see FixedFormat): exactly integerDigits digits, the decimal point (omitted without
+     * fraction digits) and fractionDigits digits, without sign nor exponent.
+     **/
+    static constexpr bool fixedPoint = false;
+    static constexpr std::size_t integerDigits = 0;
+    static constexpr std::size_t fractionDigits = 0;
+
+    /**
+     * The SIMD level of the digits scanning kernels (see CpuDispatch.h): the level enabled by the compiler flags.
+     * The batch parsers override it with the level of the running CPU.
+     **/
+    static constexpr SimdLevel simdLevel = compiledSimdLevel;
+};
+
+/** A number format, with the digits scanning kernels of the given SIMD level. **/
+template<typename Format, SimdLevel Level>
+struct SimdNumberFormat : Format
+{
+    static constexpr SimdLevel simdLevel = Level;
+};
+
+/**
+ * A fixed-point format, with a known number of integral and fractional digits (eg. FixedFormat<7, 4> for
+ * "0001234.5600"). The digits are accumulated in a single fully unrolled multiply-add chain, without looking for a
+ * sign, the decimal point or an exponent, and the ten-exponent is known at compile-time: when the exact fast path
+ * can convert every number of the format (eg. up to fifteen digits and 10^-22 for double), it is taken without
+ * any check. The decimal point is the one of the base format, whose other members are ignored.
+ **/
+template<std::size_t IntegerDigits, std::size_t FractionDigits, typename Format = DefaultNumberFormat>
+struct FixedFormat : Format
+{
+    static_assert(IntegerDigits + FractionDigits != 0);
+
+    static constexpr bool fixedPoint = true;
+    static constexpr std::size_t integerDigits = IntegerDigits;
+    static constexpr std::size_t fractionDigits = FractionDigits;
+};
+
+/** Is the character a digit separator of the format ? **/
+template<typename Format, typename T>
+inline constexpr bool isDigitSeparator(const T c)
+{
+    for (const char separator : Format::digitSeparators) {
+        if (c == static_cast<T>(separator)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}; // namespace ieee754toy
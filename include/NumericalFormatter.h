@@ -0,0 +1,378 @@
+/*
+ * IEEE754 constexpr parser toy. Shortest round-trip formatter.
+ * Thanks to Algolia for giving me the opportunity to develop this toy!
+ * @maintainer Xavier Roche (xavier dot roche at algolia.com)
+ */
+#pragma once
+
+/**
+ * Shortest decimal representation of IEEE754 numbers, using the Schubfach method.
+ * References:
+ * <https://drive.google.com/file/d/1IEeATSVnEE6TkrHlCYNY2GjaraBjOT4f> (Raffaello Giulietti, "The Schubfach way
+ * to render doubles")
+ * <https://github.com/abolz/Drachennest>
+ */
+
+#include "BigInteger.h"
+#include "IEEE754.h"
+#include "PowersOfTen.h"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+namespace ieee754toy {
+
+/**
+ * Powers of ten used by the shortest representation.
+ * Each entry holds g = floor(10**k / 2**e) + 1, with e such that 2**127 <= g < 2**128. Unlike PowersOfTen, all
+ * entries are rounded up, including exact ones, and the range covers the powers needed by subnormals.
+ **/
+struct ShortestPowersOfTen
+{
+    /** A 128-bit normalized power of ten. **/
+    using Entry = PowersOfTen::Entry;
+
+    /** Smallest power of ten in the table. **/
+    static constexpr int smallestPowerOfTen = -292;
+
+    /** Largest power of ten in the table. **/
+    static constexpr int largestPowerOfTen = 324;
+
+    /** Number of entries. **/
+    static constexpr std::size_t size = largestPowerOfTen - smallestPowerOfTen + 1;
+
+    /** Generate the table (at compile-time only). **/
+    static consteval std::array<Entry, size> generate();
+
+    /** Return the entry for 10**k, with smallestPowerOfTen <= k <= largestPowerOfTen. **/
+    static constexpr Entry get(int k);
+};
+
+consteval std::array<ShortestPowersOfTen::Entry, ShortestPowersOfTen::size> ShortestPowersOfTen::generate()
+{
+    std::array<Entry, size> table{};
+
+    // Negative powers: floor(2**B / 5**n), truncated to its 128 leading bits (cascading floor divisions are
+    // exact), and rounded up (floor + 1)
+    {
+        using Reciprocal = BigInteger<27>;
+        constexpr std::size_t B = Reciprocal::bits - 1;
+        Reciprocal reciprocal = Reciprocal::powerOfTwo(B);
+        for (int n = 1; n <= -smallestPowerOfTen; n++) {
+            reciprocal.divide(5);
+            table[-smallestPowerOfTen - n] = normalizedEntry(reciprocal, 1);
+        }
+    }
+
+    // Positive powers: 5**k, truncated to its 128 leading bits, and rounded up
+    {
+        using Power = BigInteger<12>;
+        Power power(1);
+        for (int k = 0; k <= largestPowerOfTen; k++) {
+            table[k - smallestPowerOfTen] = normalizedEntry(power, 1);
+            power.multiply(5);
+        }
+    }
+
+    return table;
+}
+
+/** The table itself, full or compact (see powersOfTenTable). **/
+#ifdef IEEE754TOY_COMPACT_TABLES
+inline constexpr auto shortestPowersOfTenTable =
+    CompactPowersOfTen<ShortestPowersOfTen::size>::compress(ShortestPowersOfTen::generate());
+
+constexpr ShortestPowersOfTen::Entry ShortestPowersOfTen::get(int k)
+{
+    return shortestPowersOfTenTable.get(k - smallestPowerOfTen);
+}
+#else
+inline constexpr std::array<ShortestPowersOfTen::Entry, ShortestPowersOfTen::size> shortestPowersOfTenTable =
+    ShortestPowersOfTen::generate();
+
+constexpr ShortestPowersOfTen::Entry ShortestPowersOfTen::get(int k)
+{
+    return shortestPowersOfTenTable[k - smallestPowerOfTen];
+}
+#endif
+
+// Basic table checks.
+static_assert(ShortestPowersOfTen::get(0).high == 0x8000000000000000 && ShortestPowersOfTen::get(0).low == 1);
+static_assert(ShortestPowersOfTen::get(1).high == 0xA000000000000000 && ShortestPowersOfTen::get(1).low == 1);
+static_assert(ShortestPowersOfTen::get(-1).high == 0xCCCCCCCCCCCCCCCC &&
+              ShortestPowersOfTen::get(-1).low == 0xCCCCCCCCCCCCCCCD);
+static_assert(ShortestPowersOfTen::get(-292).high == 0xFF77B1FCBEBCDC4F &&
+              ShortestPowersOfTen::get(-292).low == 0x25E8E89C13BB0F7B);
+static_assert(ShortestPowersOfTen::get(324).high == 0x9E19DB92B4E31BA9 &&
+              ShortestPowersOfTen::get(324).low == 0x6C07A2C26A8346D2);
+
+/**
+ * Return the shortest decimal representation of a finite IEEE754 number, parsing back to the same number.
+ * @param value The IEEE754 integer value (see IEEE754BinaryNumber)
+ * @return The decimal number, whose mantissa has no trailing zeros (zero being represented with a zero mantissa
+ * and exponent)
+ * @warning The number must be finite.
+ **/
+template<typename N>
+constexpr IEEE754Number<N, 10> toShortestDecimal(typename IEEE754Traits<N>::IntegerType value);
+
+/**
+ * Numerical formatting helpers: write the shortest round-trip representation of numbers into a caller buffer.
+ * The output follows the ECMAScript Number::toString() rules (eg. "0.1", "123", "1.5e+300", "5e-324"), plus
+ * "Inf", "-Inf" and "NaN" for non-finite numbers, and can be parsed back by NumericalParser.
+ **/
+template<typename T>
+class NumericalFormatter : private std::span<T>
+{
+public:
+    /** Maximum number of characters written. **/
+    static constexpr std::size_t maxLength = 32;
+
+    /** Create a new numerical formatter over a buffer **/
+    template<typename... Ts>
+    constexpr NumericalFormatter(Ts&&... args)
+      : std::span<T>(std::forward<Ts>(args)...)
+    {}
+
+    /**
+     * Format a floating point value.
+     * @param value The value to be formatted
+     * @return The number of characters written, or @c 0 if the buffer is too small.
+     */
+    template<typename N = double>
+    constexpr std::size_t format(N value) const
+    {
+        return formatIEEE754<N>(std::bit_cast<typename IEEE754Traits<N>::IntegerType>(value));
+    }
+
+    /**
+     * Format a floating point value, given as the IEEE754 integer value.
+     * @param value The IEEE754 integer value (see IEEE754BinaryNumber)
+     * @return The number of characters written, or @c 0 if the buffer is too small.
+     */
+    template<typename N = double>
+    constexpr std::size_t formatIEEE754(typename IEEE754Traits<N>::IntegerType value) const;
+
+private:
+    using std::span<T>::size;
+    using std::span<T>::operator[];
+};
+
+// Deduction guides.
+template<typename Type>
+explicit NumericalFormatter(Type* begin, std::size_t size) -> NumericalFormatter<Type>;
+template<typename Type>
+explicit NumericalFormatter(Type* begin, Type* end) -> NumericalFormatter<Type>;
+
+}; // namespace ieee754toy
+
+template<typename N>
+constexpr ieee754toy::IEEE754Number<N, 10> ieee754toy::toShortestDecimal(
+    typename IEEE754Traits<N>::IntegerType value)
+{
+    using Traits = IEEE754Traits<N>;
+    using Integer = typename Traits::IntegerType;
+    using Wide = std::conditional_t<sizeof(Integer) == sizeof(std::uint64_t), __uint128_t, std::uint64_t>;
+    using Number = IEEE754Number<N, 10>;
+    using Exponent = typename Number::Exponent;
+
+    constexpr std::size_t integerBits = sizeof(Integer) * 8;
+    constexpr Integer hidden = Integer{ 1 } << Traits::mantissaBits;
+    constexpr int bias = IEEE754BinaryNumber<N>::exponentBase + Traits::mantissaBits;
+    static_assert(sizeof(Wide) == 2 * sizeof(Integer));
+
+    // The number is c * 2**q
+    const bool negative = (value >> (integerBits - 1)) != 0;
+    const Integer fraction = value & (hidden - 1);
+    const auto biased =
+        static_cast<int>((value >> Traits::mantissaBits) & ((Integer{ 1 } << Traits::exponentBits) - 1));
+    const Integer c = biased != 0 ? hidden | fraction : fraction;
+    const int q = biased != 0 ? biased - bias : 1 - bias;
+
+    // Strip trailing zeros
+    const auto result = [negative](Integer digits, int exponent) {
+        while (digits != 0 && digits % 10 == 0) {
+            digits /= 10;
+            exponent++;
+        }
+        return Number(negative, digits, digits != 0 ? static_cast<Exponent>(exponent) : 0);
+    };
+
+    // Zero
+    if (c == 0) {
+        return result(0, 0);
+    }
+
+    // Small integers are their own shortest representation
+    if (q <= 0 && -q <= static_cast<int>(Traits::mantissaBits) && (c & ((Integer{ 1 } << -q) - 1)) == 0) {
+        return result(c >> -q, 0);
+    }
+
+    // Rounding interval boundaries (scaled by four), the lower one being closer at powers of two
+    const bool even = c % 2 == 0;
+    const bool closer = fraction == 0 && biased > 1;
+    const Integer cbl = 4 * c - 2 + closer;
+    const Integer cb = 4 * c;
+    const Integer cbr = 4 * c + 2;
+
+    // k = floor(log10(2**q)) (or floor(log10(3/4 * 2**q)) when the lower boundary is closer), and h the shift
+    // such that the boundaries times 10**-k fit
+    const int k = (q * 1262611 - (closer ? 524031 : 0)) >> 22;
+    const int h = q + ((-k * 1741647) >> 19) + 1;
+
+    // The power of ten, split in two halves of Integer width
+    const auto& power = ShortestPowersOfTen::get(-k);
+    Integer gHigh;
+    Integer gLow;
+    if constexpr (integerBits == 64) {
+        gHigh = power.high;
+        gLow = power.low;
+    } else {
+        static_assert(integerBits == 32);
+        const std::uint64_t g = power.high + (power.low != 0 ? 1 : 0);
+        gHigh = static_cast<Integer>(g >> 32);
+        gLow = static_cast<Integer>(g);
+    }
+
+    // Return the leading Integer of g * cp, the least significant bit being set if the product is inexact
+    const auto roundToOdd = [gHigh, gLow](Integer cp) {
+        const Wide x = Wide{ gLow } * cp;
+        const Wide y = Wide{ gHigh } * cp;
+        const Wide z = y + (x >> integerBits);
+        return static_cast<Integer>(z >> integerBits) | (static_cast<Integer>(z) > 1 ? 1 : 0);
+    };
+    const Integer vbl = roundToOdd(cbl << h);
+    const Integer vb = roundToOdd(cb << h);
+    const Integer vbr = roundToOdd(cbr << h);
+
+    // Boundaries are included for even numbers only
+    const Integer lower = vbl + (even ? 0 : 1);
+    const Integer upper = vbr - (even ? 0 : 1);
+
+    // First try one digit less
+    const Integer s = vb / 4;
+    if (s >= 10) {
+        const Integer sp = s / 10;
+        const bool upInside = lower <= 40 * sp;
+        const bool wpInside = 40 * sp + 40 <= upper;
+        if (upInside != wpInside) {
+            return result(sp + (wpInside ? 1 : 0), k + 1);
+        }
+    }
+
+    // Then either s or s + 1, or the closest of both
+    const bool uInside = lower <= 4 * s;
+    const bool wInside = 4 * s + 4 <= upper;
+    if (uInside != wInside) {
+        return result(s + (wInside ? 1 : 0), k);
+    }
+    const Integer middle = 4 * s + 2;
+    const bool roundUp = vb > middle || (vb == middle && (s & 1) != 0);
+    return result(s + (roundUp ? 1 : 0), k);
+}
+
+template<typename T>
+template<typename N>
+constexpr std::size_t ieee754toy::NumericalFormatter<T>::formatIEEE754(
+    typename IEEE754Traits<N>::IntegerType value) const
+{
+    using Traits = IEEE754Traits<N>;
+    using Integer = typename Traits::IntegerType;
+
+    std::array<T, maxLength> buffer{};
+    std::size_t length = 0;
+    const auto put = [&buffer, &length](char c) { buffer[length++] = static_cast<T>(c); };
+    const auto puts = [&put](const char* s) {
+        while (*s != '\0') {
+            put(*s++);
+        }
+    };
+
+    constexpr std::size_t integerBits = sizeof(Integer) * 8;
+    constexpr Integer exponentMask = (Integer{ 1 } << Traits::exponentBits) - 1;
+    const bool negative = (value >> (integerBits - 1)) != 0;
+    const Integer exponentPart = (value >> Traits::mantissaBits) & exponentMask;
+    const Integer fraction = value & ((Integer{ 1 } << Traits::mantissaBits) - 1);
+
+    if (exponentPart == exponentMask) {
+        // Non-finite numbers
+        puts(fraction != 0 ? "NaN" : negative ? "-Inf" : "Inf");
+    } else {
+        const auto [decimalNegative, mantissa, exponent] = toShortestDecimal<N>(value);
+        if (decimalNegative) {
+            put('-');
+        }
+
+        // Digits, and position n of the decimal point (the number being 0.digits * 10**n)
+        char digits[24]{};
+        int count = 0;
+        for (auto m = mantissa; count == 0 || m != 0; m /= 10) {
+            digits[count++] = static_cast<char>('0' + m % 10);
+        }
+        for (int i = 0; i < count / 2; i++) {
+            const char c = digits[i];
+            digits[i] = digits[count - 1 - i];
+            digits[count - 1 - i] = c;
+        }
+        const int n = count + exponent;
+
+        if (count <= n && n <= 21) {
+            // Integer: digits, and trailing zeros
+            for (int i = 0; i < count; i++) {
+                put(digits[i]);
+            }
+            for (int i = count; i < n; i++) {
+                put('0');
+            }
+        } else if (0 < n && n <= 21) {
+            // Decimal point inside digits
+            for (int i = 0; i < count; i++) {
+                if (i == n) {
+                    put('.');
+                }
+                put(digits[i]);
+            }
+        } else if (-6 < n && n <= 0) {
+            // Leading zeros
+            put('0');
+            put('.');
+            for (int i = n; i < 0; i++) {
+                put('0');
+            }
+            for (int i = 0; i < count; i++) {
+                put(digits[i]);
+            }
+        } else {
+            // Scientific notation
+            put(digits[0]);
+            if (count > 1) {
+                put('.');
+                for (int i = 1; i < count; i++) {
+                    put(digits[i]);
+                }
+            }
+            put('e');
+            put(n - 1 < 0 ? '-' : '+');
+            const int e = n - 1 < 0 ? 1 - n : n - 1;
+            if (e >= 100) {
+                put(static_cast<char>('0' + e / 100));
+            }
+            if (e >= 10) {
+                put(static_cast<char>('0' + e / 10 % 10));
+            }
+            put(static_cast<char>('0' + e % 10));
+        }
+    }
+
+    if (length > size()) {
+        return 0;
+    }
+    for (std::size_t i = 0; i < length; i++) {
+        operator[](i) = buffer[i];
+    }
+    return length;
+}
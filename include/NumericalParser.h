@@ -5,22 +5,95 @@
  */
 #pragma once
 
+#include "DecimalOutputs.h"
+#include "DigitScanner.h"
 #include "IEEE754.h"
+#include "Instrumentation.h"
+#include "NumberFormat.h"
 
+#include <bit>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <span>
+#include <system_error>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 
 namespace ieee754toy {
 
+/** Kinds of numbers returned by NumericalParser::parseNumber() **/
+enum class NumberKind : std::uint8_t
+{
+    /** A decimal number, to be converted to base 2 **/
+    Decimal,
+
+    /** A number already in base 2 (an hexadecimal float), normalized **/
+    Binary,
+
+    /** Infinity **/
+    Infinity,
+
+    /** Not a number **/
+    NaN,
+};
+
+/**
+ * Errors reported by NumericalParser::parse(), from the least to the most severe. The value is still meaningful
+ * up to Overflow (see ParseResult::valid()).
+ **/
+enum class ParseError : std::uint8_t
+{
+    /** No error: the value is exactly the parsed number **/
+    None,
+
+    /** The value is the correctly rounded parsed number, but is not exactly equal to it **/
+    Inexact,
+
+    /** A non-zero number underflowed to zero **/
+    Underflow,
+
+    /** A finite number overflowed to infinity (or to the saturated value of a scaled integer) **/
+    Overflow,
+
+    /** The explicit exponent does not fit in 64 bits, whatever the type (the value is then zero or infinity) **/
+    ExponentOverflow,
+
+    /** The string is empty **/
+    Empty,
+
+    /** A character can not be part of a number **/
+    InvalidCharacter,
+};
+
+/** The result of NumericalParser::parse(). **/
+template<typename N>
+struct ParseResult
+{
+    /** The parsed value (zero upon error, except for exponent overflows) **/
+    N value;
+
+    /**
+     * The parsed size upon success. Otherwise, the position of the error: the first character not being part of
+     * a number (ie. the end of the longest valid prefix), or the beginning of the overflowing exponent.
+     **/
+    std::size_t position;
+
+    /** The error code **/
+    ParseError error;
+
+    /** Is the value meaningful ? (it may still be rounded, or out of range) **/
+    constexpr bool valid() const { return error < ParseError::ExponentOverflow; }
+};
+
 /**
  * Numerical parsing helpers.
+ * @comment Format The number format policy (decimal point, digit separators, hexadecimal floats...), see
+ * DefaultNumberFormat.
  **/
-template<typename T>
+template<typename T, typename Format = DefaultNumberFormat>
 class NumericalParser : private std::span<T>
 {
 public:
@@ -35,24 +108,24 @@ public:
       : std::span<T>(std::forward<Ts>(args)...)
     {}
 
-    /* Extract the mantissa from a double string, and return the result as mantissa and exponent.
-     * Return a tuple of the parsed size (zero if error), and the exploded number.
-     */
-    template<typename N = double>
-    constexpr std::tuple<std::size_t, DecimalNumber<N>> parseMantissa() const;
-
-    /* Extract the exponent from a string.
-     * Return a tuple of the parsed size (zero if error), and the the exponent.
-     */
-    template<typename N = double>
-    constexpr std::tuple<std::size_t, typename DecimalNumber<N>::Exponent> parseExponent() const;
-
     /* Extract the mantissa and the exponent from a double string.
      * Return a tuple of the parsed size (zero if error), and the exploded number.
+     * If Prefix is true, the longest valid prefix is parsed: a misplaced sign or dot ends the number, an invalid
+     * exponent is not part of the number, and overflowing exponents are saturated.
+     * Special values and hexadecimal floats yield an error (see parseNumber()).
      */
-    template<typename N = double>
+    template<typename N = double, bool Prefix = false>
     constexpr inline std::tuple<std::size_t, DecimalNumber<N>> parseMantissaExponent() const;
 
+    /* Extract a number from a double string, in a single pass: sign, mantissa, exponent, special values ("Inf"
+     * with an optional sign, and "NaN", case insensitive), or hexadecimal floats if allowed by the format.
+     * Return a tuple of the parsed size (zero if error), the exploded number (a zero mantissa for special values,
+     * with the infinity sign, and an already normalized base-2 number for hexadecimal floats), and its kind.
+     * If Prefix is true, the longest valid prefix is parsed, as in parseMantissaExponent().
+     */
+    template<typename N = double, bool Prefix = false>
+    constexpr std::tuple<std::size_t, DecimalNumber<N>, NumberKind> parseNumber() const;
+
     /**
      * Convert the current string into a floating point value
      *
@@ -91,7 +164,172 @@ public:
     template<typename N = double>
     inline N toAnyDouble(bool& error) const;
 
+    /**
+     * Convert the longest valid prefix of the current string into a floating point value of any type.
+     * @param[out] value The parsed value, unmodified if no number could be parsed
+     * @param[out] range Set to @c true if a finite number overflowed to infinity, or a non-zero number underflowed
+     * to zero (the value is then infinity or zero)
+     * @return The parsed size, or zero if no number could be parsed.
+     * @comment Infinity and NaN are parsed, as in toAnyDouble().
+     */
+    template<typename N = double>
+    inline std::size_t toAnyDoublePrefix(N& value, bool& range) const;
+
+    /**
+     * Convert the current string into a floating point value of any type, reporting why and where the parsing
+     * failed, in a single pass (see ParseError).
+     * @return The parsed value, the parsed size or the position of the error, and the error code.
+     * @comment Infinity and NaN are parsed, as in toAnyDouble(). Hexadecimal floats are never reported as inexact.
+     * Decimal outputs (eg. ScaledInteger) are converted with parseDecimal().
+     */
+    template<typename N = double>
+    inline ParseResult<N> parse() const;
+
+    /**
+     * Convert the current string into a decimal output (see DecimalOutputs.h) straight from its base-10 form,
+     * without going through binary floating point, reporting errors as parse() does.
+     * @return The parsed value, the parsed size or the position of the error, and the error code.
+     * @comment V The decimal output type (ScaledInteger or Decimal64)
+     * @comment Infinity and NaN are only parsed into Decimal64, and hexadecimal floats are invalid characters.
+     */
+    template<typename V>
+    constexpr ParseResult<V> parseDecimal() const;
+
+    /**
+     * Convert a decimal number parsed by parseNumber() to base 2, correctly rounded whatever its number of digits.
+     * The parsed mantissa only holds the leading digits, and is rounded using the next one: when this may change
+     * the rounding (see IEEE754Number::convertTwobaseBounded()), all the digits are scanned again, and compared
+     * with a half-way point using big integers (see IEEE754Number::roundDigits()).
+     * @param number The parsed number
+     * @param parsed The parsed size
+     * @return The base-2 number.
+     */
+    template<typename N = double>
+    constexpr IEEE754Number<N, 2> convertTwobase(const DecimalNumber<N>& number, std::size_t parsed) const;
+
+private:
+    /** Convert a parsed number into a floating point value. **/
+    template<typename N>
+    inline N convert(const DecimalNumber<N>& number, std::size_t parsed) const;
+
+    /** Convert a parsed number of any kind into a floating point value. **/
+    template<typename N>
+    inline N toValue(const DecimalNumber<N>& number, NumberKind kind, std::size_t parsed) const;
+
+    /**
+     * The convertTwobase() slow path: scan the significant digits again, and round them (see
+     * IEEE754Number::roundDigits()).
+     **/
+    template<typename N, typename Digits>
+    constexpr IEEE754Number<N, 2> convertTwobaseDigits(const DecimalNumber<N>& number, std::size_t parsed) const;
+
+    /**
+     * Scan the significant digits of a parsed decimal number again, leading zeros excluded.
+     * @param parsed The parsed size
+     * @return A tuple of the digits (at most IEEE754Number::maxDigits of them), the ten-exponent of the last one,
+     * and whether non-zero digits were dropped after them.
+     * @comment Digits The big integer type accumulating the digits, wide enough for the parsed size or for
+     * IEEE754Number::maxDigits digits
+     **/
+    template<typename N, typename Digits>
+    constexpr std::tuple<Digits, typename DecimalNumber<N>::Exponent, bool> parseSignificantDigits(
+        std::size_t parsed) const;
+
+    /**
+     * Return the truncated mantissa of a parsed decimal number, and the digits dropped after it (see
+     * divideRounded()), by scanning the digits again: the parsed mantissa is rounded using the next digit when it
+     * can not hold all of them.
+     **/
+    template<typename N>
+    constexpr std::tuple<typename DecimalNumber<N>::Mantissa, DecimalTail> truncatedMantissa(
+        const DecimalNumber<N>& number, std::size_t parsed) const;
+
+    /** Is the conversion of a parsed decimal number to a floating point value exact ? **/
+    template<typename N>
+    inline bool exactlyConverted(const DecimalNumber<N>& number, N value, std::size_t parsed) const;
+
+    /** Is a parsed number zero or infinite, while being a non-zero finite number ? **/
+    template<typename N>
+    static constexpr bool outOfRange(const DecimalNumber<N>& number, N value);
+
+    /** Return the position of the explicit exponent mark (eg. 'e') of a parsed number, or parsed if none. **/
+    constexpr std::size_t exponentMark(std::size_t parsed, NumberKind kind) const;
+
+    /** Does the explicit exponent of a number parsed as a prefix overflow ? (it was then saturated) **/
+    constexpr bool exponentOverflow(std::size_t parsed, std::size_t mark) const;
+
+    /* Extract an hexadecimal float, starting at the "0x" prefix position, the sign being already parsed.
+     * Return a tuple of the parsed size (zero if error), the exploded base-2 number, and its kind.
+     */
+    template<typename N, bool Prefix>
+    constexpr std::tuple<std::size_t, DecimalNumber<N>, NumberKind> parseHexNumber(std::size_t start,
+                                                                                bool negative) const;
+
+    /* Extract a fixed-point number (see FixedFormat): exactly Format::integerDigits digits, the decimal point,
+     * and Format::fractionDigits digits.
+     * Return a tuple of the parsed size (zero if error), the exploded number, and its kind. If Prefix is true, the
+     * characters following the number are ignored.
+     */
+    template<typename N, bool Prefix>
+    constexpr std::tuple<std::size_t, DecimalNumber<N>, NumberKind> parseFixedNumber() const;
+
+    /** Can the exact fast path convert every number of the format ? (only for fixed-point formats) **/
+    template<typename N>
+    static constexpr bool fixedExactConversion();
+
+    /* Extract an explicit exponent (eg. "+12"), starting at position i.
+     * Return a tuple of the parsed size (zero if error), and the 64-bit exponent, whatever the type of the number
+     * (see saturatedExponent()). At least one digit is needed, and overflowing exponents are saturated if Prefix
+     * is true.
+     */
+    template<bool Prefix>
+    constexpr std::tuple<std::size_t, std::int64_t> parseExponent(std::size_t i) const;
+
+    /**
+     * Narrow an exponent accumulated in a wider type (ie. the exponent of the digits, plus the explicit one),
+     * saturating: the number is then either zero or infinite anyway.
+     **/
+    template<typename N>
+    static constexpr typename DecimalNumber<N>::Exponent saturatedExponent(std::int64_t exponent);
+
+    /**
+     * Accumulate a run of digits into the mantissa, starting at position i, and return the position of the first
+     * non-digit character.
+     * @param[in,out] number The number being built
+     * @param[in,out] exponent The ten-exponent of the number, increased for each digit that could not fit (it is
+     * only narrowed into the number once complete, see saturatedExponent())
+     * @param[in,out] stopMantissa Set when the mantissa is full (the following digits are then rounded away)
+     * @param[out] digits Set if at least one digit was seen
+     * @comment Fraction If true, the exponent is decreased for each digit.
+     **/
+    template<typename N, bool Fraction>
+    constexpr std::size_t parseDigits(std::size_t i, DecimalNumber<N>& number, std::int64_t& exponent,
+                                      bool& stopMantissa, bool& digits) const;
+
+    /**
+     * Accumulate a digit into a mantissa which may overflow: once full, the mantissa is rounded (half to even),
+     * and the following digits only increase the exponent.
+     * @param[in,out] stopMantissa Set when the mantissa is full
+     **/
+    template<typename N>
+    static constexpr void addOverflowingDigit(DecimalNumber<N>& number, std::int64_t& exponent, bool& stopMantissa,
+                                              unsigned digit);
+
+    /**
+     * The parseDigits() fast path, scanning runs of sixteen or eight digits at once (as long as the mantissa can
+     * not overflow), and returning the position of the first character that was not scanned.
+     * @warning Only for multipleDigitsScanning character types, outside constexpr context.
+     **/
+    template<typename N, bool Fraction>
+    inline std::size_t scanDigits(std::size_t i, DecimalNumber<N>& number, std::int64_t& exponent,
+                                  bool& digits) const;
+
 private:
+    /** Can we scan several digits at once ? (16-bit and 32-bit code units are narrowed, see loadEightUnits()) **/
+    static constexpr bool multipleDigitsScanning = std::is_same_v<std::remove_cv_t<T>, char> ||
+                                                   std::is_same_v<std::remove_cv_t<T>, char16_t> ||
+                                                   std::is_same_v<std::remove_cv_t<T>, char32_t>;
+
     using std::span<T>::size;
     using std::span<T>::data;
     using std::span<T>::end;
@@ -100,17 +338,32 @@ private:
     /* Convert to lowercase. */
     inline static constexpr T toLower(const T c) { return c >= 'A' && c <= 'Z' ? (c + 'a' - 'A') : c; }
 
-    /** Compare to a 8-bit ascii string, case insensitive. **/
+    /** Return the character at position i, or zero beyond the end. **/
+    inline constexpr auto at(const std::size_t i) const { return i < size() ? operator[](i) : 0; }
+
+    /** Is the character a decimal digit ? **/
+    inline static constexpr bool isDigit(const unsigned c) { return c - '0' < 10; }
+
+    /** Return the value of an hexadecimal digit, or 16 if the character is not an hexadecimal digit. **/
+    inline static constexpr unsigned hexDigit(const unsigned c)
+    {
+        return c - '0' < 10 ? c - '0' : (c | 0x20) - 'a' < 6 ? (c | 0x20) - 'a' + 10 : 16;
+    }
+
+    /** Is the character at position i a sign or decimal point, which can not follow a number ? **/
+    inline constexpr bool misplaced(const std::size_t i) const
+    {
+        const auto c = at(i);
+        return c == '+' || c == '-' || c == Format::decimalPoint;
+    }
+
+    /** Is the 8-bit lowercase ascii string at position i, case insensitive ? **/
     template<std::size_t N>
-    inline bool operator==(const char (&str)[N]) const
+    inline constexpr bool matches(const std::size_t i, const char (&str)[N]) const
     {
         static_assert(N != 0);
-        constexpr std::size_t Length = N - 1;
-        if (size() != Length) {
-            return false;
-        }
-        for (std::size_t i = 0; i < Length; i++) {
-            if (toLower(operator[](i)) != toLower(str[i])) {
+        for (std::size_t j = 0; j + 1 < N; j++) {
+            if (toLower(at(i + j)) != static_cast<T>(str[j])) {
                 return false;
             }
         }
@@ -124,29 +377,38 @@ explicit NumericalParser(Type* begin, std::size_t size) -> NumericalParser<Type>
 template<typename Type>
 explicit NumericalParser(Type* begin, Type* end) -> NumericalParser<Type>;
 
-/* Extract the mantissa from a double string, and return the result as mantissa and exponent.
+/* Extract the mantissa and the exponent from a double string.
  * Return a tuple of the parsed size (zero if error), the sign, the mantissa, and the exponent.
  */
-template<typename T>
-template<typename N>
-constexpr std::tuple<std::size_t, typename NumericalParser<T>::template DecimalNumber<N>>
-NumericalParser<T>::parseMantissa() const
+template<typename T, typename Format>
+template<typename N, bool Prefix>
+constexpr inline std::tuple<std::size_t, typename NumericalParser<T, Format>::template DecimalNumber<N>>
+NumericalParser<T, Format>::parseMantissaExponent() const
 {
-    using Mantissa = typename DecimalNumber<N>::Mantissa;
-
-    constexpr const auto error = std::make_tuple(std::size_t(0), DecimalNumber<N>(false, 0, 0));
-
-    // Mantissa
-    typename DecimalNumber<N>::Mantissa mantissa = 0;
+    const auto [parsed, number, kind] = parseNumber<N, Prefix>();
+    if (kind != NumberKind::Decimal) {
+        return std::make_tuple(std::size_t(0), DecimalNumber<N>(false, 0, 0));
+    }
+    return std::make_tuple(parsed, number);
+}
 
-    // Power-of-two-exponent
-    typename DecimalNumber<N>::Exponent exponent = 0;
+/* Extract a number from a double string, in a single pass.
+ * Return a tuple of the parsed size (zero if error), the exploded number, and its kind.
+ */
+template<typename T, typename Format>
+template<typename N, bool Prefix>
+constexpr std::tuple<std::size_t, typename NumericalParser<T, Format>::template DecimalNumber<N>, NumberKind>
+NumericalParser<T, Format>::parseNumber() const
+{
+    constexpr const auto error =
+        std::make_tuple(std::size_t(0), DecimalNumber<N>(false, 0, 0), NumberKind::Decimal);
 
-    // If true, mantissa is negative
-    bool negative = false;
+    if constexpr (Format::fixedPoint) {
+        return parseFixedNumber<N, Prefix>();
+    }
 
-    // If true, we are beyond a comma
-    bool stopExponent = false;
+    // The number being built
+    DecimalNumber<N> number(false, 0, 0);
 
     // If true, mantissa is already too large
     bool stopMantissa = false;
@@ -154,210 +416,828 @@ NumericalParser<T>::parseMantissa() const
     // Digits seen for mantissa
     bool digits = false;
 
-    for (std::size_t i = 0; i <= size(); i++) {
-        const auto c = i < size() ? operator[](i) : 0;
-        switch (c) {
-            case '0':
-            case '1':
-            case '2':
-            case '3':
-            case '4':
-            case '5':
-            case '6':
-            case '7':
-            case '8':
-            case '9': {
-                // If true, mantissa was too large on previous round
-                bool justStoppedMantissa = false;
-
-                // New digit
-                const unsigned digit = c - '0';
-                digits = true;
-
-                // Handle overflows (mul by 10 and add at most 9)
-                if (not stopMantissa and mantissa >= std::numeric_limits<Mantissa>::max() / 10) {
-                    if (mantissa > std::numeric_limits<Mantissa>::max() / 10 ||
-                        (mantissa == std::numeric_limits<Mantissa>::max() / 10 &&
-                         mantissa > (std::numeric_limits<Mantissa>::max() - digit) / 10)) {
-                        justStoppedMantissa = true;
-                        stopMantissa = true;
-                    }
-                }
+    // The ten-exponent, only narrowed once the explicit exponent is added, so that the exponent of a very long
+    // mantissa can still be compensated
+    std::int64_t exponent = 0;
 
-                // If not overflowing, accumulate
-                if (not stopMantissa) {
-                    mantissa *= 10;
-                    mantissa += digit;
-                } else {
-                    // Simply increase exponent
-                    exponent++;
+    // Optional sign
+    std::size_t i = 0;
+    number.negative = at(0) == '-';
+    i += number.negative || at(0) == '+' ? 1 : 0;
+    const std::size_t start = i;
 
-                    // We just stopped the mantissa; we need to handle round half to even
-                    if (justStoppedMantissa) {
-                        // Round to upper value!
-                        if (digit > 5 || (digit == 5 && (mantissa & 1) != 0)) {
-                            // Take care of overflows
-                            if (++mantissa == 0) {
-                                // Decrease ten exponent; take max/10
-                                mantissa = std::numeric_limits<Mantissa>::max() / 10;
-                                exponent++;
-                                // Check if the last digit rounded to upper value increases mantissa
-                                // This is the case for 64-bit, for example: last digit of 18446744073709551615 is
-                                // 5, and 5 rounded to ten is always 10, as the maximum is always even (pwoer of
-                                // two minus one).
-                                if constexpr (std::numeric_limits<Mantissa>::max() % 10 + 1 >= 5) {
-                                    mantissa++;
-                                }
-                            }
-                        }
-                    }
-                }
+    // Hexadecimal float
+    if constexpr (Format::hexFloats) {
+        if (at(i) == '0' && (at(i + 1) == 'x' || at(i + 1) == 'X')) {
+            return parseHexNumber<N, Prefix>(i, number.negative);
+        }
+    }
 
-                // If beyond comma, decrease exponent
-                if (stopExponent) {
-                    exponent--;
-                }
-            } break;
-            case '+':
-            case '-':
-                if (i != 0) {
-                    return error;
-                }
-                negative = c == '-';
-                break;
-            case '.':
-                if (stopExponent) {
-                    return error;
-                }
-                stopExponent = true;
-                break;
-            default:
-                if (not digits) {
-                    return error;
-                }
-                return { i, { negative, mantissa, exponent } };
+    // Mantissa, with an optional decimal point
+    std::uint64_t mantissaStart = instrumentationStart();
+    std::size_t mantissaDigits = 0;
+    i = parseDigits<N, false>(i, number, exponent, stopMantissa, digits);
+    if (at(i) == Format::decimalPoint) {
+        const std::size_t point = i;
+        const bool integral = digits;
+        i = parseDigits<N, true>(i + 1, number, exponent, stopMantissa, digits);
+        mantissaDigits = i - start - 1;
+
+        // Leading and trailing decimal points, if disallowed by the format (a trailing point simply ends a prefix)
+        if (not Format::leadingDot && not integral) {
+            return error;
+        } else if (not Format::trailingDot && i == point + 1) {
+            if constexpr (not Prefix) {
+                return error;
+            }
+            i = point;
+        }
+    } else {
+        mantissaDigits = i - start;
+    }
+    instrumentStage(InstrumentedStage::Mantissa, mantissaStart);
+
+    // No digits: this can still be a special value (just after the sign), and is otherwise an error
+    if (not digits) [[unlikely]] {
+        if (i == start && matches(i, "inf")) {
+            return std::make_tuple(i + 3, DecimalNumber<N>(number.negative, 0, 0), NumberKind::Infinity);
+        } else if (i == 0 && matches(i, "nan")) {
+            return std::make_tuple(std::size_t(3), DecimalNumber<N>(false, 0, 0), NumberKind::NaN);
+        }
+        return error;
+    }
+
+    // Optional explicit exponent
+    if (const auto c = at(i); c == 'e' || c == 'E') {
+        std::uint64_t exponentStart = instrumentationStart();
+        const auto [parsed, explicitExponent] = parseExponent<Prefix>(i + 1);
+        instrumentStage(InstrumentedStage::Exponent, exponentStart);
+        if (parsed != 0) {
+            i += 1 + parsed;
+            exponent += explicitExponent;
+        } else if constexpr (not Prefix) {
+            // At least one exponent digit is needed, unless the exponent is not part of the prefix
+            return error;
         }
     }
-    assert(!"Unreachable code");
+
+    // A misplaced sign or decimal point is an error, unless parsing a prefix, where it simply ends the number
+    if constexpr (not Prefix) {
+        if (misplaced(i)) {
+            return error;
+        }
+    }
+
+    number.exponent = saturatedExponent<N>(exponent);
+    instrumentNumber(mantissaDigits, static_cast<int>(number.exponent));
+    return std::make_tuple(i, number, NumberKind::Decimal);
 }
 
-/* Extract the exponent from a string.
- * Return a tuple of the parsed size (zero if error), and the the exponent.
+/* Extract an hexadecimal float from a double string, starting at the "0x" prefix position.
+ * Return a tuple of the parsed size (zero if error), the exploded number, and its kind.
  */
-template<typename T>
-template<typename N>
-constexpr std::tuple<std::size_t, typename NumericalParser<T>::template DecimalNumber<N>::Exponent>
-NumericalParser<T>::parseExponent() const
+template<typename T, typename Format>
+template<typename N, bool Prefix>
+constexpr std::tuple<std::size_t, typename NumericalParser<T, Format>::template DecimalNumber<N>, NumberKind>
+NumericalParser<T, Format>::parseHexNumber(const std::size_t start, const bool negative) const
 {
+    using Mantissa = typename DecimalNumber<N>::Mantissa;
+    using ReducedMantissa = typename DecimalNumber<N>::ReducedMantissa;
+
+    constexpr const auto error =
+        std::make_tuple(std::size_t(0), DecimalNumber<N>(false, 0, 0), NumberKind::Decimal);
+
+    // Keep room for one more digit, and for the sticky bit
+    constexpr Mantissa limit = Mantissa{ 1 } << (std::numeric_limits<Mantissa>::digits - 5);
+
+    // Mantissa, two-exponent (narrowed once complete, see saturatedExponent()), and whether non-zero digits were
+    // dropped
+    Mantissa mantissa = 0;
+    std::int64_t exponent = 0;
+    bool sticky = false;
+
+    // Digits seen for mantissa
+    bool digits = false;
+
+    // Accumulate hexadecimal digits, fraction digits decreasing the exponent
+    std::size_t i = start + 2;
+    const auto accumulate = [&](const bool fraction) {
+        for (unsigned digit; (digit = hexDigit(at(i))) < 16; i++) {
+            digits = true;
+            if (mantissa < limit) {
+                mantissa = mantissa * 16 + digit;
+                exponent -= fraction ? 4 : 0;
+            } else {
+                sticky = sticky || digit != 0;
+                exponent += fraction ? 0 : 4;
+            }
+        }
+    };
+
+    // Mantissa, with an optional decimal point
+    accumulate(false);
+    if (at(i) == Format::decimalPoint) {
+        const std::size_t point = i;
+        const bool integral = digits;
+        i++;
+        accumulate(true);
+
+        // Leading and trailing decimal points, if disallowed by the format
+        if (not Format::leadingDot && not integral) {
+            return error;
+        } else if (not Format::trailingDot && i == point + 1) {
+            if constexpr (not Prefix) {
+                return error;
+            }
+            i = point;
+        }
+    }
+
+    // No digits: when parsing a prefix, this is the number zero followed by an unrelated 'x'
+    if (not digits) [[unlikely]] {
+        if constexpr (Prefix) {
+            return std::make_tuple(start + 1, DecimalNumber<N>(negative, 0, 0), NumberKind::Decimal);
+        }
+        return error;
+    }
+
+    // Optional binary exponent
+    if (const auto c = at(i); c == 'p' || c == 'P') {
+        const auto [parsed, binaryExponent] = parseExponent<Prefix>(i + 1);
+        if (parsed != 0) {
+            i += 1 + parsed;
+            exponent += binaryExponent;
+        } else if constexpr (not Prefix) {
+            return error;
+        }
+    }
+
+    if constexpr (not Prefix) {
+        if (misplaced(i)) {
+            return error;
+        }
+    }
+
+    // Round once, the sticky bit being below the rounding bit
+    const auto binary =
+        DecimalNumber<N>::normalize(negative, (ReducedMantissa{ mantissa } << 1) | (sticky ? 1 : 0),
+                                    saturatedExponent<N>(exponent - 1));
+    return std::make_tuple(i, DecimalNumber<N>(negative, binary.mantissa, binary.exponent), NumberKind::Binary);
+}
+
+/* Extract a fixed-point number.
+ * Return a tuple of the parsed size (zero if error), the exploded number, and its kind.
+ */
+template<typename T, typename Format>
+template<typename N, bool Prefix>
+constexpr std::tuple<std::size_t, typename NumericalParser<T, Format>::template DecimalNumber<N>, NumberKind>
+NumericalParser<T, Format>::parseFixedNumber() const
+{
+    using Mantissa = typename DecimalNumber<N>::Mantissa;
     using Exponent = typename DecimalNumber<N>::Exponent;
+    constexpr std::size_t integerDigits = Format::integerDigits;
+    constexpr std::size_t fractionDigits = Format::fractionDigits;
+    constexpr std::size_t length = integerDigits + (fractionDigits != 0 ? 1 : 0) + fractionDigits;
+    static_assert(integerDigits + fractionDigits <= std::numeric_limits<Mantissa>::digits10,
+                  "The mantissa must hold all the digits of the format");
+
+    constexpr const auto error =
+        std::make_tuple(std::size_t(0), DecimalNumber<N>(false, 0, 0), NumberKind::Decimal);
+
+    if (Prefix ? size() < length : size() != length) {
+        return error;
+    }
+
+    // A single multiply-add chain, fully unrolled: non-digits are only checked once, at the end
+    std::uint64_t mantissaStart = instrumentationStart();
+    Mantissa mantissa = 0;
+    unsigned invalid = 0;
+    const auto accumulate = [&]<std::size_t... I>(const std::size_t offset, std::index_sequence<I...>) {
+        // Unused for empty sequences (ie. formats without integral or fractional digits)
+        [[maybe_unused]] const auto add = [&](const std::size_t i) {
+            const auto digit = static_cast<unsigned>(operator[](i) - '0');
+            invalid |= digit >= 10 ? 1 : 0;
+            mantissa = static_cast<Mantissa>(mantissa * 10 + digit);
+        };
+        (add(offset + I), ...);
+    };
+    accumulate(0, std::make_index_sequence<integerDigits>());
+    accumulate(integerDigits + 1, std::make_index_sequence<fractionDigits>());
+    if (invalid != 0 || (fractionDigits != 0 && operator[](integerDigits) != Format::decimalPoint)) {
+        return error;
+    }
+    instrumentStage(InstrumentedStage::Mantissa, mantissaStart);
+
+    constexpr auto exponent = static_cast<Exponent>(-static_cast<int>(fractionDigits));
+    instrumentNumber(integerDigits + fractionDigits, exponent);
+    return std::make_tuple(length, DecimalNumber<N>(false, mantissa, exponent), NumberKind::Decimal);
+}
+
+template<typename T, typename Format>
+template<typename N>
+constexpr bool NumericalParser<T, Format>::fixedExactConversion()
+{
+    if constexpr (Format::fixedPoint) {
+        // The largest number of the format
+        using Mantissa = typename DecimalNumber<N>::Mantissa;
+        using Exponent = typename DecimalNumber<N>::Exponent;
+        constexpr Mantissa largest = power(Mantissa{ 10 }, Format::integerDigits + Format::fractionDigits) - 1;
+        constexpr auto exponent = static_cast<Exponent>(-static_cast<int>(Format::fractionDigits));
+        return DecimalNumber<N>(false, largest, exponent).exactConversion();
+    }
+    return false;
+}
+
+/* Extract an exponent (eg. "+12"), starting at position i.
+ * Return a tuple of the parsed size (zero if error), and the exponent.
+ */
+template<typename T, typename Format>
+template<bool Prefix>
+constexpr std::tuple<std::size_t, std::int64_t>
+NumericalParser<T, Format>::parseExponent(const std::size_t i) const
+{
+    using Exponent = std::int64_t;
 
     constexpr const auto error = std::make_tuple(std::size_t(0), Exponent(0));
 
-    // Power-of-two-exponent
+    // Optional sign
+    std::size_t j = i;
+    const bool negative = at(j) == '-';
+    j += negative || at(j) == '+' ? 1 : 0;
+    const std::size_t first = j;
+
+    // Exponents beyond half the range overflow, so that the mantissa exponent can still be added to any of them
+    constexpr Exponent largest = std::numeric_limits<Exponent>::max() / 2;
+
     Exponent exponent = 0;
+    for (unsigned digit; (digit = static_cast<unsigned>(at(j) - '0')) < 10; j++) {
+        // Handle overflows. When parsing a prefix, saturate: the number is either zero or infinite anyway.
+        if (exponent > static_cast<Exponent>((largest - digit) / 10)) {
+            if constexpr (not Prefix) {
+                return error;
+            }
+            exponent = largest;
+        } else {
+            exponent = static_cast<Exponent>(exponent * 10 + digit);
+        }
+    }
 
-    // If true, mantissa is negative
-    bool negative = false;
-
-    for (std::size_t i = 0; i <= size(); i++) {
-        const auto c = i < size() ? operator[](i) : 0;
-        switch (c) {
-            case '0':
-            case '1':
-            case '2':
-            case '3':
-            case '4':
-            case '5':
-            case '6':
-            case '7':
-            case '8':
-            case '9': {
-                const auto digit = static_cast<int>(c - '0');
-
-                // Handle overflows
-                if (exponent >= std::numeric_limits<Exponent>::max() / 10 - 1) {
-                    if (exponent > std::numeric_limits<Exponent>::max() / 10 ||
-                        exponent * 10 > std::numeric_limits<Exponent>::max() - digit) {
-                        return error;
-                    }
+    // At least one digit is needed
+    if (j == first) {
+        return error;
+    }
+
+    return std::make_tuple(j - i, static_cast<Exponent>(not negative ? exponent : -exponent));
+}
+
+template<typename T, typename Format>
+template<typename N>
+constexpr typename NumericalParser<T, Format>::template DecimalNumber<N>::Exponent
+NumericalParser<T, Format>::saturatedExponent(const std::int64_t exponent)
+{
+    using Exponent = typename DecimalNumber<N>::Exponent;
+    constexpr std::int64_t saturated = std::numeric_limits<Exponent>::max() / 2;
+    return static_cast<Exponent>(exponent > saturated    ? saturated
+                                 : exponent < -saturated ? -saturated
+                                                         : exponent);
+}
+
+template<typename T, typename Format>
+template<typename N, bool Fraction>
+constexpr std::size_t NumericalParser<T, Format>::parseDigits(std::size_t i,
+                                                              DecimalNumber<N>& number,
+                                                              std::int64_t& exponent,
+                                                              bool& stopMantissa,
+                                                              bool& digits) const
+{
+    using Mantissa = typename DecimalNumber<N>::Mantissa;
+
+    // Fast path: scan several digits at once, when there is room for at least eight of them
+    if constexpr (multipleDigitsScanning) {
+        if (not std::is_constant_evaluated()) {
+            if (size() - i >= 8) {
+                i = scanDigits<N, Fraction>(i, number, exponent, digits);
+            }
+        }
+    }
+
+    for (;; i++) {
+        const auto digit = static_cast<unsigned>(at(i) - '0');
+        if (digit >= 10) {
+            // Skip digit separators between two digits
+            if constexpr (not Format::digitSeparators.empty()) {
+                if (isDigitSeparator<Format>(at(i)) && isDigit(at(i - 1)) && isDigit(at(i + 1))) {
+                    continue;
                 }
+            }
+            break;
+        }
+        digits = true;
+
+        // Accumulate, unless the mantissa may overflow (mul by 10 and add at most 9)
+        if (number.mantissa < std::numeric_limits<Mantissa>::max() / 10) [[likely]] {
+            number.mantissa = number.mantissa * 10 + digit;
+        } else {
+            addOverflowingDigit<N>(number, exponent, stopMantissa, digit);
+        }
+
+        // If beyond comma, decrease exponent
+        if constexpr (Fraction) {
+            exponent--;
+        }
+    }
+
+    return i;
+}
 
-                // If not overflowing, accumulate
-                exponent *= 10;
-                exponent += digit;
-            } break;
-            case '+':
-            case '-':
-                if (i != 0) {
-                    return error;
+template<typename T, typename Format>
+template<typename N>
+constexpr void NumericalParser<T, Format>::addOverflowingDigit(DecimalNumber<N>& number,
+                                                               std::int64_t& exponent,
+                                                               bool& stopMantissa,
+                                                               const unsigned digit)
+{
+    using Mantissa = typename DecimalNumber<N>::Mantissa;
+    auto& mantissa = number.mantissa;
+
+    // If true, mantissa was too large on previous round
+    bool justStoppedMantissa = false;
+
+    // Handle overflows (mul by 10 and add at most 9)
+    if (not stopMantissa and mantissa >= std::numeric_limits<Mantissa>::max() / 10) {
+        if (mantissa > std::numeric_limits<Mantissa>::max() / 10 ||
+            (mantissa == std::numeric_limits<Mantissa>::max() / 10 &&
+             mantissa > (std::numeric_limits<Mantissa>::max() - digit) / 10)) {
+            justStoppedMantissa = true;
+            stopMantissa = true;
+        }
+    }
+
+    // If not overflowing, accumulate
+    if (not stopMantissa) {
+        mantissa *= 10;
+        mantissa += digit;
+    } else {
+        // Simply increase exponent
+        exponent++;
+
+        // We just stopped the mantissa; we need to handle round half to even
+        if (justStoppedMantissa) {
+            // Round to upper value!
+            if (digit > 5 || (digit == 5 && (mantissa & 1) != 0)) {
+                // Take care of overflows
+                if (++mantissa == 0) {
+                    // Decrease ten exponent; take max/10
+                    mantissa = std::numeric_limits<Mantissa>::max() / 10;
+                    exponent++;
+                    // Check if the last digit rounded to upper value increases mantissa
+                    // This is the case for 64-bit, for example: last digit of 18446744073709551615 is
+                    // 5, and 5 rounded to ten is always 10, as the maximum is always even (pwoer of
+                    // two minus one).
+                    if constexpr (std::numeric_limits<Mantissa>::max() % 10 + 1 >= 5) {
+                        mantissa++;
+                    }
                 }
-                negative = c == '-';
-                break;
-            default:
-                return std::make_tuple(i, not negative ? exponent : -exponent);
+            }
         }
     }
-    assert(!"Unreachable code");
 }
 
-/* Extract the mantissa and the exponent from a double string.
- * Return a tuple of the parsed size (zero if error), the sign, the mantissa, and the exponent.
- */
-template<typename T>
+template<typename T, typename Format>
+template<typename N, bool Fraction>
+inline std::size_t NumericalParser<T, Format>::scanDigits(std::size_t i,
+                                                          DecimalNumber<N>& number,
+                                                          std::int64_t& exponent,
+                                                          bool& digits) const
+{
+    using Mantissa = typename DecimalNumber<N>::Mantissa;
+    auto& mantissa = number.mantissa;
+
+    const std::remove_cv_t<T>* const s = data();
+
+    // Sixteen digits
+    if constexpr (sizeof(Mantissa) >= sizeof(std::uint64_t)) {
+        constexpr Mantissa sixteenDigits = 10000000000000000;
+        std::uint64_t value;
+        if (mantissa <= (std::numeric_limits<Mantissa>::max() - (sixteenDigits - 1)) / sixteenDigits &&
+            i + 16 <= size() && parseSixteenDigits<Format::simdLevel>(s + i, value)) {
+            mantissa = mantissa * sixteenDigits + value;
+            exponent -= Fraction ? 16 : 0;
+            digits = true;
+            i += 16;
+        }
+    }
+
+    // Eight digits
+    constexpr Mantissa eightDigits = 100000000;
+    while (mantissa <= (std::numeric_limits<Mantissa>::max() - (eightDigits - 1)) / eightDigits &&
+           i + 8 <= size()) {
+        const std::uint64_t chunk = loadEightUnits(s + i);
+        if (not isEightDigits(chunk)) {
+            break;
+        }
+        mantissa = mantissa * eightDigits + parseEightDigits(chunk);
+        exponent -= Fraction ? 8 : 0;
+        digits = true;
+        i += 8;
+    }
+
+    return i;
+}
+
+template<typename T, typename Format>
+template<typename N>
+inline N NumericalParser<T, Format>::toAnyDouble(bool& error) const
+{
+    if constexpr (isDecimalOutput<N>) {
+        // Saturated scaled integers are errors, as non-finite values
+        const auto result = parseDecimal<N>();
+        error = not result.valid() || (result.error == ParseError::Overflow && not std::is_same_v<N, Decimal64>);
+        return not error ? result.value : N{};
+    } else {
+        const auto [parsed, number, kind] = parseNumber<N>();
+        error = parsed != size();
+        return not error ? toValue(number, kind, parsed) : N{};
+    }
+}
+
+template<typename T, typename Format>
 template<typename N>
-constexpr inline std::tuple<std::size_t, typename NumericalParser<T>::template DecimalNumber<N>>
-NumericalParser<T>::parseMantissaExponent() const
+inline N NumericalParser<T, Format>::convert(const DecimalNumber<N>& number, const std::size_t parsed) const
 {
-    constexpr const auto error = std::make_tuple(std::size_t(0), DecimalNumber<N>(false, 0, 0));
+    // Exact fast path: one floating-point operation, correctly rounded (always, for some fixed-point formats)
+    std::uint64_t conversionStart = instrumentationStart();
+    if (fixedExactConversion<N>() || number.exactConversion()) {
+        const N value = number.toFloatExact();
+        instrumentStage(InstrumentedStage::Conversion, conversionStart);
+        instrumentConversion(ConversionPath::Exact);
+        return value;
+    }
 
-    // Parse mantissa. This will also provide a first exponent (for very large numbers typically)
-    auto result = parseMantissa<N>();
-    auto& [parsed, number] = result;
-    if (parsed == 0) {
-        return error;
+    const auto binary = convertTwobase(number, parsed);
+    std::uint64_t normalizationStart = instrumentationStart();
+    instrumentStage(InstrumentedStage::Conversion, conversionStart);
+    const N value = binary.toFloat();
+    instrumentStage(InstrumentedStage::Normalization, normalizationStart);
+    return value;
+}
+
+template<typename T, typename Format>
+template<typename N>
+constexpr IEEE754Number<N, 2> NumericalParser<T, Format>::convertTwobase(const DecimalNumber<N>& number,
+                                                                         const std::size_t parsed) const
+{
+    const auto [converted, binary] = number.convertTwobaseBounded();
+    if (converted) [[likely]] {
+        instrumentConversion(ConversionPath::Table);
+        return binary;
     }
 
-    // Check for an optional explicit exponent
-    switch (parsed < size() ? operator[](parsed) : 0) {
-        case 'e':
-        case 'E': {
-            auto& [negative, mantissa, exponent] = number;
-            parsed++;
-            const auto [parsedExponent, explicitExponent] =
-                NumericalParser<T>(data() + parsed, size() - parsed).parseExponent<N>();
-            if (parsedExponent == 0) {
-                return error;
+    // Use the smallest big integers for the usual lengths (nineteen digits per limb)
+    const IEEE754Number<N, 2> rounded =
+        parsed <= 7 * 19 ? convertTwobaseDigits<N, BigInteger<8>>(number, parsed)
+                         : convertTwobaseDigits<N, typename DecimalNumber<N>::DigitsInteger>(number, parsed);
+    instrumentConversion(ConversionPath::Digits);
+    return rounded;
+}
+
+template<typename T, typename Format>
+template<typename N, typename Digits>
+constexpr IEEE754Number<N, 2> NumericalParser<T, Format>::convertTwobaseDigits(const DecimalNumber<N>& number,
+                                                                               const std::size_t parsed) const
+{
+    const auto [digits, exponent, truncated] = parseSignificantDigits<N, Digits>(parsed);
+
+    // The real value is strictly between (mantissa - 1) · 10^exponent and (mantissa + 1) · 10^exponent (see
+    // IEEE754Number::convertTwobaseBounded()): it rounds either as the lower bound, or to the following number
+    const DecimalNumber<N> lowerBound(number.negative, number.mantissa - 1, number.exponent);
+    return DecimalNumber<N>::roundDigits(lowerBound.convertTwobaseBig(), digits, exponent, truncated);
+}
+
+template<typename T, typename Format>
+template<typename N, typename Digits>
+constexpr std::tuple<Digits, typename NumericalParser<T, Format>::template DecimalNumber<N>::Exponent, bool>
+NumericalParser<T, Format>::parseSignificantDigits(const std::size_t parsed) const
+{
+    constexpr std::size_t maxDigits = DecimalNumber<N>::maxDigits;
+
+    // Digits are accumulated in chunks of nineteen, fitting in a limb
+    constexpr std::size_t chunkDigits = 19;
+    constexpr std::uint64_t chunkPower = power(std::uint64_t{ 10 }, chunkDigits);
+
+    // The significant digits (leading zeros excluded), and the ten-exponent of the last one (narrowed as in
+    // parseNumber())
+    Digits digits;
+    std::size_t count = 0;
+    std::int64_t exponent = 0;
+
+    // Digits beyond maxDigits, only checked for non-zero
+    bool truncated = false;
+
+    // Scan the digits again, skipping the decimal point and digit separators
+    std::uint64_t chunk = 0;
+    bool fraction = false;
+    std::size_t i = at(0) == '-' || at(0) == '+' ? 1 : 0;
+    for (; i < parsed; i++) {
+        const auto c = at(i);
+        if (const auto digit = static_cast<unsigned>(c - '0'); digit < 10) {
+            if (count == maxDigits) {
+                truncated = truncated || digit != 0;
+                exponent += fraction ? 0 : 1;
+                continue;
             }
-            parsed += parsedExponent;
-            exponent += explicitExponent;
-        } break;
+            if (count != 0 || digit != 0) {
+                chunk = chunk * 10 + digit;
+                if (++count % chunkDigits == 0) {
+                    digits.multiply(chunkPower);
+                    digits.add(chunk);
+                    chunk = 0;
+                }
+            }
+            exponent -= fraction ? 1 : 0;
+        } else if (c == Format::decimalPoint) {
+            fraction = true;
+        } else if (c == 'e' || c == 'E') {
+            break;
+        }
     }
+    digits.multiply(power(std::uint64_t{ 10 }, count % chunkDigits));
+    digits.add(chunk);
 
-    return result;
+    // Explicit exponent, which was already successfully parsed
+    if (i < parsed) {
+        exponent += std::get<1>(parseExponent<true>(i + 1));
+    }
+
+    return { digits, saturatedExponent<N>(exponent), truncated };
 }
 
-template<typename T>
+template<typename T, typename Format>
 template<typename N>
-inline N NumericalParser<T>::toAnyDouble(bool& error) const
+inline N NumericalParser<T, Format>::toValue(const DecimalNumber<N>& number,
+                                             const NumberKind kind,
+                                             const std::size_t parsed) const
 {
     using Number = ieee754toy::IEEE754Number<N, 2>;
-    const auto [parsed, number] = parseMantissaExponent<N>();
-    error = parsed != size();
-
-    if (not error) {
-        return number.convertTwobase().toFloat();
-    } else if (*this == "Inf" || *this == "+Inf") {
-        error = false;
-        return Number::infinity(false);
-    } else if (*this == "-Inf") {
-        error = false;
-        return Number::infinity(true);
-    } else if (*this == "NaN") {
-        error = false;
+    if (kind == NumberKind::Decimal) [[likely]] {
+        return convert(number, parsed);
+    } else if (kind == NumberKind::Binary) {
+        return Number(number.negative, number.mantissa, number.exponent).toFloat();
+    } else if (kind == NumberKind::Infinity) {
+        return Number::infinity(number.negative);
+    } else {
         return Number::nan();
+    }
+}
+
+template<typename T, typename Format>
+template<typename N>
+inline std::size_t NumericalParser<T, Format>::toAnyDoublePrefix(N& value, bool& range) const
+{
+    const auto [parsed, number, kind] = parseNumber<N, true>();
+    range = false;
+    if (parsed == 0) {
+        return 0;
+    }
+
+    value = toValue(number, kind, parsed);
+    range = outOfRange(number, value);
+    return parsed;
+}
+
+template<typename T, typename Format>
+template<typename N>
+inline ParseResult<N> NumericalParser<T, Format>::parse() const
+{
+    if constexpr (isDecimalOutput<N>) {
+        return parseDecimal<N>();
     } else {
-        return N{};
+        using Exponent = typename DecimalNumber<N>::Exponent;
+
+        // Parse the longest valid prefix: when it is not the whole string, its end is the invalid character
+        const auto [parsed, number, kind] = parseNumber<N, true>();
+        if (parsed != size() || parsed == 0) [[unlikely]] {
+            return { N{}, parsed, size() != 0 ? ParseError::InvalidCharacter : ParseError::Empty };
+        }
+
+        const N value = toValue(number, kind, parsed);
+        const bool range = outOfRange(number, value);
+
+        // Out of range values, and zeros with a very large exponent, may come from a saturated exponent
+        constexpr Exponent largeExponent = std::numeric_limits<Exponent>::max() / 4;
+        if (range ||
+            (number.mantissa == 0 && (number.exponent > largeExponent || number.exponent < -largeExponent)))
+            [[unlikely]] {
+            if (const std::size_t mark = exponentMark(parsed, kind); exponentOverflow(parsed, mark)) {
+                return { value, mark, ParseError::ExponentOverflow };
+            } else if (range) {
+                // Infinity is the only out of range value which is not zero
+                using Integer = typename DecimalNumber<N>::Integer;
+                const bool overflow = static_cast<Integer>(std::bit_cast<Integer>(value) << 1) != 0;
+                return { value, parsed, overflow ? ParseError::Overflow : ParseError::Underflow };
+            }
+        }
+
+        const bool exact = kind != NumberKind::Decimal || exactlyConverted(number, value, parsed);
+        return { value, parsed, exact ? ParseError::None : ParseError::Inexact };
+    }
+}
+
+template<typename T, typename Format>
+template<typename V>
+constexpr ParseResult<V> NumericalParser<T, Format>::parseDecimal() const
+{
+    static_assert(isDecimalOutput<V>);
+
+    // The base-10 form is the one of double: a 64-bit mantissa
+    using Exponent = typename DecimalNumber<double>::Exponent;
+    const auto [parsed, number, kind] = parseNumber<double, true>();
+    if (parsed != size() || parsed == 0) [[unlikely]] {
+        return { V{}, parsed, size() != 0 ? ParseError::InvalidCharacter : ParseError::Empty };
+    }
+
+    if (kind != NumberKind::Decimal) [[unlikely]] {
+        if constexpr (std::is_same_v<V, Decimal64>) {
+            if (kind == NumberKind::Infinity) {
+                return { Decimal64::infinity(number.negative), parsed, ParseError::None };
+            } else if (kind == NumberKind::NaN) {
+                return { Decimal64::nan(), parsed, ParseError::None };
+            }
+        }
+        return { V{}, 0, ParseError::InvalidCharacter };
+    }
+
+    // The mantissa holds all the digits, unless it was full (see addOverflowingDigit()): the number is then
+    // strictly between the previous and the next mantissas, which mostly convert alike, and otherwise the digits
+    // are scanned again (see convertTwobase())
+    using Mantissa = typename DecimalNumber<double>::Mantissa;
+    auto [value, conversion] = toDecimalOutput<V>(number);
+    if (number.mantissa >= std::numeric_limits<Mantissa>::max() / 10) [[unlikely]] {
+        const DecimalNumber<double> previous(number.negative, number.mantissa - 1, number.exponent);
+        const auto lower = toDecimalOutput<V>(previous, DecimalTail::BelowHalf);
+        const auto upper = toDecimalOutput<V>(number, DecimalTail::AboveHalf);
+        if (conversion != DecimalConversion::Exact && lower == upper) {
+            std::tie(value, conversion) = lower;
+        } else {
+            const auto [mantissa, tail] = truncatedMantissa(number, parsed);
+            const DecimalNumber<double> truncated(number.negative, mantissa, number.exponent);
+            std::tie(value, conversion) = toDecimalOutput<V>(truncated, tail);
+        }
     }
+
+    // Out of range values, and zeros with a very large exponent, may come from a saturated exponent (see parse())
+    constexpr Exponent largeExponent = std::numeric_limits<Exponent>::max() / 4;
+    if (conversion >= DecimalConversion::Underflow ||
+        (number.mantissa == 0 && (number.exponent > largeExponent || number.exponent < -largeExponent)))
+        [[unlikely]] {
+        if (const std::size_t mark = exponentMark(parsed, kind); exponentOverflow(parsed, mark)) {
+            return { value, mark, ParseError::ExponentOverflow };
+        }
+    }
+
+    static_assert(static_cast<int>(DecimalConversion::Overflow) == static_cast<int>(ParseError::Overflow));
+    return { value, parsed, static_cast<ParseError>(conversion) };
+}
+
+template<typename T, typename Format>
+template<typename N>
+constexpr std::tuple<typename NumericalParser<T, Format>::template DecimalNumber<N>::Mantissa, DecimalTail>
+NumericalParser<T, Format>::truncatedMantissa(const DecimalNumber<N>& number, const std::size_t parsed) const
+{
+    using Mantissa = typename DecimalNumber<N>::Mantissa;
+
+    // Drop the digits after the mantissa, the last one being kept apart
+    const auto truncate = [&]<typename Digits>() -> std::tuple<Mantissa, DecimalTail> {
+        auto [digits, exponent, truncated] = parseSignificantDigits<N, Digits>(parsed);
+        bool sticky = truncated;
+        const int drop = number.exponent - exponent;
+        for (int i = drop - 1; i > 0; i -= 19) {
+            sticky = digits.divide(power(std::uint64_t{ 10 }, std::min(i, 19))) != 0 || sticky;
+        }
+        const auto last = drop > 0 ? digits.divide(10) : 0;
+
+        // The parsed mantissa is the truncated one, or the next one
+        const Mantissa mantissa =
+            digits.compare(Digits(number.mantissa)) == 0 ? number.mantissa : number.mantissa - 1;
+        const DecimalTail tail = last > 5 || (last == 5 && sticky) ? DecimalTail::AboveHalf
+                                 : last == 5                        ? DecimalTail::Half
+                                 : last != 0 || sticky              ? DecimalTail::BelowHalf
+                                                                    : DecimalTail::Zero;
+        return { mantissa, tail };
+    };
+
+    // Use the smallest big integers for the usual lengths (see convertTwobase())
+    if (parsed <= 7 * 19) {
+        return truncate.template operator()<BigInteger<8>>();
+    }
+    return truncate.template operator()<typename DecimalNumber<N>::DigitsInteger>();
+}
+
+template<typename T, typename Format>
+template<typename N>
+inline bool NumericalParser<T, Format>::exactlyConverted(const DecimalNumber<N>& number,
+                                                         const N value,
+                                                         const std::size_t parsed) const
+{
+    using Mantissa = typename DecimalNumber<N>::Mantissa;
+    using Integer = typename DecimalNumber<N>::Integer;
+    const auto bits = std::bit_cast<Integer>(value);
+
+    // The mantissa holds all the digits, unless it was full (see addOverflowingDigit())
+    if (number.mantissa < std::numeric_limits<Mantissa>::max() / 10) [[likely]] {
+        return number.exactlyConverted(bits);
+    }
+
+    // Otherwise, the ten-exponent of the last digit, at least the mantissa exponent minus the parsed size, can not
+    // be above the two-exponent of the odd mantissa of an exact number (see IEEE754Number::exactDigits()): this
+    // rejects most numbers without scanning the digits again
+    const auto twoexponent = std::get<1>(DecimalNumber<N>::oddMantissa(bits));
+    if (static_cast<std::ptrdiff_t>(number.exponent) - static_cast<std::ptrdiff_t>(parsed) > twoexponent) {
+        return false;
+    }
+
+    // Compare all the digits (see convertTwobase())
+    if (parsed <= 7 * 19) {
+        const auto [digits, exponent, truncated] = parseSignificantDigits<N, BigInteger<8>>(parsed);
+        return DecimalNumber<N>::exactDigits(bits, digits, exponent, truncated);
+    }
+    const auto [digits, exponent, truncated] =
+        parseSignificantDigits<N, typename DecimalNumber<N>::DigitsInteger>(parsed);
+    return DecimalNumber<N>::exactDigits(bits, digits, exponent, truncated);
+}
+
+template<typename T, typename Format>
+template<typename N>
+constexpr bool NumericalParser<T, Format>::outOfRange(const DecimalNumber<N>& number, const N value)
+{
+    using Integer = typename IEEE754Number<N, 2>::Integer;
+
+    // Zero or infinite result from a non-zero finite number (the sign being shifted out)
+    constexpr auto infinity = static_cast<Integer>(IEEE754BinaryNumber<N>::infinity() << 1);
+    const auto magnitude = static_cast<Integer>(std::bit_cast<Integer>(value) << 1);
+    return number.mantissa != 0 && (magnitude == 0 || magnitude == infinity);
+}
+
+template<typename T, typename Format>
+constexpr std::size_t NumericalParser<T, Format>::exponentMark(const std::size_t parsed,
+                                                               const NumberKind kind) const
+{
+    // The explicit exponent is the last run of digits, with an optional sign, after the exponent mark
+    std::size_t i = parsed;
+    while (i != 0 && isDigit(at(i - 1))) {
+        i--;
+    }
+    if (i != 0 && (at(i - 1) == '+' || at(i - 1) == '-')) {
+        i--;
+    }
+    const auto mark = i != 0 ? toLower(at(i - 1)) : 0;
+    return i != parsed && mark == (kind == NumberKind::Binary ? 'p' : 'e') ? i - 1 : parsed;
+}
+
+template<typename T, typename Format>
+constexpr bool NumericalParser<T, Format>::exponentOverflow(const std::size_t parsed, const std::size_t mark) const
+{
+    // The exponent was successfully parsed as a prefix, and can only fail because of an overflow
+    return mark != parsed && std::get<0>(parseExponent<false>(mark + 1)) == 0;
+}
+
+/** The result of fromChars(), see std::from_chars_result. **/
+template<typename T, typename N>
+struct FromCharsResult
+{
+    /** The parsed value (zero if nothing could be parsed) **/
+    N value;
+
+    /** The first character not matching the number **/
+    T* ptr;
+
+    /**
+     * Error code: std::errc::invalid_argument if nothing could be parsed (ptr is then the beginning),
+     * std::errc::result_out_of_range if the number overflowed to infinity or underflowed to zero
+     **/
+    std::errc ec;
+};
+
+/**
+ * Parse the longest number prefix of [first, last), without copying, in the spirit of std::from_chars: the end of
+ * the number does not need to be known in advance, and the returned pointer can be used to continue tokenizing.
+ * @param first The beginning of the characters
+ * @param last The end of the characters
+ * @return The converted value, the end of the number, and an error code.
+ * @comment Leading spaces are not skipped, but a leading plus sign, and infinity and NaN (see toAnyDouble), are
+ * allowed. The number format can be specified, see NumericalParser.
+ **/
+template<typename N = double, typename Format = DefaultNumberFormat, typename T>
+inline FromCharsResult<T, N> fromChars(T* first, T* last)
+{
+    N value{};
+    bool range = false;
+    const std::size_t parsed =
+        NumericalParser<T, Format>(first, last).template toAnyDoublePrefix<N>(value, range);
+    const std::errc ec = parsed == 0 ? std::errc::invalid_argument
+                         : range     ? std::errc::result_out_of_range
+                                     : std::errc{};
+    return { value, first + parsed, ec };
 }
 
 }; // namespace ieee754toy
@@ -0,0 +1,296 @@
+/*
+ * IEEE754 constexpr parser toy. Parallel batch parser.
+ * Thanks to Algolia for giving me the opportunity to develop this toy!
+ * @maintainer Xavier Roche (xavier dot roche at algolia.com)
+ */
+#pragma once
+
+#include "BatchParser.h"
+#include "BatchScanner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace ieee754toy {
+
+/**
+ * Parallel parsing options.
+ **/
+struct ParallelOptions
+{
+    /** Approximate size of a chunk, in characters. Chunks are extended up to the next delimiter. **/
+    std::size_t grain = std::size_t(1) << 20;
+
+    /** Number of threads, including the calling thread. Zero means std::thread::hardware_concurrency(). **/
+    unsigned threads = 0;
+
+    /**
+     * Parse through a cache of the recently parsed short values, one per thread and kept from one chunk to the
+     * next (see ParseCache), for low-cardinality columns.
+     **/
+    bool cache = false;
+};
+
+/**
+ * Parallel numerical parser: parse a large buffer of delimited values on several threads.
+ * The buffer is split into chunks aligned on delimiters; values are first counted (see BatchScanner::count())
+ * to compute each chunk output offset, and chunks are then parsed with BatchParser, each thread picking the next
+ * available chunk. The output is identical to BatchParser::parse, whatever the number of threads and the grain.
+ * @comment Format The number format, see NumericalParser.
+ **/
+template<typename T, typename Format = DefaultNumberFormat>
+class ParallelParser : private std::span<T>
+{
+public:
+    /** Create a new parallel parser over a buffer **/
+    template<typename... Ts>
+    constexpr ParallelParser(Ts&&... args)
+      : std::span<T>(std::forward<Ts>(args)...)
+    {}
+
+    /**
+     * Parse values separated by a delimiter (eg. '\n' or ',').
+     *
+     * @param delimiter The delimiter character. A trailing delimiter at the end of the buffer is ignored.
+     * @param[out] values The parsed values, @c 0 for values in error.
+     * @param[out] errors The error bitmap, holding at least ErrorBitmap::words(values.size()) words.
+     * @param options The parsing options.
+     * @return The number of values in the buffer. Values beyond values.size() are not parsed.
+     */
+    template<typename N = double>
+    std::size_t parse(T delimiter,
+                      std::span<N> values,
+                      std::span<ErrorBitmap::Word> errors,
+                      const ParallelOptions& options = {}) const
+    {
+        return parse(delimiter, values, errors, options, threads(options), std::span<ParseSession<N>>());
+    }
+
+    /**
+     * Parse values separated by a delimiter on one thread per session (options.threads being ignored), recording
+     * the errors of the values each thread parsed into its session, in increasing order (see ParseSession). See
+     * parse().
+     */
+    template<typename N>
+    std::size_t parse(T delimiter,
+                      std::span<N> values,
+                      std::span<ErrorBitmap::Word> errors,
+                      std::span<ParseSession<N>> sessions,
+                      const ParallelOptions& options = {}) const
+    {
+        return parse(delimiter, values, errors, options, std::max<std::size_t>(sessions.size(), 1), sessions);
+    }
+
+    /**
+     * Count the values separated by a delimiter, in parallel (eg. to size the output of parse() beforehand).
+     *
+     * @param delimiter The delimiter character. A trailing delimiter at the end of the buffer is ignored.
+     * @param options The parsing options (the numbers of threads, and the grain).
+     * @return The number of values in the buffer.
+     */
+    std::size_t count(T delimiter, const ParallelOptions& options = {}) const
+    {
+        auto chunks = split(delimiter, options.grain);
+        return count(delimiter, chunks, threads(options));
+    }
+
+private:
+    using std::span<T>::size;
+    using std::span<T>::data;
+
+    /** A chunk of values. **/
+    struct Chunk
+    {
+        /** Characters range **/
+        std::size_t begin;
+        std::size_t end;
+
+        /** Number of values, and index of the first value **/
+        std::size_t count;
+        std::size_t offset;
+    };
+
+    /** Split the buffer into chunks of at least grain characters, ending after a delimiter. **/
+    std::vector<Chunk> split(T delimiter, std::size_t grain) const;
+
+    /** Count the values of the chunks on the given number of threads, set their offsets, and return the total. **/
+    std::size_t count(T delimiter, std::vector<Chunk>& chunks, unsigned threads) const;
+
+    /** Number of threads to use. **/
+    static unsigned threads(const ParallelOptions& options)
+    {
+        return options.threads != 0 ? options.threads : std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    /** Parse on the given number of threads, recording errors into the session of each thread, if any. **/
+    template<typename N>
+    std::size_t parse(T delimiter,
+                      std::span<N> values,
+                      std::span<ErrorBitmap::Word> errors,
+                      const ParallelOptions& options,
+                      unsigned threads,
+                      std::span<ParseSession<N>> sessions) const;
+
+    /**
+     * Parse a chunk, values being stored from chunk.offset, through the cache if not null, and recording errors
+     * into the session if not null.
+     **/
+    template<typename N>
+    void parse(T delimiter,
+               const Chunk& chunk,
+               std::span<N> values,
+               std::span<ErrorBitmap::Word> errors,
+               ParseCache<N>* cache,
+               ParseSession<N>* session) const;
+
+    /**
+     * Run task(i, thread) for all i in [0, tasks) on the given number of threads, including the calling one (whose
+     * thread index is zero).
+     **/
+    template<typename F>
+    static void run(unsigned threads, std::size_t tasks, const F& task);
+};
+
+// Deduction guides.
+template<typename Type>
+explicit ParallelParser(Type* begin, std::size_t size) -> ParallelParser<Type>;
+template<typename Type>
+explicit ParallelParser(Type* begin, Type* end) -> ParallelParser<Type>;
+
+template<typename T, typename Format>
+std::vector<typename ParallelParser<T, Format>::Chunk> ParallelParser<T, Format>::split(T delimiter,
+                                                                                       std::size_t grain) const
+{
+    std::vector<Chunk> chunks;
+    chunks.reserve(size() / std::max<std::size_t>(grain, 1) + 1);
+
+    for (std::size_t begin = 0; begin < size();) {
+        std::size_t end = begin + std::max<std::size_t>(grain, 1);
+        if (end < size()) {
+            end = std::find(data() + end - 1, data() + size(), delimiter) - data();
+            end = end < size() ? end + 1 : end;
+        } else {
+            end = size();
+        }
+        chunks.push_back({ begin, end, 0, 0 });
+        begin = end;
+    }
+
+    return chunks;
+}
+
+template<typename T, typename Format>
+std::size_t ParallelParser<T, Format>::count(T delimiter, std::vector<Chunk>& chunks, const unsigned threads) const
+{
+    run(threads, chunks.size(), [this, delimiter, &chunks](std::size_t i, unsigned) {
+        const BatchScanner<T, Format> scanner(data() + chunks[i].begin, data() + chunks[i].end);
+        chunks[i].count = scanner.count(delimiter);
+    });
+    std::size_t total = 0;
+    for (auto& chunk : chunks) {
+        chunk.offset = total;
+        total += chunk.count;
+    }
+    return total;
+}
+
+template<typename T, typename Format>
+template<typename N>
+void ParallelParser<T, Format>::parse(T delimiter,
+                              const Chunk& chunk,
+                              std::span<N> values,
+                              std::span<ErrorBitmap::Word> errors,
+                              ParseCache<N>* const cache,
+                              ParseSession<N>* const session) const
+{
+    if (chunk.offset >= values.size()) {
+        return;
+    }
+    const std::size_t count = std::min(chunk.count, values.size() - chunk.offset);
+
+    // Parse one error bitmap word at a time, merged into the shared bitmap, as chunks are not word-aligned
+    std::size_t position = 0;
+    for (std::size_t i = 0; i < count; i += ErrorBitmap::wordBits) {
+        const std::size_t block = std::min(ErrorBitmap::wordBits, count - i);
+        ErrorBitmap::Word word = 0;
+        const BatchParser<T, Format> parser(data() + chunk.begin + position, chunk.end - chunk.begin - position);
+        const auto output = values.subspan(chunk.offset + i, block);
+        const auto bitmap = std::span<ErrorBitmap::Word>(&word, 1);
+        const auto [parsed, consumed] = cache != nullptr ? parser.parse(delimiter, output, bitmap, *cache)
+                                                         : parser.template parse<N>(delimiter, output, bitmap);
+        if (word != 0 && session != nullptr) {
+            session->template record<Format>(data() + chunk.begin + position,
+                                             data() + chunk.end,
+                                             delimiter,
+                                             word,
+                                             chunk.offset + i,
+                                             chunk.begin + position);
+        }
+        position += consumed;
+
+        if (word != 0) {
+            const std::size_t index = (chunk.offset + i) / ErrorBitmap::wordBits;
+            const std::size_t shift = (chunk.offset + i) % ErrorBitmap::wordBits;
+            std::atomic_ref(errors[index]).fetch_or(word << shift, std::memory_order_relaxed);
+            if (shift != 0 && (word >> (ErrorBitmap::wordBits - shift)) != 0) {
+                std::atomic_ref(errors[index + 1])
+                    .fetch_or(word >> (ErrorBitmap::wordBits - shift), std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+template<typename T, typename Format>
+template<typename F>
+void ParallelParser<T, Format>::run(unsigned threads, std::size_t tasks, const F& task)
+{
+    std::atomic<std::size_t> next = 0;
+    const auto worker = [&next, tasks, &task](const unsigned thread) {
+        for (std::size_t i = next++; i < tasks; i = next++) {
+            task(i, thread);
+        }
+    };
+
+    std::vector<std::jthread> workers;
+    workers.reserve(threads);
+    for (unsigned i = 1; i < std::min<std::size_t>(threads, tasks); i++) {
+        workers.emplace_back(worker, i);
+    }
+    worker(0);
+}
+
+template<typename T, typename Format>
+template<typename N>
+std::size_t ParallelParser<T, Format>::parse(T delimiter,
+                                     std::span<N> values,
+                                     std::span<ErrorBitmap::Word> errors,
+                                     const ParallelOptions& options,
+                                     const unsigned threads,
+                                     std::span<ParseSession<N>> sessions) const
+{
+    // Count values per chunk, and compute the output offsets
+    auto chunks = split(delimiter, options.grain);
+    const std::size_t total = count(delimiter, chunks, threads);
+
+    // One parse cache per thread, warmed by all the chunks of the thread (and not on the stack, being large)
+    std::vector<ParseCache<N>> caches(options.cache ? std::min<std::size_t>(threads, chunks.size()) : 0);
+
+    // Parse
+    std::fill(errors.begin(), errors.begin() + ErrorBitmap::words(std::min(total, values.size())), 0);
+    const auto task = [this, delimiter, &chunks, values, errors, &caches, sessions](std::size_t i,
+                                                                                    unsigned thread) {
+        ParseCache<N>* const cache = thread < caches.size() ? &caches[thread] : nullptr;
+        ParseSession<N>* const session = thread < sessions.size() ? &sessions[thread] : nullptr;
+        parse<N>(delimiter, chunks[i], values, errors, cache, session);
+    };
+    run(threads, chunks.size(), task);
+
+    return total;
+}
+
+}; // namespace ieee754toy
@@ -0,0 +1,190 @@
+/*
+ * IEEE754 constexpr parser toy. Cache of recently parsed strings.
+ * Thanks to Algolia for giving me the opportunity to develop this toy!
+ * @maintainer Xavier Roche (xavier dot roche at algolia.com)
+ */
+#pragma once
+
+#include "Instrumentation.h"
+#include "NumericalParser.h"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace ieee754toy {
+
+/**
+ * Cache of recently parsed short strings, in front of NumericalParser::toAnyDouble, for low-cardinality columns
+ * (eg. status codes such as "0.0", "1.0" and "-1", or repeated price points): values of up to maxKeyBytes bytes
+ * are looked up in a fixed-size table of cache-line buckets, each holding a few entries (open addressing within
+ * the bucket, the oldest entry being evicted), and parsed upon miss only. Longer values are always parsed.
+ * The results are identical to toAnyDouble, errors included. No memory is allocated, and the table is not shared
+ * (use one cache per thread and column, eg. on the stack).
+ * @comment N The returned type (see NumericalParser::toAnyDouble).
+ * @comment Buckets The number of buckets, a power of two (each bucket being a 64-byte cache line).
+ * @warning Values of a cache must all be parsed with the same number format.
+ **/
+template<typename N = double, std::size_t Buckets = 256>
+class ParseCache
+{
+    static_assert(std::has_single_bit(Buckets));
+
+public:
+    /** The maximum size of a cached value, in bytes (eg. 16 characters, or 8 char16_t) **/
+    static constexpr std::size_t maxKeyBytes = 16;
+
+    /**
+     * Convert the string [begin, end) into a floating point value of any type, as NumericalParser::toAnyDouble.
+     * @param[out] error Set to @c true upon error
+     * @return The parsed value.
+     * @comment Format The number format of the cached values.
+     */
+    template<typename Format = DefaultNumberFormat, typename T>
+    inline N parse(T* begin, T* end, bool& error)
+    {
+        return parse<Format>(begin, end, end, error);
+    }
+
+    /**
+     * Same as parse(begin, end, error), limit being the end of the readable buffer holding the value (eg. the end
+     * of the column): values can then be read with a single load.
+     */
+    template<typename Format = DefaultNumberFormat, typename T>
+    inline N parse(T* begin, T* end, T* limit, bool& error);
+
+    /** Number of values found in the cache. **/
+    constexpr std::uint64_t hits() const { return hitCount; }
+
+    /** Number of values parsed (not found in the cache, or too long). **/
+    constexpr std::uint64_t misses() const { return missCount; }
+
+    /** Ratio of values found in the cache (zero if none was parsed). **/
+    constexpr double hitRate() const
+    {
+        const std::uint64_t lookups = hitCount + missCount;
+        return lookups != 0 ? static_cast<double>(hitCount) / static_cast<double>(lookups) : 0;
+    }
+
+    /** Empty the cache, and reset its counters. **/
+    void clear() { *this = ParseCache(); }
+
+private:
+    /** A cached value: its key (see key()), and its result. **/
+    struct Entry
+    {
+        std::uint64_t low = 0;
+        std::uint64_t high = 0;
+        N value{};
+
+        /** Size of the value in bytes plus one, ie. zero for an empty entry **/
+        std::uint8_t length = 0;
+        bool error = false;
+    };
+
+    /** Entries per bucket **/
+    static constexpr std::size_t ways = sizeof(Entry) < 64 ? 64 / sizeof(Entry) : 1;
+
+    /** A bucket, which is a cache line: the most recent entries first **/
+    struct alignas(64) Bucket
+    {
+        std::array<Entry, ways> entries{};
+    };
+
+    /**
+     * Compute the key of a value of at most maxKeyBytes bytes, readable up to limit: its bytes, zero-padded, which
+     * identify it with its size. Unless the value is close to limit, they are read at once, and masked.
+     **/
+    static inline void key(const unsigned char* bytes,
+                           std::size_t size,
+                           const unsigned char* limit,
+                           std::uint64_t& low,
+                           std::uint64_t& high);
+
+    /** Hash a key to a bucket index. **/
+    static constexpr std::size_t bucket(std::uint64_t low, std::uint64_t high, std::size_t size)
+    {
+        if constexpr (Buckets == 1) {
+            return 0;
+        } else {
+            // The leading bits of the product depend on all the key bits
+            const std::uint64_t hash = (low ^ std::rotl(high, 29) ^ size) * 0x9E3779B97F4A7C15ull;
+            return static_cast<std::size_t>(hash >> (64 - std::countr_zero(Buckets)));
+        }
+    }
+
+    std::array<Bucket, Buckets> table{};
+    std::uint64_t hitCount = 0;
+    std::uint64_t missCount = 0;
+};
+
+template<typename N, std::size_t Buckets>
+inline void ParseCache<N, Buckets>::key(const unsigned char* const bytes,
+                                        const std::size_t size,
+                                        const unsigned char* const limit,
+                                        std::uint64_t& low,
+                                        std::uint64_t& high)
+{
+    std::array<unsigned char, maxKeyBytes> key{};
+    if (static_cast<std::size_t>(limit - bytes) >= maxKeyBytes) {
+        std::memcpy(key.data(), bytes, maxKeyBytes);
+    } else {
+        std::memcpy(key.data(), bytes, size);
+    }
+    std::memcpy(&low, key.data(), 8);
+    std::memcpy(&high, key.data() + 8, 8);
+    if constexpr (std::endian::native == std::endian::big) {
+        low = __builtin_bswap64(low);
+        high = __builtin_bswap64(high);
+    }
+
+    // Clear the bytes beyond the value (a no-op for copied values)
+    const std::size_t lowBits = size < 8 ? size * 8 : 64;
+    const std::size_t highBits = size > 8 ? (size - 8) * 8 : 0;
+    low &= lowBits != 64 ? (std::uint64_t(1) << lowBits) - 1 : ~std::uint64_t(0);
+    high &= highBits != 64 ? (std::uint64_t(1) << highBits) - 1 : ~std::uint64_t(0);
+}
+
+template<typename N, std::size_t Buckets>
+template<typename Format, typename T>
+inline N ParseCache<N, Buckets>::parse(T* const begin, T* const end, T* const limit, bool& error)
+{
+    const std::size_t size = static_cast<std::size_t>(end - begin) * sizeof(T);
+    if (size > maxKeyBytes) {
+        missCount++;
+        instrumentCacheLookup(false);
+        return NumericalParser<T, Format>(begin, end).template toAnyDouble<N>(error);
+    }
+
+    std::uint64_t low;
+    std::uint64_t high;
+    key(reinterpret_cast<const unsigned char*>(begin),
+        size,
+        reinterpret_cast<const unsigned char*>(limit),
+        low,
+        high);
+    const auto length = static_cast<std::uint8_t>(size + 1);
+    auto& entries = table[bucket(low, high, size)].entries;
+    for (const Entry& entry : entries) {
+        if (entry.length == length && entry.low == low && entry.high == high) {
+            hitCount++;
+            instrumentCacheLookup(true);
+            error = entry.error;
+            return entry.value;
+        }
+    }
+
+    // Parse, and evict the oldest entry of the bucket
+    missCount++;
+    instrumentCacheLookup(false);
+    const N value = NumericalParser<T, Format>(begin, end).template toAnyDouble<N>(error);
+    for (std::size_t i = ways - 1; i != 0; i--) {
+        entries[i] = entries[i - 1];
+    }
+    entries[0] = { low, high, value, length, error };
+    return value;
+}
+
+}; // namespace ieee754toy
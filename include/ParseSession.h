@@ -0,0 +1,125 @@
+/*
+ * IEEE754 constexpr parser toy. Reusable parsing session.
+ * Thanks to Algolia for giving me the opportunity to develop this toy!
+ * @maintainer Xavier Roche (xavier dot roche at algolia.com)
+ */
+#pragma once
+
+#include "Instrumentation.h"
+#include "NumericalParser.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace ieee754toy {
+
+/** The error of a value parsed within a session, see ParseSession. **/
+struct ParseErrorRecord
+{
+    /** Index of the value **/
+    std::size_t index;
+
+    /** Position of the value in the buffer, and its size **/
+    std::size_t offset;
+    std::size_t size;
+
+    /** Position of the error within the value, and the error, as reported by NumericalParser::parse() **/
+    std::size_t position;
+    ParseError error;
+};
+
+/**
+ * Parsing session: the state kept by a thread across batch parsing calls (see the BatchParser::parse and
+ * ParallelParser::parse overloads taking sessions), ie. the error records of the values in error, with their
+ * position and the reason of the error.
+ * Records are allocated from a caller-provided memory resource (eg. a std::pmr::monotonic_buffer_resource over an
+ * arena), and their storage is kept across calls: once the session has seen as many errors as a call yields, or
+ * once reserve() was called, parsing does not allocate anymore. Values which are not in error cost nothing
+ * beyond the plain batch parsing. Creating a session also allocates the instrumentation counters of the thread,
+ * if enabled (see InstrumentationCounters).
+ * @comment N The parsed type (see NumericalParser::parse()).
+ * @warning A session must not be used by several threads at once.
+ **/
+template<typename N = double>
+class ParseSession
+{
+public:
+    /**
+     * Create a new session.
+     * @param resource The memory resource of the error records.
+     **/
+    explicit ParseSession(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : records(resource)
+    {
+        // The counters block of the thread is otherwise allocated by its first instrumented parsing
+        if constexpr (instrumentationEnabled) {
+            InstrumentationCounters::local();
+        }
+    }
+
+    /** Reserve room for the given number of error records. **/
+    void reserve(std::size_t count) { records.reserve(count); }
+
+    /** The error records, in increasing value index order since the last clear(). **/
+    std::span<const ParseErrorRecord> errors() const { return records; }
+
+    /** Forget the error records, keeping their storage. **/
+    void clear() { records.clear(); }
+
+    /** The memory resource of the error records. **/
+    std::pmr::memory_resource* resource() const { return records.get_allocator().resource(); }
+
+    /**
+     * Record the errors of a block of consecutive values, as parsed by BatchParser::parse.
+     *
+     * @param begin The first value of the block.
+     * @param end The end of the buffer.
+     * @param delimiter The delimiter character.
+     * @param word The error bitmap word of the block (bit #i being set if value #i is in error).
+     * @param index The index of the first value.
+     * @param offset The position of the first value in the buffer.
+     * @comment Format The number format of the values.
+     */
+    template<typename Format = DefaultNumberFormat, typename T>
+    void record(T* begin,
+                T* end,
+                std::remove_cv_t<T> delimiter,
+                std::uint64_t word,
+                std::size_t index,
+                std::size_t offset);
+
+private:
+    std::pmr::vector<ParseErrorRecord> records;
+};
+
+template<typename N>
+template<typename Format, typename T>
+void ParseSession<N>::record(T* const begin,
+                             T* const end,
+                             const std::remove_cv_t<T> delimiter,
+                             std::uint64_t word,
+                             const std::size_t index,
+                             const std::size_t offset)
+{
+    // Only the values up to the last one in error are walked through
+    T* value = begin;
+    for (std::size_t i = 0; word != 0; i++, word >>= 1) {
+        T* const next = std::find(value, end, delimiter);
+        if ((word & 1) != 0) {
+            const auto result = NumericalParser<T, Format>(value, next).template parse<N>();
+            records.push_back({ index + i,
+                                offset + static_cast<std::size_t>(value - begin),
+                                static_cast<std::size_t>(next - value),
+                                result.position,
+                                result.error });
+        }
+        value = next != end ? next + 1 : next;
+    }
+}
+
+}; // namespace ieee754toy
@@ -0,0 +1,245 @@
+/*
+ * IEEE754 constexpr parser toy. Normalized powers of ten.
+ * Thanks to Algolia for giving me the opportunity to develop this toy!
+ * @maintainer Xavier Roche (xavier dot roche at algolia.com)
+ */
+#pragma once
+
+/**
+ * Table of 128-bit normalized powers of ten, used by the Eisel-Lemire conversion.
+ * References:
+ * <https://arxiv.org/abs/2101.11408> (Daniel Lemire, "Number Parsing at a Gigabyte per Second")
+ * <https://nigeltao.github.io/blog/2020/eisel-lemire.html>
+ */
+
+#include "BigInteger.h"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace ieee754toy {
+
+/**
+ * Normalized powers of ten.
+ * Each entry holds the 128 most significant bits of 10**q, ie. 5**q shifted so that the leading bit is the
+ * 128th bit (the power of two part is implicit, see PowersOfTen::binaryExponent). Negative powers are rounded up
+ * (truncated reciprocal plus one), positive powers are truncated.
+ **/
+struct PowersOfTen
+{
+    /** A 128-bit normalized power of ten. **/
+    struct Entry
+    {
+        std::uint64_t high;
+        std::uint64_t low;
+    };
+
+    /** Smallest power of ten in the table. Any 64-bit mantissa multiplied by a smaller power is zero. **/
+    static constexpr int smallestPowerOfTen = -342;
+
+    /** Largest power of ten in the table. Any non-zero mantissa multiplied by a larger power is infinite. **/
+    static constexpr int largestPowerOfTen = 308;
+
+    /** Number of entries. **/
+    static constexpr std::size_t size = largestPowerOfTen - smallestPowerOfTen + 1;
+
+    /**
+     * Return floor(log2(10**q)) + 63, the binary exponent of the 64-bit leading part of an entry.
+     * @comment 217706 / 2**16 is an approximation of log2(10), exact over the table range.
+     **/
+    static constexpr int binaryExponent(int q) { return ((217706 * q) >> 16) + 63; }
+
+    /** Generate the table (at compile-time only). **/
+    static consteval std::array<Entry, size> generate();
+
+    /** Return the entry for 10**q, with smallestPowerOfTen <= q <= largestPowerOfTen. **/
+    static constexpr Entry get(int q);
+};
+
+/**
+ * Normalize a (non-zero) positive power of five, truncated to its 128 leading bits.
+ **/
+template<typename Power>
+constexpr PowersOfTen::Entry normalizedEntry(const Power& power, __uint128_t increment = 0)
+{
+    const std::size_t length = power.bitLength();
+    const auto bits = (length < 128 ? power.low128() << (128 - length) : power.bits128(length - 128)) + increment;
+    return PowersOfTen::Entry{ static_cast<std::uint64_t>(bits >> 64), static_cast<std::uint64_t>(bits) };
+}
+
+consteval std::array<PowersOfTen::Entry, PowersOfTen::size> PowersOfTen::generate()
+{
+    std::array<Entry, size> table{};
+
+    // Negative powers: we need the 128 leading bits of 2**b / 5**n, for b large enough to have exact bits.
+    // We keep floor(2**B / 5**n) for a fixed large B, dividing by five at each step, as cascading floor divisions
+    // are exact: floor(floor(x / a) / b) == floor(x / (a * b))
+    {
+        using Reciprocal = BigInteger<27>;
+        constexpr std::size_t B = Reciprocal::bits - 1;
+        Reciprocal reciprocal = Reciprocal::powerOfTwo(B);
+        for (int n = 1; n <= -smallestPowerOfTen; n++) {
+            reciprocal.divide(5);
+
+            // 5**n has z bits, with 2**(z - 1) < 5**n < 2**z, so the reciprocal has B - z + 1 bits
+            const std::size_t length = reciprocal.bitLength();
+            const std::size_t z = B + 1 - length;
+
+            // Small powers (5**n < 2**64) only need a 128-bit reciprocal to be exact; larger ones are truncated.
+            // The b-bit floor(2**b / 5**n) is the reciprocal shifted by B - b, plus one, keeping its 128 leading
+            // bits: adding one only carries through the dropped bits when they are all set.
+            const std::size_t b = n <= 27 ? z + 127 : 2 * z + 128;
+            const std::size_t offset = B - b;
+            const std::size_t dropped = length - offset - 128;
+            auto bits = reciprocal.bits128(offset + dropped);
+            if (reciprocal.hasAllBits(offset, dropped) && ++bits == 0) {
+                bits = __uint128_t{ 1 } << 127;
+            }
+            table[-smallestPowerOfTen - n] =
+                Entry{ static_cast<std::uint64_t>(bits >> 64), static_cast<std::uint64_t>(bits) };
+        }
+    }
+
+    // Positive powers: truncated 5**q, normalized to 128 bits.
+    {
+        using Power = BigInteger<12>;
+        Power power(1);
+        for (int q = 0; q <= largestPowerOfTen; q++) {
+            table[q - smallestPowerOfTen] = normalizedEntry(power);
+            power.multiply(5);
+        }
+    }
+
+    return table;
+}
+
+/**
+ * Compact table of normalized powers of ten, for any table of consecutive powers.
+ * Only one entry out of step is stored; the other ones are rebuilt by multiplying the previous stored entry by
+ * 5**r (with r < step, so that 5**r fits in 64 bits), normalizing the 192-bit product, and adding a small
+ * correction (two bits per entry) so that the rebuilt entry is identical to the full table one.
+ * @comment Size Number of entries
+ **/
+template<std::size_t Size>
+struct CompactPowersOfTen
+{
+    using Entry = PowersOfTen::Entry;
+
+    /** One entry out of step is stored. **/
+    static constexpr std::size_t step = 27;
+
+    /** Corrections are biased by one, and fit in two bits. **/
+    static constexpr std::size_t correctionBits = 2;
+    static constexpr std::size_t correctionsPerWord = 64 / correctionBits;
+    static constexpr int correctionBias = 1;
+
+    /** Compress a full table (at compile-time only). Compilation fails if an entry can not be rebuilt. **/
+    static consteval CompactPowersOfTen compress(const std::array<Entry, Size>& table);
+
+    /** Rebuild the entry at index, without correction. **/
+    constexpr __uint128_t approximate(std::size_t index) const;
+
+    /** Rebuild the entry at index. **/
+    constexpr Entry get(std::size_t index) const;
+
+    /** Small powers of five. **/
+    static constexpr std::array<std::uint64_t, step> fivePowers = [] {
+        std::array<std::uint64_t, step> powers{};
+        std::uint64_t power = 1;
+        for (auto& entry : powers) {
+            entry = power;
+            power *= 5;
+        }
+        return powers;
+    }();
+
+    /** Stored entries (one out of step). **/
+    std::array<Entry, (Size + step - 1) / step> bases{};
+
+    /** Packed biased corrections. **/
+    std::array<std::uint64_t, (Size + correctionsPerWord - 1) / correctionsPerWord> corrections{};
+};
+
+/** Not a constant expression: reached when a table can not be compressed, failing the compilation. **/
+inline void compressionFailure() {}
+
+template<std::size_t Size>
+consteval CompactPowersOfTen<Size> CompactPowersOfTen<Size>::compress(const std::array<Entry, Size>& table)
+{
+    CompactPowersOfTen compact;
+    for (std::size_t i = 0; i < Size; i += step) {
+        compact.bases[i / step] = table[i];
+    }
+    for (std::size_t i = 0; i < Size; i++) {
+        const __uint128_t expected = (__uint128_t{ table[i].high } << 64) | table[i].low;
+        const auto correction = static_cast<std::uint64_t>(expected - compact.approximate(i) + correctionBias);
+        if (correction >= (std::uint64_t{ 1 } << correctionBits)) {
+            compressionFailure();
+        }
+        compact.corrections[i / correctionsPerWord] |= correction << (i % correctionsPerWord * correctionBits);
+    }
+    return compact;
+}
+
+template<std::size_t Size>
+constexpr __uint128_t CompactPowersOfTen<Size>::approximate(std::size_t index) const
+{
+    const Entry& base = bases[index / step];
+    const __uint128_t bits = (__uint128_t{ base.high } << 64) | base.low;
+    const std::uint64_t factor = fivePowers[index % step];
+    if (factor == 1) {
+        return bits;
+    }
+
+    // 192-bit product, whose leading limb is not zero (the base is normalized, and the factor at least five)
+    const __uint128_t lowProduct = __uint128_t{ base.low } * factor;
+    const __uint128_t highProduct = __uint128_t{ base.high } * factor + (lowProduct >> 64);
+    const auto leading = static_cast<std::uint64_t>(highProduct >> 64);
+    const int shift = std::countl_zero(leading);
+
+    // Normalize, keeping the 128 leading bits
+    const auto low = static_cast<std::uint64_t>(lowProduct);
+    return shift != 0 ? (highProduct << shift) | (low >> (64 - shift)) : highProduct;
+}
+
+template<std::size_t Size>
+constexpr PowersOfTen::Entry CompactPowersOfTen<Size>::get(std::size_t index) const
+{
+    const auto correction = static_cast<int>(
+        (corrections[index / correctionsPerWord] >> (index % correctionsPerWord * correctionBits)) &
+        ((std::uint64_t{ 1 } << correctionBits) - 1));
+    const __uint128_t bits = approximate(index) + correction - correctionBias;
+    return Entry{ static_cast<std::uint64_t>(bits >> 64), static_cast<std::uint64_t>(bits) };
+}
+
+/**
+ * The table itself: either the full table (fastest), or its compact representation, rebuilding entries with one
+ * extra multiplication (smaller binary and cache footprint), when IEEE754TOY_COMPACT_TABLES is defined.
+ **/
+#ifdef IEEE754TOY_COMPACT_TABLES
+inline constexpr auto powersOfTenTable = CompactPowersOfTen<PowersOfTen::size>::compress(PowersOfTen::generate());
+
+constexpr PowersOfTen::Entry PowersOfTen::get(int q)
+{
+    return powersOfTenTable.get(q - smallestPowerOfTen);
+}
+#else
+inline constexpr std::array<PowersOfTen::Entry, PowersOfTen::size> powersOfTenTable = PowersOfTen::generate();
+
+constexpr PowersOfTen::Entry PowersOfTen::get(int q)
+{
+    return powersOfTenTable[q - smallestPowerOfTen];
+}
+#endif
+
+// Basic table checks.
+static_assert(PowersOfTen::get(0).high == 0x8000000000000000 && PowersOfTen::get(0).low == 0);
+static_assert(PowersOfTen::get(1).high == 0xA000000000000000 && PowersOfTen::get(1).low == 0);
+static_assert(PowersOfTen::get(-1).high == 0xCCCCCCCCCCCCCCCC && PowersOfTen::get(-1).low == 0xCCCCCCCCCCCCCCCD);
+static_assert(PowersOfTen::get(-342).high == 0xEEF453D6923BD65A &&
+              PowersOfTen::get(-342).low == 0x113FAA2906A13B3F);
+static_assert(PowersOfTen::get(308).high == 0x8E679C2F5E44FF8F && PowersOfTen::get(308).low == 0x570F09EAA7EA7648);
+
+}; // namespace ieee754toy
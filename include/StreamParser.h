@@ -0,0 +1,164 @@
+/*
+ * IEEE754 constexpr parser toy. Resumable stream parser.
+ * Thanks to Algolia for giving me the opportunity to develop this toy!
+ * @maintainer Xavier Roche (xavier dot roche at algolia.com)
+ */
+#pragma once
+
+#include "BatchParser.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+namespace ieee754toy {
+
+/**
+ * Resumable numerical parser: parse delimited values fed as successive chunks (eg. network receive buffers), a
+ * value being possibly split across several chunks, and emit them as they complete.
+ * The values completed within a chunk are parsed in place with BatchParser, without any copy. Only the characters
+ * of the value left incomplete at the end of a chunk are kept (at most Capacity of them), until the next
+ * delimiter: they are the state of the number, as the correctly rounded conversion may need all its digits again
+ * (see NumericalParser::convertTwobase()). The emitted values are identical to BatchParser::parse over the
+ * concatenated chunks, whatever the chunk boundaries, except for the values longer than Capacity split across
+ * chunks, which are errors.
+ * No memory is allocated.
+ * @comment Format The number format, see NumericalParser.
+ * @comment Capacity The maximum length of a value split across chunks (longer ones are errors).
+ **/
+template<typename T, typename Format = DefaultNumberFormat, std::size_t Capacity = 256>
+class StreamParser
+{
+public:
+    /** The character type of the pending value. **/
+    using Unit = std::remove_cv_t<T>;
+
+    /**
+     * Create a new stream parser.
+     * @param delimiter The delimiter character (eg. '\n' or ',')
+     **/
+    constexpr explicit StreamParser(Unit delimiter)
+      : delimiter(delimiter)
+    {}
+
+    /**
+     * Parse the next chunk of the stream.
+     *
+     * @param chunk The chunk, which is not referenced anymore upon return.
+     * @param emit The function called for every completed value, in order, as emit(value, error): the value is
+     * @c 0 upon error (see NumericalParser::toAnyDouble).
+     * @return The number of values emitted.
+     */
+    template<typename N = double, typename F>
+    std::size_t feed(std::span<T> chunk, const F& emit);
+
+    /**
+     * End the stream, emitting the pending value, if any (a trailing delimiter at the end of the stream being
+     * ignored). The parser can then be fed a new stream.
+     *
+     * @return The number of values emitted (zero or one).
+     */
+    template<typename N = double, typename F>
+    std::size_t finish(const F& emit);
+
+    /** Is a value split across chunks pending ? **/
+    constexpr bool pending() const { return length != 0; }
+
+private:
+    /** Number of values parsed at once in a chunk. **/
+    static constexpr std::size_t blockValues = ErrorBitmap::wordBits;
+
+    /** Emit the pending value, and reset it. **/
+    template<typename N, typename F>
+    void emitPending(const F& emit);
+
+    /** Append characters to the pending value. **/
+    void append(const T* begin, const T* end);
+
+    /** The delimiter **/
+    Unit delimiter;
+
+    /** The pending value characters **/
+    std::array<Unit, Capacity> characters{};
+
+    /** Length of the pending value, which may exceed Capacity (the value is then an error) **/
+    std::size_t length = 0;
+};
+
+template<typename T, typename Format, std::size_t Capacity>
+template<typename N, typename F>
+std::size_t StreamParser<T, Format, Capacity>::feed(const std::span<T> chunk, const F& emit)
+{
+    // Complete the pending value, unless the chunk has no delimiter at all
+    std::size_t emitted = 0;
+    std::size_t begin = 0;
+    if (pending()) {
+        const std::size_t next = std::find(chunk.begin(), chunk.end(), delimiter) - chunk.begin();
+        append(chunk.data(), chunk.data() + next);
+        if (next == chunk.size()) {
+            return 0;
+        }
+        emitPending<N>(emit);
+        emitted++;
+        begin = next + 1;
+    }
+
+    // The values terminated by a delimiter are parsed in place, the last one excepted
+    std::size_t end = chunk.size();
+    while (end != begin && chunk[end - 1] != delimiter) {
+        end--;
+    }
+    std::array<N, blockValues> values;
+    ErrorBitmap::Word errors;
+    for (std::size_t offset = 0; offset < end - begin;) {
+        const auto [count, consumed] =
+            BatchParser<T, Format>(chunk.data() + begin + offset, end - begin - offset)
+                .template parse<N>(delimiter, std::span(values), std::span(&errors, 1));
+        for (std::size_t i = 0; i < count; i++) {
+            emit(values[i], ((errors >> i) & 1) != 0);
+        }
+        emitted += count;
+        offset += consumed;
+    }
+
+    // Keep the incomplete value
+    append(chunk.data() + end, chunk.data() + chunk.size());
+    return emitted;
+}
+
+template<typename T, typename Format, std::size_t Capacity>
+template<typename N, typename F>
+std::size_t StreamParser<T, Format, Capacity>::finish(const F& emit)
+{
+    if (not pending()) {
+        return 0;
+    }
+    emitPending<N>(emit);
+    return 1;
+}
+
+template<typename T, typename Format, std::size_t Capacity>
+template<typename N, typename F>
+void StreamParser<T, Format, Capacity>::emitPending(const F& emit)
+{
+    bool error = length > Capacity;
+    const N value =
+        not error ? NumericalParser<const Unit, Format>(characters.data(), length).template toAnyDouble<N>(error)
+                  : N{};
+    emit(value, error);
+    length = 0;
+}
+
+template<typename T, typename Format, std::size_t Capacity>
+void StreamParser<T, Format, Capacity>::append(const T* const begin, const T* const end)
+{
+    const std::size_t size = end - begin;
+    if (length + size <= Capacity) {
+        std::copy(begin, end, characters.data() + length);
+    }
+    length += size;
+}
+
+}; // namespace ieee754toy
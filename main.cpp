@@ -4,24 +4,374 @@
  * @maintainer Xavier Roche (xavier dot roche at algolia.com)
  */
 
+#include "AsyncReader.h"
+#include "NumericalFormatter.h"
 #include "NumericalParser.h"
+#include "ParallelParser.h"
 
-#include <iostream>
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+/** Program options. **/
+struct Options
+{
+    /** If true, write raw little-endian doubles (NaN upon error) rather than text **/
+    bool binary = false;
+
+    /** Values delimiter in input files **/
+    char delimiter = '\n';
+
+    /** Parallel parsing options **/
+    ieee754toy::ParallelOptions parallel;
+
+    /** If true, memory-map regular files rather than reading them asynchronously **/
+    bool mmap = false;
+};
+
+/** Buffered output to stdout. **/
+class Output
+{
+public:
+    Output(const Options& options)
+      : binary(options.binary)
+    {
+        buffer.reserve(capacity);
+    }
+
+    ~Output() { flush(); }
+
+    /** Write a value, or an error. **/
+    void write(double value, bool error)
+    {
+        if (buffer.size() + maxValueSize > capacity) {
+            flush();
+        }
+
+        if (binary) {
+            auto bits = std::bit_cast<std::uint64_t>(error ? std::numeric_limits<double>::quiet_NaN() : value);
+            if constexpr (std::endian::native == std::endian::big) {
+                bits = __builtin_bswap64(bits);
+            }
+            const auto* const bytes = reinterpret_cast<const char*>(&bits);
+            buffer.insert(buffer.end(), bytes, bytes + sizeof(bits));
+        } else if (not error) {
+            char text[ieee754toy::NumericalFormatter<char>::maxLength + 1];
+            const std::size_t length = ieee754toy::NumericalFormatter(text, sizeof(text)).format(value);
+            text[length] = '\n';
+            buffer.insert(buffer.end(), text, text + length + 1);
+        } else {
+            static constexpr char text[] = "<error>\n";
+            buffer.insert(buffer.end(), text, text + sizeof(text) - 1);
+        }
+    }
+
+    /** Write values, and their error bitmap. **/
+    void write(std::span<const double> values, std::span<const ieee754toy::ErrorBitmap::Word> errors)
+    {
+        for (std::size_t i = 0; i < values.size(); i++) {
+            write(values[i], ieee754toy::ErrorBitmap::test(errors, i));
+        }
+    }
+
+    /** Flush pending output. **/
+    void flush()
+    {
+        if (not buffer.empty()) {
+            std::fwrite(buffer.data(), 1, buffer.size(), stdout);
+            buffer.clear();
+        }
+        std::fflush(stdout);
+    }
+
+private:
+    static constexpr std::size_t capacity = std::size_t(1) << 20;
+    static constexpr std::size_t maxValueSize = ieee754toy::NumericalFormatter<char>::maxLength + 1;
+
+    const bool binary;
+    std::vector<char> buffer;
+};
+
+/** Parse a window of complete values. **/
+class Processor
+{
+public:
+    Processor(const Options& options, Output& output)
+      : options(options)
+      , output(output)
+    {}
+
+    /** Parse and write all values in window, which must end with a delimiter, or at the end of input. **/
+    void process(std::span<const char> window)
+    {
+        // Counting is a fast pre-pass, which avoids parsing the window twice when it has more values than the last
+        const ieee754toy::ParallelParser parser(window.data(), window.size());
+        if (const std::size_t count = parser.count(options.delimiter, options.parallel); count > values.size()) {
+            values.resize(count);
+            errors.resize(ieee754toy::ErrorBitmap::words(count));
+        }
+        const std::size_t count = parser.parse<double>(options.delimiter, values, errors, options.parallel);
+        output.write(std::span<const double>(values.data(), count), errors);
+    }
+
+private:
+    const Options& options;
+    Output& output;
+    std::vector<double> values;
+    std::vector<ieee754toy::ErrorBitmap::Word> errors;
+};
+
+/** Size of a parsing window. **/
+constexpr std::size_t windowSize = std::size_t(16) << 20;
+
+/** Process a memory-mapped regular file, one window at a time. **/
+bool processMapped(int fd, std::size_t size, char delimiter, Processor& processor)
+{
+    void* const map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    const auto* const data = static_cast<const char*>(map);
+    for (std::size_t begin = 0; begin < size;) {
+        // Window ends after the last delimiter, or after the next one for very long values
+        std::size_t end = std::min(begin + windowSize, size);
+        if (end < size) {
+            const auto last = std::find(std::make_reverse_iterator(data + end),
+                                        std::make_reverse_iterator(data + begin),
+                                        delimiter);
+            if (last.base() != data + begin) {
+                end = last.base() - data;
+            } else {
+                const auto* const next = std::find(data + end, data + size, delimiter);
+                end = next != data + size ? next - data + 1 : size;
+            }
+        }
+        processor.process(std::span<const char>(data + begin, end - begin));
+        begin = end;
+    }
+
+    munmap(map, size);
+    return true;
+}
+
+/**
+ * Process a regular file read asynchronously (see AsyncReader), the next buffers being read while one is parsed.
+ * The value split across two buffers is completed in a pending copy.
+ **/
+bool processAsync(int fd, char delimiter, Processor& processor)
+{
+    ieee754toy::AsyncReader reader(fd, { .bufferSize = windowSize, .depth = 3 });
+    std::vector<char> pending;
+    for (const std::span<const char> buffer : reader.buffers()) {
+        // Complete the pending value, unless the buffer has no delimiter at all
+        std::size_t begin = 0;
+        if (not pending.empty()) {
+            const auto next = std::find(buffer.begin(), buffer.end(), delimiter);
+            pending.insert(pending.end(), buffer.begin(), next);
+            if (next == buffer.end()) {
+                continue;
+            }
+            processor.process(pending);
+            pending.clear();
+            begin = next - buffer.begin() + 1;
+        }
+
+        // Process complete values in place, keeping the incomplete last one
+        std::size_t end = buffer.size();
+        while (end != begin && buffer[end - 1] != delimiter) {
+            end--;
+        }
+        if (end != begin) {
+            processor.process(buffer.subspan(begin, end - begin));
+        }
+        pending.assign(buffer.begin() + end, buffer.end());
+    }
+    if (not pending.empty()) {
+        processor.process(pending);
+    }
+
+    errno = reader.error();
+    return reader.error() == 0;
+}
+
+/** Process a stream (eg. a pipe), one buffer at a time. **/
+bool processStream(int fd, char delimiter, Processor& processor)
+{
+    std::vector<char> buffer(windowSize);
+    std::size_t filled = 0;
+    for (;;) {
+        const ssize_t length = read(fd, buffer.data() + filled, buffer.size() - filled);
+        if (length < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        filled += length;
+
+        // End of input: process what remains
+        if (length == 0) {
+            processor.process(std::span<const char>(buffer.data(), filled));
+            return true;
+        }
+
+        // Process complete values, keeping the incomplete last one
+        const auto last = std::find(std::make_reverse_iterator(buffer.data() + filled),
+                                    std::make_reverse_iterator(buffer.data()),
+                                    delimiter);
+        if (const std::size_t complete = last.base() - buffer.data(); complete != 0) {
+            processor.process(std::span<const char>(buffer.data(), complete));
+            std::memmove(buffer.data(), buffer.data() + complete, filled - complete);
+            filled -= complete;
+        } else if (filled == buffer.size()) {
+            buffer.resize(buffer.size() * 2);
+        }
+    }
+}
+
+/** Process a file ("-" for the standard input). **/
+bool processFile(const char* filename, const Options& options, Output& output)
+{
+    const bool input = std::strcmp(filename, "-") == 0;
+    const int fd = input ? STDIN_FILENO : open(filename, O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+
+    Processor processor(options, output);
+    struct stat st;
+    bool success;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size != 0) {
+        success = options.mmap ? processMapped(fd, st.st_size, options.delimiter, processor)
+                               : processAsync(fd, options.delimiter, processor);
+    } else {
+        success = processStream(fd, options.delimiter, processor);
+    }
+
+    if (not input) {
+        close(fd);
+    }
+    return success;
+}
+
+void usage(const char* program)
+{
+    std::fprintf(stderr,
+                 "Usage: %s [options] [--] [value ...]\n"
+                 "Options:\n"
+                 "  -i, --input <file>      parse values from file ('-' for the standard input)\n"
+                 "  -b, --binary            write raw little-endian doubles (NaN upon error)\n"
+                 "  -d, --delimiter <char>  values delimiter in input (default: newline)\n"
+                 "  -t, --threads <count>   parsing threads (default: all cores)\n"
+                 "  -g, --grain <bytes>     parallel chunk size (default: %zu)\n"
+                 "  -c, --cache             cache recently parsed values (for low-cardinality inputs)\n"
+                 "  -m, --mmap              memory-map regular files rather than reading them asynchronously\n"
+                 "  -s, --simd <level>      force the SIMD level of the parsing kernels (default: %s)\n",
+                 program,
+                 ieee754toy::ParallelOptions{}.grain,
+                 std::string(ieee754toy::simdLevelName(ieee754toy::simdLevel())).c_str());
+}
+
+/** Does an argument starting with '-' look like a negative value (eg. "-1", "-.5", "-inf" or "-nan") ? **/
+bool isNegativeValue(const char* argument)
+{
+    const char* const value = argument + 1;
+    return std::isdigit(static_cast<unsigned char>(value[0])) || value[0] == '.' ||
+           strncasecmp(value, "inf", 3) == 0 || strncasecmp(value, "nan", 3) == 0;
+}
+
+}; // namespace
 
 int main(int argc, char** argv)
 {
-    for (int i = 1; i < argc; i++) {
-        ieee754toy::NumericalParser parser(argv[i], strlen(argv[i]));
-        bool error{ false };
-        auto value = parser.toDouble(error);
-        if (not error) {
-            std::cout << value << std::endl;
+    Options options;
+    std::vector<const char*> inputs;
+
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; i++) {
+        const char* const option = argv[i];
+        const auto is = [option](const char* shortName, const char* longName) {
+            return std::strcmp(option, shortName) == 0 || std::strcmp(option, longName) == 0;
+        };
+        const bool hasArgument = i + 1 < argc;
+        if (is("--", "--")) {
+            i++;
+            break;
+        } else if (is("-b", "--binary")) {
+            options.binary = true;
+        } else if (is("-i", "--input") && hasArgument) {
+            inputs.push_back(argv[++i]);
+        } else if (is("-d", "--delimiter") && hasArgument && std::strlen(argv[i + 1]) == 1) {
+            options.delimiter = argv[++i][0];
+        } else if (is("-t", "--threads") && hasArgument) {
+            options.parallel.threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (is("-g", "--grain") && hasArgument) {
+            options.parallel.grain = std::strtoull(argv[++i], nullptr, 10);
+        } else if (is("-c", "--cache")) {
+            options.parallel.cache = true;
+        } else if (is("-m", "--mmap")) {
+            options.mmap = true;
+        } else if (is("-s", "--simd") && hasArgument) {
+            const auto level = ieee754toy::simdLevelFromName(argv[++i]);
+            if (not level.has_value() || not ieee754toy::forceSimdLevel(*level)) {
+                std::fprintf(stderr, "%s: unsupported SIMD level: %s\n", argv[0], argv[i]);
+                return EXIT_FAILURE;
+            }
+        } else if (is("-h", "--help")) {
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        } else if (isNegativeValue(option)) {
+            break;
         } else {
-            std::cout << "<error>" << std::endl;
+            // Unknown option, or option without its argument
+            std::fprintf(stderr, "%s: invalid option, or missing argument: %s\n", argv[0], option);
+            usage(argv[0]);
+            return EXIT_FAILURE;
         }
     }
 
+    Output output(options);
+
+    for (const char* filename : inputs) {
+        if (not processFile(filename, options, output)) {
+            output.flush();
+            std::fprintf(stderr, "%s: %s: %s\n", argv[0], filename, std::strerror(errno));
+            return EXIT_FAILURE;
+        }
+    }
+
+    for (; i < argc; i++) {
+        ieee754toy::NumericalParser parser(argv[i], strlen(argv[i]));
+        bool error{ false };
+        const auto value = parser.toDouble(error);
+        output.write(value, error);
+    }
+
+    // Instrumented builds (IEEE754TOY_INSTRUMENTATION) report their counters
+    if constexpr (ieee754toy::instrumentationEnabled) {
+        output.flush();
+        ieee754toy::dumpInstrumentation(stderr);
+    }
+
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
@@ -0,0 +1,722 @@
+/*
+ * IEEE754 constexpr parser toy. Differential fuzzing against strtod.
+ * Thanks to Algolia for giving me the opportunity to develop this toy!
+ * @maintainer Xavier Roche (xavier dot roche at algolia.com)
+ */
+
+/**
+ * Compare NumericalParser::toAnyDouble<double> and NumericalParser::parse<double> with strtod on fuzzed
+ * inputs, BatchParser with the kernels of every SIMD level supported by the CPU (and into an Arrow column, and
+ * through a parse cache), StreamParser over the input split in two chunks, and BatchScanner validation with
+ * parseMantissaExponent (on all inputs, including the invalid ones). The standalone driver also checks that
+ * parsing through a ParseSession does not allocate in steady state, checks parse() on numbers whose exponent
+ * does not fit in the exponent type, checks that empty values are errors in the batch parser, and compares
+ * ParallelParser, and StreamParser over columns split into random chunks, with BatchParser.
+ * Built with -fsanitize=fuzzer, this is a libFuzzer target. Otherwise (IEEE754TOY_STANDALONE_FUZZER), a standalone
+ * driver checks random numbers, and reports mismatches and throughput.
+ * Usage (standalone): ieee754toy-fuzz-strtod [--count <n>] [--digits <n>] [--seed <n>]
+ */
+
+#include "BatchParser.h"
+#include "BatchScanner.h"
+#include "NumericalParser.h"
+#include "ParallelParser.h"
+#include "ParseCache.h"
+#include "ParseSession.h"
+#include "StreamParser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <span>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+/**
+ * Compare the batch scanner validation of the newline-delimited values of the input with parseMantissaExponent,
+ * with the kernels of every SIMD level supported by the CPU.
+ * @return @c false upon mismatch.
+ **/
+bool scan(const std::string& input, bool report)
+{
+    const ieee754toy::BatchScanner scanner(input.data(), input.size());
+    const std::size_t count = scanner.count('\n');
+    std::vector<std::size_t> ends(count);
+    std::vector<ieee754toy::ErrorBitmap::Word> errors(ieee754toy::ErrorBitmap::words(count));
+
+    const ieee754toy::SimdLevel selected = ieee754toy::simdLevel();
+    bool match = true;
+    for (const ieee754toy::SimdLevel level : ieee754toy::simdLevels) {
+        if (ieee754toy::forceSimdLevel(level)) {
+            const auto [scanned, consumed, invalid] = scanner.validate('\n', std::span(ends), std::span(errors));
+            match = match && scanned == count && consumed == input.size();
+            std::size_t begin = 0;
+            std::size_t rejected = 0;
+            for (std::size_t i = 0; i < scanned && match; i++) {
+                const ieee754toy::NumericalParser value(input.data() + begin, ends[i] - begin);
+                const auto [parsed, number] = value.parseMantissaExponent<double>();
+                const bool valid = parsed != 0 && parsed == ends[i] - begin;
+                rejected += valid ? 0 : 1;
+                match = valid != ieee754toy::ErrorBitmap::test(errors, i);
+                begin = ends[i] + 1;
+            }
+            match = match && rejected == invalid;
+            if (not match) {
+                if (report) {
+                    std::fprintf(stderr,
+                                 "mismatch: %s: batch scanner differs with the %s kernels\n",
+                                 input.c_str(),
+                                 ieee754toy::simdLevelName(level).data());
+                }
+                break;
+            }
+        }
+    }
+    ieee754toy::forceSimdLevel(selected);
+    return match;
+}
+
+/**
+ * Is the input spelled in a way strtod accepts but NumericalParser does not support ? (leading whitespace,
+ * "infinity", signed NaNs or NaN payloads, and hexadecimal floats, which the default format does not parse)
+ **/
+bool unsupportedSpelling(const std::string& input)
+{
+    if (input.empty() || std::isspace(static_cast<unsigned char>(input[0]))) {
+        return true;
+    }
+    const bool sign = input[0] == '-' || input[0] == '+';
+    std::string lower = input.substr(sign ? 1 : 0);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+    return lower.starts_with("0x") || (lower.starts_with("inf") && lower.size() > 3) ||
+           (lower.starts_with("nan") && (sign || lower.size() > 3));
+}
+
+/**
+ * Compare with strtod.
+ * @return @c false upon mismatch. Inputs rejected by strtod are ignored (the scanner excepted), and so are inputs
+ * rejected by NumericalParser which are unsupported spellings (see unsupportedSpelling()), or whose explicit
+ * exponent overflows (see ParseError::ExponentOverflow).
+ **/
+bool compare(const char* data, std::size_t size, bool report)
+{
+    const std::string input(data, size);
+
+    bool error = false;
+    const double value = ieee754toy::NumericalParser(input.data(), input.size()).toAnyDouble<double>(error);
+
+    // The scanner accepts and rejects the same inputs (checked before strtod, which ignores invalid inputs)
+    if (not scan(input, report)) {
+        return false;
+    }
+
+    char* end = nullptr;
+    const double reference = std::strtod(input.c_str(), &end);
+    if (input.empty() || end != input.c_str() + input.size()) {
+        return true;
+    }
+
+    // Numbers accepted by strtod are not rejected
+    const ieee754toy::NumericalParser numerical(input.data(), input.size());
+    const auto result = numerical.parse<double>();
+    if (error) {
+        const bool rejected =
+            not unsupportedSpelling(input) && result.error != ieee754toy::ParseError::ExponentOverflow;
+        if (rejected && report) {
+            std::fprintf(stderr,
+                         "mismatch: %s: rejected (error %d), expected 0x%016llX\n",
+                         input.c_str(),
+                         static_cast<int>(result.error),
+                         static_cast<unsigned long long>(std::bit_cast<std::uint64_t>(reference)));
+        }
+        return not rejected;
+    }
+
+    // parse() yields the same value, and reports infinite and zero values for out of range numbers (special
+    // values, such as "inf", are not out of range)
+    const bool decimal = std::get<2>(numerical.parseNumber<double>()) == ieee754toy::NumberKind::Decimal;
+    const bool consistent =
+        result.valid() && std::bit_cast<std::uint64_t>(result.value) == std::bit_cast<std::uint64_t>(value) &&
+        (result.error == ieee754toy::ParseError::Overflow) == (decimal && std::isinf(reference)) &&
+        (result.error != ieee754toy::ParseError::Underflow || reference == 0);
+
+    // The batch parser yields the same value, with the kernels of every SIMD level supported by the CPU
+    const ieee754toy::SimdLevel selected = ieee754toy::simdLevel();
+    const char* mismatchLevel = nullptr;
+    for (const ieee754toy::SimdLevel level : ieee754toy::simdLevels) {
+        if (ieee754toy::forceSimdLevel(level)) {
+            double batch = 0;
+            ieee754toy::ErrorBitmap::Word errors = 0;
+            ieee754toy::BatchParser(input.data(), input.size())
+                .parse<double>('\n', std::span(&batch, 1), std::span(&errors, 1));
+            if (errors != 0 || std::bit_cast<std::uint64_t>(batch) != std::bit_cast<std::uint64_t>(value)) {
+                mismatchLevel = ieee754toy::simdLevelName(level).data();
+            }
+        }
+    }
+    ieee754toy::forceSimdLevel(selected);
+
+    // The Arrow column output holds the same valid value (the validity bitmap being deliberately misaligned)
+    double column = 0;
+    alignas(ieee754toy::ErrorBitmap::Word) std::uint8_t storage[sizeof(ieee754toy::ErrorBitmap::Word) + 1] = {};
+    const std::span validity(storage + 1, sizeof(ieee754toy::ErrorBitmap::Word));
+    const ieee754toy::BatchParser parser(input.data(), input.size());
+    const auto [count, consumed, nulls] = parser.parseArrow<double>('\n', std::span(&column, 1), validity);
+    const bool arrow = count == 1 && nulls == 0 && ieee754toy::ArrowColumn::valid(validity, 0) &&
+                       std::bit_cast<std::uint64_t>(column) == std::bit_cast<std::uint64_t>(value);
+
+    // A parse cache yields the same value, parsed or cached (a tiny cache, shared by all inputs, evicts often)
+    static ieee754toy::ParseCache<double, 4> cache;
+    bool cacheMatch = true;
+    for (int i = 0; i < 2; i++) {
+        bool cachedError = false;
+        const double cached = cache.parse(input.data(), input.data() + input.size(), cachedError);
+        cacheMatch = cacheMatch && not cachedError &&
+                     std::bit_cast<std::uint64_t>(cached) == std::bit_cast<std::uint64_t>(value);
+    }
+
+    // The stream parser yields the same value, the input being split in two chunks (unless it is too long)
+    constexpr std::size_t capacity = 1024;
+    double streamed = 0;
+    bool streamError = true;
+    const auto emit = [&](const double result, const bool error) {
+        streamed = result;
+        streamError = error;
+    };
+    ieee754toy::StreamParser<const char, ieee754toy::DefaultNumberFormat, capacity> stream('\n');
+    const std::size_t half = input.size() / 2;
+    stream.feed(std::span(input.data(), half), emit);
+    stream.feed(std::span(input.data() + half, input.size() - half), emit);
+    const bool streamMatch =
+        stream.finish(emit) == 1 &&
+        (input.size() > capacity ||
+         (not streamError && std::bit_cast<std::uint64_t>(streamed) == std::bit_cast<std::uint64_t>(value)));
+
+    const bool match = std::isnan(value)
+                           ? std::isnan(reference)
+                           : std::bit_cast<std::uint64_t>(value) == std::bit_cast<std::uint64_t>(reference);
+    if (not match && report) {
+        std::fprintf(stderr,
+                     "mismatch: %s: expected 0x%016llX, got 0x%016llX\n",
+                     input.c_str(),
+                     static_cast<unsigned long long>(std::bit_cast<std::uint64_t>(reference)),
+                     static_cast<unsigned long long>(std::bit_cast<std::uint64_t>(value)));
+    } else if (not consistent && report) {
+        std::fprintf(stderr,
+                     "mismatch: %s: parse() returned 0x%016llX, error %d\n",
+                     input.c_str(),
+                     static_cast<unsigned long long>(std::bit_cast<std::uint64_t>(result.value)),
+                     static_cast<int>(result.error));
+    } else if (mismatchLevel != nullptr && report) {
+        std::fprintf(stderr,
+                     "mismatch: %s: batch parser differs with the %s kernels\n",
+                     input.c_str(),
+                     mismatchLevel);
+    } else if (not arrow && report) {
+        std::fprintf(stderr, "mismatch: %s: Arrow column differs\n", input.c_str());
+    } else if (not cacheMatch && report) {
+        std::fprintf(stderr, "mismatch: %s: parse cache differs\n", input.c_str());
+    } else if (not streamMatch && report) {
+        std::fprintf(stderr, "mismatch: %s: stream parser differs\n", input.c_str());
+    }
+    return match && consistent && mismatchLevel == nullptr && arrow && cacheMatch && streamMatch;
+}
+
+}; // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+    if (not compare(reinterpret_cast<const char*>(data), size, true)) {
+        std::abort();
+    }
+    return 0;
+}
+
+#ifdef IEEE754TOY_STANDALONE_FUZZER
+
+namespace {
+
+/** Generate a random number: sign, digits with an optional dot, and an optional exponent, seldom corrupted. **/
+std::string generate(std::mt19937_64& random, std::size_t maxDigits)
+{
+    std::string input;
+    if (random() % 4 == 0) {
+        input += random() % 2 == 0 ? '-' : '+';
+    }
+
+    const std::size_t digits = 1 + random() % maxDigits;
+    const std::size_t dot = random() % 3 == 0 ? digits : random() % (digits + 1);
+    for (std::size_t i = 0; i < digits; i++) {
+        if (i == dot) {
+            input += '.';
+        }
+        // Favor zeros, and nines, to hit rounding boundaries
+        const auto choice = random() % 16;
+        input += choice < 3 ? '0' : choice < 5 ? '9' : static_cast<char>('0' + random() % 10);
+    }
+
+    if (random() % 2 == 0) {
+        input += random() % 2 == 0 ? 'e' : 'E';
+        if (random() % 2 == 0) {
+            input += random() % 2 == 0 ? '-' : '+';
+        }
+        input += std::to_string(random() % 360);
+    }
+
+    // Seldom corrupt a character, for invalid inputs
+    if (random() % 16 == 0) {
+        constexpr char corruptions[] = "+-.eE_x \n";
+        input[random() % input.size()] = corruptions[random() % (sizeof(corruptions) - 1)];
+    }
+
+    return input;
+}
+
+/**
+ * Compare parse() with strtof or strtod on a number whose exponent does not fit in the exponent type, once the
+ * digits are taken into account (very long mantissas, or explicit exponents close to the limits), or in 64 bits.
+ * @return @c false upon mismatch.
+ **/
+template<typename N>
+bool checkExponent(const std::string& input, ieee754toy::ParseError expected)
+{
+    const auto result = ieee754toy::NumericalParser(input.data(), input.size()).template parse<N>();
+    const N reference = std::is_same_v<N, float> ? std::strtof(input.c_str(), nullptr)
+                                                 : static_cast<N>(std::strtod(input.c_str(), nullptr));
+    const bool match = result.value == reference && std::signbit(result.value) == std::signbit(reference) &&
+                       result.error == expected;
+    if (not match) {
+        std::fprintf(stderr,
+                     "mismatch: %.40s... (%zu characters): parse() returned %g, error %d\n",
+                     input.c_str(),
+                     input.size(),
+                     static_cast<double>(result.value),
+                     static_cast<int>(result.error));
+    }
+    return match;
+}
+
+/**
+ * Check parse() on numbers whose exponent does not fit in the exponent type (see checkExponent()).
+ * @return @c false upon mismatch.
+ **/
+bool checkExponents()
+{
+    using ieee754toy::ParseError;
+    bool match = checkExponent<float>("123456789012345678901234567890e32760", ParseError::Overflow);
+    match = checkExponent<float>(std::string(40000, '1'), ParseError::Overflow) && match;
+    match = checkExponent<float>("0." + std::string(40000, '0') + "1", ParseError::Underflow) && match;
+    match = checkExponent<float>(std::string(30000, '1') + "e-29995", ParseError::Inexact) && match;
+    match = checkExponent<float>("1e40000", ParseError::Overflow) && match;
+    match = checkExponent<double>("1e40000", ParseError::Overflow) && match;
+    match = checkExponent<float>("1e-40000", ParseError::Underflow) && match;
+    match = checkExponent<double>("1e-40000", ParseError::Underflow) && match;
+    match = checkExponent<float>("1e99999999999999999999", ParseError::ExponentOverflow) && match;
+    match = checkExponent<double>("-1e99999999999999999999", ParseError::ExponentOverflow) && match;
+    match = checkExponent<double>("0.0000001e-2147483647", ParseError::Underflow) && match;
+    match = checkExponent<double>("-1234567e2147483647", ParseError::Overflow) && match;
+    return match;
+}
+
+/**
+ * Generate random values (see generate()), with empty values (leading, consecutive, and in the middle), the last
+ * one excepted (a trailing delimiter being ignored).
+ **/
+std::vector<std::string> generateValues(std::mt19937_64& random, std::size_t digits, std::size_t count)
+{
+    std::vector<std::string> values(count);
+    for (std::size_t i = 1; i < count; i++) {
+        if (i + 1 == count || random() % 4 != 0) {
+            values[i] = generate(random, digits);
+        }
+    }
+    return values;
+}
+
+/** Join values with a delimiter. **/
+std::string join(const std::vector<std::string>& values, char delimiter)
+{
+    std::string joined;
+    for (const std::string& value : values) {
+        joined += value;
+        joined += delimiter;
+    }
+    joined.pop_back();
+    return joined;
+}
+
+/**
+ * Parse a column with empty values through BatchParser (with the kernels of every SIMD level supported by the
+ * CPU, into an Arrow column, through offsets, and through a parse cache), every value being in error if and only
+ * if it is empty or rejected by toAnyDouble.
+ * @return @c false upon mismatch.
+ **/
+bool checkEmptyValues(std::mt19937_64& random, std::size_t digits)
+{
+    constexpr std::size_t count = 1000;
+    const std::vector<std::string> strings = generateValues(random, digits, count);
+    const std::string column = join(strings, ',');
+
+    // Expected values and errors
+    std::vector<double> expected(count);
+    std::vector<bool> invalid(count);
+    for (std::size_t i = 0; i < count; i++) {
+        bool error = false;
+        const double value =
+            ieee754toy::NumericalParser(strings[i].data(), strings[i].size()).toAnyDouble<double>(error);
+        error = error || strings[i].empty();
+        invalid[i] = error;
+        expected[i] = error ? 0 : value;
+    }
+    const auto matches = [&](const std::vector<double>& values, const auto& isError) {
+        bool match = true;
+        for (std::size_t i = 0; i < count; i++) {
+            match = match && isError(i) == invalid[i] &&
+                    std::bit_cast<std::uint64_t>(values[i]) == std::bit_cast<std::uint64_t>(expected[i]);
+        }
+        return match;
+    };
+
+    std::vector<double> values(count);
+    std::vector<ieee754toy::ErrorBitmap::Word> errors(ieee754toy::ErrorBitmap::words(count));
+    const auto inError = [&](std::size_t i) { return ieee754toy::ErrorBitmap::test(errors, i); };
+    const ieee754toy::BatchParser parser(column.data(), column.size());
+
+    const ieee754toy::SimdLevel selected = ieee754toy::simdLevel();
+    bool batch = true;
+    for (const ieee754toy::SimdLevel level : ieee754toy::simdLevels) {
+        if (ieee754toy::forceSimdLevel(level)) {
+            const auto [parsed, consumed] = parser.parse<double>(',', std::span(values), std::span(errors));
+            batch = batch && parsed == count && consumed == column.size() && matches(values, inError);
+        }
+    }
+    ieee754toy::forceSimdLevel(selected);
+
+    const std::size_t invalidCount = std::count(invalid.begin(), invalid.end(), true);
+    std::vector<ieee754toy::ErrorBitmap::Word> validity(errors.size());
+    const auto validityBytes = std::span(reinterpret_cast<std::uint8_t*>(validity.data()),
+                                         validity.size() * sizeof(ieee754toy::ErrorBitmap::Word));
+    const auto isNull = [&](std::size_t i) { return not ieee754toy::ArrowColumn::valid(validityBytes, i); };
+    const auto [arrowCount, arrowConsumed, nulls] =
+        parser.parseArrow<double>(',', std::span(values), validityBytes);
+    const bool arrow = arrowCount == count && nulls == invalidCount && matches(values, isNull);
+
+    // The same values, delimited by offsets
+    std::string packed;
+    std::vector<std::size_t> offsets(1, 0);
+    for (const std::string& value : strings) {
+        packed += value;
+        offsets.push_back(packed.size());
+    }
+    const std::size_t offsetCount = ieee754toy::BatchParser(packed.data(), packed.size())
+                                        .parse<double>(std::span<const std::size_t>(offsets),
+                                                       std::span(values),
+                                                       std::span(errors));
+    const bool offsetMatch = offsetCount == count && matches(values, inError);
+
+    ieee754toy::ParseCache<double, 4> cache;
+    const auto [cachedCount, cachedConsumed] = parser.parse(',', std::span(values), std::span(errors), cache);
+    const bool cached = cachedCount == count && matches(values, inError);
+
+    std::printf("empty values: %zu values in error\n", invalidCount);
+    if (not batch || not arrow || not offsetMatch || not cached) {
+        std::fprintf(stderr,
+                     "mismatch: empty values are not errors (batch %d, Arrow %d, offsets %d, cache %d)\n",
+                     batch,
+                     arrow,
+                     offsetMatch,
+                     cached);
+    }
+    return batch && arrow && offsetMatch && cached;
+}
+
+/**
+ * Compare ParallelParser::parse and ParallelParser::count with a single-threaded BatchParser over a column with
+ * values in error and empty values, for various grains (down to one character, ie. one value per chunk) and
+ * numbers of threads.
+ * @return @c false upon mismatch.
+ **/
+bool checkParallel(std::mt19937_64& random, std::size_t digits)
+{
+    constexpr std::size_t count = 5000;
+    const std::string column = join(generateValues(random, digits, count), ',');
+
+    std::vector<double> expected(count);
+    std::vector<ieee754toy::ErrorBitmap::Word> expectedErrors(ieee754toy::ErrorBitmap::words(count));
+    ieee754toy::BatchParser(column.data(), column.size())
+        .parse<double>(',', std::span(expected), std::span(expectedErrors));
+
+    const auto identical = [](double a, double b) {
+        return std::bit_cast<std::uint64_t>(a) == std::bit_cast<std::uint64_t>(b);
+    };
+    bool match = true;
+    std::vector<double> values(count);
+    std::vector<ieee754toy::ErrorBitmap::Word> errors(expectedErrors.size());
+    const ieee754toy::ParallelParser parser(column.data(), column.size());
+    const std::size_t grains[] = { 1, 7, 100, 4096, column.size() };
+    for (const std::size_t grain : grains) {
+        for (const unsigned threads : { 1u, 2u, 3u, 8u }) {
+            for (const bool cache : { false, true }) {
+                const ieee754toy::ParallelOptions options{ .grain = grain, .threads = threads, .cache = cache };
+                std::fill(values.begin(), values.end(), -1.0);
+                std::fill(errors.begin(), errors.end(), ~ieee754toy::ErrorBitmap::Word(0));
+                const std::size_t parsed = parser.parse(',', std::span(values), std::span(errors), options);
+                const bool same = parsed == count && parser.count(',', options) == count &&
+                                  errors == expectedErrors &&
+                                  std::equal(values.begin(), values.end(), expected.begin(), identical);
+                if (not same) {
+                    std::fprintf(stderr,
+                                 "mismatch: parallel parser differs (grain %zu, %u threads, cache %d)\n",
+                                 grain,
+                                 threads,
+                                 cache);
+                }
+                match = match && same;
+            }
+        }
+    }
+    return match;
+}
+
+/**
+ * Compare StreamParser with BatchParser over the concatenated chunks, for columns with values in error and empty
+ * values split into random chunks (empty, of one character, holding several values, or ending right before or
+ * after a delimiter). The values split across chunks which are longer than the stream parser capacity are
+ * errors.
+ * @return @c false upon mismatch.
+ **/
+bool checkStream(std::mt19937_64& random)
+{
+    constexpr std::size_t count = 100;
+    constexpr std::size_t capacity = 24;
+    bool match = true;
+    std::size_t overflows = 0;
+    for (int round = 0; round < 200 && match; round++) {
+        std::string column = join(generateValues(random, 40, count), ',');
+        if (random() % 2 == 0) {
+            column += ',';
+        }
+
+        std::vector<double> expected(count);
+        std::vector<ieee754toy::ErrorBitmap::Word> errors(ieee754toy::ErrorBitmap::words(count));
+        ieee754toy::BatchParser(column.data(), column.size())
+            .parse<double>(',', std::span(expected), std::span(errors));
+        std::vector<bool> invalid(count);
+        for (std::size_t i = 0; i < count; i++) {
+            invalid[i] = ieee754toy::ErrorBitmap::test(errors, i);
+        }
+
+        // Random chunk sizes (one character, a few, or many values), the chunk boundaries being kept
+        const std::size_t maxChunk = std::size_t(1) << random() % 9;
+        std::vector<std::size_t> boundaries;
+        for (std::size_t end = 0; end < column.size();) {
+            end = std::min(end + random() % (maxChunk + 1), column.size());
+            boundaries.push_back(end);
+        }
+
+        // A value fed through the pending state (split by a boundary, or ending the stream) is an error if longer
+        // than the capacity
+        std::size_t begin = 0;
+        for (std::size_t i = 0; i < count; i++) {
+            const std::size_t end = std::min(column.find(',', begin), column.size());
+            const bool split =
+                end == column.size() || std::any_of(boundaries.begin(), boundaries.end(), [&](std::size_t b) {
+                    return begin < b && b <= end;
+                });
+            if (split && end - begin > capacity) {
+                invalid[i] = true;
+                expected[i] = 0;
+                overflows++;
+            }
+            begin = end + 1;
+        }
+
+        std::vector<double> values;
+        std::vector<bool> streamErrors;
+        const auto emit = [&](const double value, const bool error) {
+            values.push_back(value);
+            streamErrors.push_back(error);
+        };
+        ieee754toy::StreamParser<const char, ieee754toy::DefaultNumberFormat, capacity> stream(',');
+        std::size_t emitted = 0;
+        std::size_t offset = 0;
+        for (const std::size_t end : boundaries) {
+            emitted += stream.feed(std::span(column.data() + offset, end - offset), emit);
+            offset = end;
+        }
+        emitted += stream.finish(emit);
+
+        match = emitted == count && values.size() == count && streamErrors == invalid;
+        for (std::size_t i = 0; i < values.size() && match; i++) {
+            match = std::bit_cast<std::uint64_t>(values[i]) == std::bit_cast<std::uint64_t>(expected[i]);
+        }
+        if (not match) {
+            std::fprintf(stderr,
+                         "mismatch: stream parser differs over %zu chunks of at most %zu characters: %s\n",
+                         boundaries.size(),
+                         maxChunk,
+                         column.c_str());
+        }
+    }
+
+    std::printf("stream parser: %zu values split across chunks beyond the capacity\n", overflows);
+    return match;
+}
+
+/** Number of allocations (see the replaced operator new). **/
+std::atomic<std::uint64_t> allocations = 0;
+
+/**
+ * Parse a column of random numbers through a parse session, twice: the second (steady-state) pass must not
+ * allocate, and the session must record the values in error of the bitmap.
+ * @return @c false upon failure.
+ **/
+bool checkSession(std::mt19937_64& random, std::size_t digits)
+{
+    constexpr std::size_t count = 10000;
+    std::string column;
+    for (std::size_t i = 0; i < count; i++) {
+        column += generate(random, digits);
+        column += ',';
+    }
+
+    std::vector<double> values(count);
+    std::vector<ieee754toy::ErrorBitmap::Word> errors(ieee754toy::ErrorBitmap::words(count));
+    ieee754toy::ParseSession<double> session;
+    const ieee754toy::BatchParser parser(column.data(), column.size());
+    std::uint64_t steadyAllocations = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        session.clear();
+        const std::uint64_t before = allocations.load();
+        parser.parse(',', std::span(values), std::span(errors), session);
+        steadyAllocations = allocations.load() - before;
+    }
+
+    std::size_t invalid = 0;
+    for (const ieee754toy::ErrorBitmap::Word word : errors) {
+        invalid += std::popcount(word);
+    }
+    bool recorded = session.errors().size() == invalid;
+    for (const ieee754toy::ParseErrorRecord& record : session.errors()) {
+        recorded = recorded && ieee754toy::ErrorBitmap::test(errors, record.index) &&
+                   record.error != ieee754toy::ParseError::None;
+    }
+
+    std::printf("parse session: %zu values in error, %llu steady-state allocations\n",
+                session.errors().size(),
+                static_cast<unsigned long long>(steadyAllocations));
+    if (not recorded) {
+        std::fprintf(stderr, "mismatch: parse session records differ from the error bitmap\n");
+    }
+    return recorded && steadyAllocations == 0;
+}
+
+}; // namespace
+
+// Count allocations, for the parse session check (the replacements are not inlined, as the compiler would then
+// flag a mismatched allocation function when memory from the built-in operator new is released with free())
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* const memory = std::malloc(size != 0 ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+[[gnu::noinline]] void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+// The default memory resource of the standard containers uses the aligned forms
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    const auto align = static_cast<std::size_t>(alignment);
+    const std::size_t rounded = (std::max<std::size_t>(size, 1) + align - 1) / align * align;
+    if (void* const memory = std::aligned_alloc(align, rounded)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* memory, std::align_val_t) noexcept
+{
+    std::free(memory);
+}
+
+[[gnu::noinline]] void operator delete(void* memory, std::size_t, std::align_val_t) noexcept
+{
+    std::free(memory);
+}
+
+int main(int argc, char** argv)
+{
+    std::uint64_t count = 1000000;
+    std::size_t digits = 19;
+    std::uint64_t seed = 42;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--count") == 0) {
+            count = std::strtoull(argv[i + 1], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--digits") == 0) {
+            digits = std::max<std::size_t>(std::strtoull(argv[i + 1], nullptr, 10), 1);
+        } else if (std::strcmp(argv[i], "--seed") == 0) {
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "Usage: %s [--count <n>] [--digits <n>] [--seed <n>]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::mt19937_64 random(seed);
+    std::uint64_t mismatches = 0;
+    std::uint64_t bytes = 0;
+    std::chrono::steady_clock::duration elapsed{};
+    for (std::uint64_t i = 0; i < count; i++) {
+        const std::string input = generate(random, digits);
+        bytes += input.size();
+
+        const auto start = std::chrono::steady_clock::now();
+        const bool match = compare(input.data(), input.size(), mismatches < 16);
+        elapsed += std::chrono::steady_clock::now() - start;
+
+        mismatches += match ? 0 : 1;
+    }
+
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    std::printf("%llu values checked, %llu mismatches, %.2f ns/value, %.1f MB/s (including strtod)\n",
+                static_cast<unsigned long long>(count),
+                static_cast<unsigned long long>(mismatches),
+                seconds * 1e9 / std::max<std::uint64_t>(count, 1),
+                bytes / seconds / 1e6);
+
+    const bool session = checkSession(random, digits);
+    const bool exponents = checkExponents();
+    const bool empty = checkEmptyValues(random, digits);
+    const bool parallel = checkParallel(random, digits);
+    const bool streamed = checkStream(random);
+
+    return mismatches == 0 && session && exponents && empty && parallel && streamed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
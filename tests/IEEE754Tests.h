@@ -4,8 +4,11 @@
  * @maintainer Xavier Roche (xavier dot roche at algolia.com)
  */
 
+#include "NumericalFormatter.h"
 #include "NumericalParser.h"
 #include <array>
+#include <cstdint>
+#include <string_view>
 #include <tuple>
 
 using namespace ieee754toy;
@@ -289,6 +292,355 @@ void testParseDoubleLimits()
                   std::make_tuple(21, false, 10000000000000001110UL, 1));
 }
 
+void testParsePrefixStatic()
+{
+    static_assert(unpack(NumericalParser<const char>(toArray("1.1.1")).parseMantissaExponent<double, true>()) ==
+                  std::make_tuple(3, false, 11, -1));
+    static_assert(unpack(NumericalParser<const char>(toArray("12abc")).parseMantissaExponent<double, true>()) ==
+                  std::make_tuple(2, false, 12, 0));
+    static_assert(unpack(NumericalParser<const char>(toArray("-1-2")).parseMantissaExponent<double, true>()) ==
+                  std::make_tuple(2, true, 1, 0));
+    static_assert(unpack(NumericalParser<const char>(toArray("1.5,2")).parseMantissaExponent<double, true>()) ==
+                  std::make_tuple(3, false, 15, -1));
+    static_assert(unpack(NumericalParser<const char>(toArray("1.")).parseMantissaExponent<double, true>()) ==
+                  std::make_tuple(2, false, 1, 0));
+    static_assert(unpack(NumericalParser<const char>(toArray("1e5x")).parseMantissaExponent<double, true>()) ==
+                  std::make_tuple(3, false, 1, 5));
+    static_assert(unpack(NumericalParser<const char>(toArray("1e-5-")).parseMantissaExponent<double, true>()) ==
+                  std::make_tuple(4, false, 1, -5));
+
+    // The exponent is not part of the number
+    static_assert(unpack(NumericalParser<const char>(toArray("1e")).parseMantissaExponent<double, true>()) ==
+                  std::make_tuple(1, false, 1, 0));
+    static_assert(unpack(NumericalParser<const char>(toArray("1e+")).parseMantissaExponent<double, true>()) ==
+                  std::make_tuple(1, false, 1, 0));
+    static_assert(unpack(NumericalParser<const char>(toArray("1ex")).parseMantissaExponent<double, true>()) ==
+                  std::make_tuple(1, false, 1, 0));
+
+    // Saturated exponent
+    static_assert(std::get<0>(unpack(NumericalParser<const char>(toArray("1e-99999999999999999999"))
+                                         .parseMantissaExponent<double, true>())) == 23);
+    static_assert(std::get<3>(unpack(NumericalParser<const char>(toArray("1e-99999999999999999999"))
+                                         .parseMantissaExponent<double, true>())) < -1000000);
+
+    // Nothing to parse
+    static_assert(
+        std::get<0>(NumericalParser<const char>(toArray("abc")).parseMantissaExponent<double, true>()) == 0);
+    static_assert(
+        std::get<0>(NumericalParser<const char>(toArray("-")).parseMantissaExponent<double, true>()) == 0);
+    static_assert(
+        std::get<0>(NumericalParser<const char>(toArray(".e1")).parseMantissaExponent<double, true>()) == 0);
+}
+
+void testParseSpecialStatic()
+{
+    static_assert(std::get<2>(NumericalParser<const char>(toArray("Inf")).parseNumber()) ==
+                  NumberKind::Infinity);
+    static_assert(std::get<0>(NumericalParser<const char>(toArray("-INF")).parseNumber()) == 4);
+    static_assert(std::get<1>(NumericalParser<const char>(toArray("-inf")).parseNumber()).negative);
+    static_assert(not std::get<1>(NumericalParser<const char>(toArray("+Inf")).parseNumber()).negative);
+    static_assert(std::get<2>(NumericalParser<const char>(toArray("nan")).parseNumber()) == NumberKind::NaN);
+    static_assert(std::get<2>(NumericalParser<const char16_t>(toArray(u"NaN")).parseNumber()) ==
+                  NumberKind::NaN);
+    static_assert(std::get<2>(NumericalParser<const char32_t>(toArray(U"-Inf")).parseNumber()) ==
+                  NumberKind::Infinity);
+    static_assert(std::get<2>(NumericalParser<const char>(toArray("12")).parseNumber()) == NumberKind::Decimal);
+
+    // Only the special value prefix is parsed
+    static_assert(std::get<0>(NumericalParser<const char>(toArray("Infinity")).parseNumber()) == 3);
+    static_assert(std::get<0>(NumericalParser<const char>(toArray("NaN,")).parseNumber<double, true>()) == 3);
+
+    // Invalid special values
+    static_assert(std::get<0>(NumericalParser<const char>(toArray("-NaN")).parseNumber()) == 0);
+    static_assert(std::get<0>(NumericalParser<const char>(toArray(".Inf")).parseNumber()) == 0);
+    static_assert(std::get<0>(NumericalParser<const char>(toArray("--Inf")).parseNumber()) == 0);
+    static_assert(std::get<0>(NumericalParser<const char>(toArray("In")).parseNumber()) == 0);
+
+    // An exponent needs at least one digit
+    static_assert(std::get<0>(NumericalParser<const char>(toArray("1e+")).parseNumber()) == 0);
+    static_assert(std::get<0>(NumericalParser<const char>(toArray("1e-5")).parseNumber()) == 4);
+}
+
+struct DecimalCommaFormat : DefaultNumberFormat
+{
+    static constexpr char decimalPoint = ',';
+    static constexpr std::string_view digitSeparators = "_'";
+};
+
+struct HexFloatFormat : DefaultNumberFormat
+{
+    static constexpr bool hexFloats = true;
+};
+
+struct StrictDotFormat : DefaultNumberFormat
+{
+    static constexpr bool leadingDot = false;
+    static constexpr bool trailingDot = false;
+};
+
+// Parse an hexadecimal float, and return its IEEE754 representation
+template<std::size_t N>
+constexpr auto hexToIEEE754(const char (&s)[N])
+{
+    const auto [parsed, number, kind] = NumericalParser<const char, HexFloatFormat>(toArray(s)).parseNumber();
+    return IEEE754Number<double, 2>(number.negative, number.mantissa, number.exponent).toIEEE754();
+}
+
+void testParseFormatStatic()
+{
+    // Decimal comma, and digit separators
+    static_assert(
+        unpack(NumericalParser<const char, DecimalCommaFormat>(toArray("-1,25")).parseMantissaExponent()) ==
+        std::make_tuple(5, true, 125, -2));
+    static_assert(unpack(NumericalParser<const char, DecimalCommaFormat>(toArray("1'000_000,5"))
+                             .parseMantissaExponent()) == std::make_tuple(11, false, 10000005, -1));
+    static_assert(
+        std::get<0>(NumericalParser<const char, DecimalCommaFormat>(toArray("1.5")).parseMantissaExponent()) == 1);
+    static_assert(std::get<0>(NumericalParser<const char, DecimalCommaFormat>(toArray("1,5,"))
+                                  .parseMantissaExponent()) == 0);
+    static_assert(std::get<0>(NumericalParser<const char, DecimalCommaFormat>(toArray("1__0"))
+                                  .parseMantissaExponent<double, true>()) == 1);
+    static_assert(std::get<0>(NumericalParser<const char, DecimalCommaFormat>(toArray("_1"))
+                                  .parseMantissaExponent<double, true>()) == 0);
+
+    // Hexadecimal floats are already normalized base-2 numbers
+    static_assert(std::get<2>(NumericalParser<const char, HexFloatFormat>(toArray("0x1.8p3")).parseNumber()) ==
+                  NumberKind::Binary);
+    static_assert(hexToIEEE754("0x1.8p3") == 0x4028000000000000);
+    static_assert(hexToIEEE754("-0X1P-1074") == 0x8000000000000001);
+    static_assert(hexToIEEE754("0x1P+1024") == 0x7FF0000000000000);
+    // Exactly halfway: round half to even, and above halfway thanks to the sticky bit
+    static_assert(hexToIEEE754("0x1.00000000000008p0") == 0x3FF0000000000000);
+    static_assert(hexToIEEE754("0x1.000000000000080000000001p0") == 0x3FF0000000000001);
+    static_assert(std::get<0>(NumericalParser<const char, HexFloatFormat>(toArray("0x1p")).parseNumber()) == 0);
+    static_assert(std::get<0>(NumericalParser<const char, HexFloatFormat>(toArray("0x1p"))
+                                  .parseNumber<double, true>()) == 3);
+    static_assert(std::get<0>(NumericalParser<const char, HexFloatFormat>(toArray("0xg"))
+                                  .parseNumber<double, true>()) == 1);
+    static_assert(std::get<0>(NumericalParser<const char>(toArray("0x1p3")).parseNumber<double, true>()) == 1);
+
+    // Leading and trailing decimal points
+    static_assert(std::get<0>(NumericalParser<const char, StrictDotFormat>(toArray("5.5")).parseNumber()) == 3);
+    static_assert(std::get<0>(NumericalParser<const char, StrictDotFormat>(toArray(".5")).parseNumber()) == 0);
+    static_assert(std::get<0>(NumericalParser<const char, StrictDotFormat>(toArray("5.")).parseNumber()) == 0);
+    static_assert(
+        std::get<0>(NumericalParser<const char, StrictDotFormat>(toArray("5.e1")).parseNumber<double, true>()) ==
+        1);
+
+    // Fixed-point formats
+    static_assert(unpack(NumericalParser<const char, FixedFormat<7, 4>>(toArray("0001234.5600"))
+                             .parseMantissaExponent()) == std::make_tuple(12, false, 12345600, -4));
+    static_assert(unpack(NumericalParser<const char, FixedFormat<3, 0>>(toArray("042")).parseMantissaExponent()) ==
+                  std::make_tuple(3, false, 42, 0));
+    static_assert(unpack(NumericalParser<const char, FixedFormat<5, 0>>(toArray("01250"))
+                             .parseMantissaExponent()) == std::make_tuple(5, false, 1250, 0));
+    static_assert(unpack(NumericalParser<const char, FixedFormat<0, 3>>(toArray(".125"))
+                             .parseMantissaExponent()) == std::make_tuple(4, false, 125, -3));
+    static_assert(
+        std::get<0>(NumericalParser<const char, FixedFormat<5, 0>>(toArray("0125.")).parseNumber()) == 0);
+    static_assert(std::get<0>(NumericalParser<const char, FixedFormat<7, 4>>(toArray("0001234.56001"))
+                                  .parseNumber<double, true>()) == 12);
+    static_assert(std::get<0>(NumericalParser<const char, FixedFormat<7, 4>>(toArray("0001234.56001"))
+                                  .parseNumber()) == 0);
+    static_assert(
+        std::get<0>(NumericalParser<const char, FixedFormat<7, 4>>(toArray("001234.5600")).parseNumber()) == 0);
+    static_assert(
+        std::get<0>(NumericalParser<const char, FixedFormat<7, 4>>(toArray("0001234,5600")).parseNumber()) == 0);
+    static_assert(
+        std::get<0>(NumericalParser<const char, FixedFormat<7, 4>>(toArray("000123a.5600")).parseNumber()) == 0);
+    static_assert(std::get<0>(NumericalParser<const char, FixedFormat<7, 4>>(toArray("-001234.5600"))
+                                  .parseNumber()) == 0);
+    static_assert(std::get<0>(NumericalParser<const char, FixedFormat<2, 2, DecimalCommaFormat>>(toArray("12,50"))
+                                  .parseNumber()) == 5);
+}
+
+template<typename N, typename Format = DefaultNumberFormat, typename T>
+constexpr inline auto toLongIEEE754(const T& s)
+{
+    const NumericalParser<const char, Format> parser(s);
+    const auto [parsed, number] = parser.template parseMantissaExponent<N>();
+    return parser.convertTwobase(number, parsed).toIEEE754();
+}
+
+// The parsed size of a number (zero if error)
+template<typename N, typename T>
+constexpr inline std::size_t toParsedSize(const T& s)
+{
+    return std::get<0>(NumericalParser<const char>(s).template parseMantissaExponent<N>());
+}
+
+// A long number: a prefix, a repeated character, and a suffix, Size characters overall
+template<std::size_t Size, std::size_t P, std::size_t S>
+constexpr auto longNumber(const char (&prefix)[P], char repeated, const char (&suffix)[S])
+{
+    std::array<char, Size> s{};
+    s.fill(repeated);
+    std::copy(prefix, prefix + P - 1, s.begin());
+    std::copy(suffix, suffix + S - 1, s.end() - (S - 1));
+    return s;
+}
+
+void testParseLongStatic()
+{
+    // The digits that do not fit in the mantissa decide the rounding
+    static_assert(toLongIEEE754<double>(toArray("1.00000000000000011105")) == 0x3FF0000000000001);
+    static_assert(toLongIEEE754<double>(toArray("1.00000000000000011102230246252")) == 0x3FF0000000000001);
+    static_assert(toLongIEEE754<double>(toArray("1.000000000000000111022")) == 0x3FF0000000000000);
+    static_assert(toLongIEEE754<double>(toArray("1.000000000000000111022302462515654042363166809082031249")) ==
+                  0x3FF0000000000000);
+    static_assert(toLongIEEE754<double>(toArray("100000000000000011102230246251565404236316680908203126e-53")) ==
+                  0x3FF0000000000001);
+    static_assert(toLongIEEE754<double>(toArray("3."
+                                                "1415926535897932384626433832795028841971693993751058209749445923"
+                                                "078164062862089986280348253421170679")) == 0x400921FB54442D18);
+    static_assert(toLongIEEE754<double>(toArray("1234567890123456789012345678901234567890123456789012345678901234"
+                                                "567890123456789012345678901234567890")) == 0x54820FE0BA17F469);
+
+    // Exact half-way points round to even, unless followed by a non-zero digit
+    static_assert(toLongIEEE754<double>(toArray("1.00000000000000011102230246251565404236316680908203125")) ==
+                  0x3FF0000000000000);
+    static_assert(toLongIEEE754<double>(toArray("1.00000000000000033306690738754696212708950042724609375")) ==
+                  0x3FF0000000000002);
+    static_assert(toLongIEEE754<double>(toArray("1.000000000000000111022302462515654042363166809082031250001")) ==
+                  0x3FF0000000000001);
+    static_assert(toLongIEEE754<float>(toArray("1.000000059604644775390625")) == 0x3F800000);
+    static_assert(toLongIEEE754<float>(toArray("1.0000000596046447753906250001")) == 0x3F800001);
+
+    // Slightly above a single precision half-way point, which is the closest double (and would round to even)
+    static_assert(toLongIEEE754<float>(toArray("1.0000000596046448")) == 0x3F800001);
+
+    // Half of the smallest subnormal number (only maxDigits significant digits are kept, the following ones being
+    // only checked for non-zero)
+    static_assert(toLongIEEE754<double>(toArray(
+                "2.4703282292062327208828439643411068618252990130716238221279284125033775363510437593264991818081"
+                "799618989828234772285886546332835517796989819938739800539093906315035659515570226392290858392449"
+                "105184435931802849936536152500319370457678249219365623669863658480757001585769269903706311928279"
+                "558551332927834338409351978015531246597263579574622766465272827220056374006485499977096599470454"
+                "020828166226237857393450736339007967761930577506740176324673600968951340535537458516661134223766"
+                "678604162159680461914467291840300530057530849048765391711386591646239524912623653881879636239373"
+                "280423891018672348497668235089863388587925628302755995657524455507255189313690836254779186948667"
+                "994968324049705821028513185451396213837722826145437693412532098591327667236328125e-324")) == 0);
+    static_assert(toLongIEEE754<double>(toArray(
+                "2.4703282292062327208828439643411068618252990130716238221279284125033775363510437593264991818081"
+                "799618989828234772285886546332835517796989819938739800539093906315035659515570226392290858392449"
+                "105184435931802849936536152500319370457678249219365623669863658480757001585769269903706311928279"
+                "558551332927834338409351978015531246597263579574622766465272827220056374006485499977096599470454"
+                "020828166226237857393450736339007967761930577506740176324673600968951340535537458516661134223766"
+                "678604162159680461914467291840300530057530849048765391711386591646239524912623653881879636239373"
+                "280423891018672348497668235089863388587925628302755995657524455507255189313690836254779186948667"
+                "994968324049705821028513185451396213837722826145437693412532098591327667236328125000000000000000"
+                "00000000000000000000000001e-324")) == 1);
+    static_assert(toLongIEEE754<double>(toArray("-0.24703282292062327208828439643411068618252990130716238221279284"
+                                                "12503377536351044e-323")) == 0x8000000000000001);
+    static_assert(toLongIEEE754<double>(toArray("-0.24703282292062327208828439643411068618252990130716238221279284"
+                                                "12503377536351043e-323")) == 0x8000000000000000);
+
+    // Fixed-point formats, beyond the exact fast path
+    static_assert(toLongIEEE754<double, FixedFormat<7, 4>>(toArray("0001234.5600")) == 0x40934A3D70A3D70A);
+    static_assert(toLongIEEE754<double, FixedFormat<1, 18>>(toArray("1.000000000000000111")) ==
+                  0x3FF0000000000000);
+
+    // Digit separators
+    static_assert(toLongIEEE754<double, DecimalCommaFormat>(toArray("1,000_000_000_000_000_111_022_302_5")) ==
+                  0x3FF0000000000001);
+
+    // The exponent of the digits and the explicit exponent are added without wrapping around, and saturated
+    static_assert(toLongIEEE754<float>(toArray("123456789012345678901234567890e32760")) == 0x7F800000);
+    static_assert(toLongIEEE754<float>(toArray("-123456789012345678901234567890e32760")) == 0xFF800000);
+    static_assert(toLongIEEE754<double>(toArray("0.0000001e-2147483647")) == 0x0);
+    static_assert(toLongIEEE754<double>(toArray("1234567e2147483647")) == 0x7FF0000000000000);
+    static_assert(toLongIEEE754<float>(longNumber<40000>("", '1', "")) == 0x7F800000);
+    static_assert(toLongIEEE754<float>(longNumber<40003>("0.", '0', "1")) == 0x0);
+
+    // The explicit exponent is parsed in 64 bits whatever the type, and only overflows beyond
+    static_assert(toParsedSize<float>(toArray("1e40000")) == 7);
+    static_assert(toParsedSize<double>(toArray("1e40000")) == 7);
+    static_assert(toParsedSize<float>(toArray("1e-40000")) == 8);
+    static_assert(toParsedSize<double>(toArray("1e-40000")) == 8);
+    static_assert(toParsedSize<float>(toArray("1e99999999999999999999")) == 0);
+    static_assert(toParsedSize<double>(toArray("1e99999999999999999999")) == 0);
+    static_assert(toLongIEEE754<float>(toArray("1e40000")) == 0x7F800000);
+    static_assert(toLongIEEE754<double>(toArray("1e40000")) == 0x7FF0000000000000);
+    static_assert(toLongIEEE754<float>(toArray("1e-40000")) == 0x0);
+    static_assert(toLongIEEE754<double>(toArray("1e-40000")) == 0x0);
+
+    // Even beyond the exponent range, digits can be compensated by the explicit exponent
+    static_assert(toLongIEEE754<float>(longNumber<30007>("", '1', "e-29995")) == 0x462D9C72);
+    static_assert(toLongIEEE754<float>(longNumber<30010>("0.", '0', "15e30000")) == 0x3E19999A);
+}
+
+template<typename V, typename T>
+constexpr inline auto toDecimal(const T& s)
+{
+    const auto result = NumericalParser<const char>(s).template parseDecimal<V>();
+    if constexpr (std::is_same_v<V, Decimal64>) {
+        return std::make_tuple(result.value.bits, result.error);
+    } else {
+        return std::make_tuple(result.value.value, result.error);
+    }
+}
+
+void testParseDecimalStatic()
+{
+    // Scaled integers, rounded half to even
+    static_assert(toDecimal<ScaledInteger<4>>(toArray("1234.56")) == std::make_tuple(12345600, ParseError::None));
+    static_assert(toDecimal<ScaledInteger<4>>(toArray("-1234.56789")) ==
+                  std::make_tuple(-12345679, ParseError::Inexact));
+    static_assert(toDecimal<ScaledInteger<2>>(toArray("0.125")) == std::make_tuple(12, ParseError::Inexact));
+    static_assert(toDecimal<ScaledInteger<2>>(toArray("0.135")) == std::make_tuple(14, ParseError::Inexact));
+    static_assert(toDecimal<ScaledInteger<0>>(toArray("12e3")) == std::make_tuple(12000, ParseError::None));
+    static_assert(toDecimal<ScaledInteger<-3>>(toArray("1500")) == std::make_tuple(2, ParseError::Inexact));
+    static_assert(toDecimal<ScaledInteger<4>>(toArray("0.00005")) == std::make_tuple(0, ParseError::Underflow));
+    static_assert(toDecimal<ScaledInteger<4>>(toArray("0.000050000000000000000000001")) ==
+                  std::make_tuple(1, ParseError::Inexact));
+
+    // Limits, the value being saturated upon overflow
+    static_assert(toDecimal<ScaledInteger<4>>(toArray("922337203685477.5807")) ==
+                  std::make_tuple(std::numeric_limits<std::int64_t>::max(), ParseError::None));
+    static_assert(toDecimal<ScaledInteger<4>>(toArray("922337203685477.5808")) ==
+                  std::make_tuple(std::numeric_limits<std::int64_t>::max(), ParseError::Overflow));
+    static_assert(toDecimal<ScaledInteger<4>>(toArray("-922337203685477.5808")) ==
+                  std::make_tuple(std::numeric_limits<std::int64_t>::min(), ParseError::None));
+    static_assert(toDecimal<ScaledInteger<0>>(toArray("9223372036854775806.5")) ==
+                  std::make_tuple(std::numeric_limits<std::int64_t>::max() - 1, ParseError::Inexact));
+    static_assert(toDecimal<ScaledInteger<0>>(toArray("9223372036854775806.50000000000000000001")) ==
+                  std::make_tuple(std::numeric_limits<std::int64_t>::max(), ParseError::Inexact));
+    static_assert(toDecimal<ScaledInteger<0>>(toArray("1e19")) ==
+                  std::make_tuple(std::numeric_limits<std::int64_t>::max(), ParseError::Overflow));
+
+    // Decimal64, the parsed exponent being kept
+    static_assert(toDecimal<Decimal64>(toArray("1")) == std::make_tuple(0x31C0000000000001, ParseError::None));
+    static_assert(toDecimal<Decimal64>(toArray("-1.50")) == std::make_tuple(0xB180000000000096, ParseError::None));
+    static_assert(toDecimal<Decimal64>(toArray("9999999999999999e369")) ==
+                  std::make_tuple(0x77FB86F26FC0FFFF, ParseError::None));
+    static_assert(toDecimal<Decimal64>(toArray("1e384")) == std::make_tuple(0x5FE38D7EA4C68000, ParseError::None));
+    static_assert(toDecimal<Decimal64>(toArray("1e385")) ==
+                  std::make_tuple(0x7800000000000000, ParseError::Overflow));
+
+    // Decimal64 rounding to sixteen digits, and to the subnormal range
+    static_assert(toDecimal<Decimal64>(toArray("12345678901234565")) ==
+                  std::make_tuple(0x31E462D53C8ABAC0, ParseError::Inexact));
+    static_assert(toDecimal<Decimal64>(toArray("12345678901234575")) ==
+                  std::make_tuple(0x31E462D53C8ABAC2, ParseError::Inexact));
+    static_assert(toDecimal<Decimal64>(toArray("123456789012345650000000000000000000000001")) ==
+                  std::make_tuple(0x350462D53C8ABAC1, ParseError::Inexact));
+    static_assert(toDecimal<Decimal64>(toArray("1e-398")) == std::make_tuple(0x1, ParseError::None));
+    static_assert(toDecimal<Decimal64>(toArray("2.5e-398")) == std::make_tuple(0x2, ParseError::Inexact));
+    static_assert(toDecimal<Decimal64>(toArray("5e-399")) == std::make_tuple(0x0, ParseError::Underflow));
+
+    // Special values, and errors
+    static_assert(toDecimal<Decimal64>(toArray("-inf")) == std::make_tuple(0xF800000000000000, ParseError::None));
+    static_assert(toDecimal<Decimal64>(toArray("nan")) == std::make_tuple(0x7C00000000000000, ParseError::None));
+    static_assert(toDecimal<ScaledInteger<4>>(toArray("inf")) == std::make_tuple(0, ParseError::InvalidCharacter));
+    static_assert(toDecimal<ScaledInteger<4>>(toArray("1e99999999999999")) ==
+                  std::make_tuple(std::numeric_limits<std::int64_t>::max(), ParseError::Overflow));
+    static_assert(toDecimal<ScaledInteger<4>>(toArray("1e99999999999999999999")) ==
+                  std::make_tuple(std::numeric_limits<std::int64_t>::max(), ParseError::ExponentOverflow));
+    static_assert(toDecimal<ScaledInteger<4>>(toArray("")) == std::make_tuple(0, ParseError::Empty));
+    static_assert(toDecimal<ScaledInteger<4>>(toArray("1.5x")) ==
+                  std::make_tuple(0, ParseError::InvalidCharacter));
+}
+
 template<typename T>
 constexpr inline auto toMantissaExponent(const T& s)
 {
@@ -303,6 +655,16 @@ constexpr inline std::uint64_t toIEEE754Double(const T& s)
     return toMantissaExponent(s).convertTwobase().toIEEE754();
 }
 
+// Parse and convert to base 2, correctly rounded whatever the number of digits (the parsed mantissa being
+// truncated to its leading digits, convertTwobase() alone may not be)
+template<typename T>
+constexpr inline auto toTwobase(const T& s)
+{
+    const NumericalParser<const char> parser(s);
+    const auto [parsed, number, kind] = parser.parseNumber<double>();
+    return parser.convertTwobase(number, parsed);
+}
+
 void testParseDoubleStaticIEEE754()
 {
     // Values are based on an external sources:
@@ -338,7 +700,7 @@ void testParseDoubleStaticIEEE754()
     static_assert(toMantissaExponent(toArray("12345678901234567890123456789012345678901234567890123456789012345678"
                                              "90123456789012345678901234567890"))
                       .convertTwobase()
-                      .mantissa == 0b0010000011111110000010111010000101111111010001101001);
+                      .mantissa == 0b10010000011111110000010111010000101111111010001101001UL);
 
     static_assert(toMantissaExponent(toArray("0.123456789012345678901234567890123456789012345678901234"))
                       .convertTwobase()
@@ -381,8 +743,9 @@ void testParseDoubleStaticIEEE754()
 
     static_assert(1.00000000000000011105 > 1);
     static_assert(toMantissaExponent(toArray("1.00000000000000011105")).convertTwobase().exponent == 0);
-    static_assert(toMantissaExponent(toArray("1.00000000000000011105")).convertTwobase().mantissa ==
+    static_assert(toTwobase(toArray("1.00000000000000011105")).mantissa ==
                   0b10000000000000000000000000000000000000000000000000001UL);
+    // The truncated mantissa (1.000000000000000111) is below the half-way point
     static_assert(toMantissaExponent(toArray("1.00000000000000011105")).convertTwobase().mantissa ==
                   0b10000000000000000000000000000000000000000000000000000UL);
 
@@ -390,8 +753,8 @@ void testParseDoubleStaticIEEE754()
     static_assert(toMantissaExponent(toArray("1.00000000000000011110")).convertTwobase().exponent == 0);
     static_assert(toMantissaExponent(toArray("1.00000000000000011110")).convertTwobase().mantissa ==
                   0b10000000000000000000000000000000000000000000000000001UL);
-    static_assert(toMantissaExponent(toArray("1.00000000000000011110")).convertTwobase().mantissa ==
-                  0b10000000000000000000000000000000000000000000000000000UL);
+    static_assert(toTwobase(toArray("1.00000000000000011110")).mantissa ==
+                  0b10000000000000000000000000000000000000000000000000001UL);
 
     static_assert(1.000000000000000148 > 1);
     static_assert(toMantissaExponent(toArray("1.000000000000000148")).convertTwobase().exponent == 0);
@@ -481,8 +844,10 @@ void testParseDoubleStaticIEEE754Binary()
     static_assert(toMantissaExponent(toArray("3.518437208883201171875E+013")).convertTwobase().toIEEE754() ==
                   0x42c0000000000002);
 
+    // Just below half the smallest subnormal, which all the digits round to zero (the parsed mantissa, rounded on
+    // its next digit to 2.470328229206232721E-324, is just above it, and alone rounds up)
     static_assert(
-        toMantissaExponent(
+        toTwobase(
             toArray(
                 "0."
                 "0000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
@@ -491,7 +856,6 @@ void testParseDoubleStaticIEEE754Binary()
                 "0000000000000000000000000000000024703282292062327208828439643411068618252990130716238221279284125"
                 "0337753635104375932649918180817996189898282347722858865463328355177969898199387398005390939063150"
                 "3565951557022639229085839244910518443593180284993653615250031937045767824"))
-            .convertTwobase()
             .toIEEE754() == 0);
 
     static_assert(toMantissaExponent(toArray("1.00000005960464477550")).convertTwobase().toIEEE754() ==
@@ -531,10 +895,13 @@ void testParseDoubleStaticIEEE754Binary()
     static_assert(toMantissaExponent(toArray("1.000000000000000111022")).convertTwobase().toIEEE754() ==
                   0x3FF0000000000000);
 
+    // Beyond the digits held by the parsed mantissa (which alone rounds down): only the exact path rounds up
     static_assert(toMantissaExponent(toArray("1.00000000000000011102230246252")).convertTwobase().toIEEE754() ==
-                  0x3FF0000000000001);
+                  0x3FF0000000000000);
+    static_assert(toTwobase(toArray("1.00000000000000011102230246252")).toIEEE754() == 0x3FF0000000000001);
     static_assert(toMantissaExponent(toArray("1.00000000000000011105")).convertTwobase().toIEEE754() ==
-                  0x3FF0000000000001);
+                  0x3FF0000000000000);
+    static_assert(toTwobase(toArray("1.00000000000000011105")).toIEEE754() == 0x3FF0000000000001);
     static_assert(toMantissaExponent(toArray("1.00000000000000011113072267976")).convertTwobase().toIEEE754() ==
                   0x3FF0000000000001);
 
@@ -555,3 +922,317 @@ void testParseDoubleStaticIEEE754Binary()
     static_assert(toMantissaExponent(toArray("1.7976931348623157E308")).convertTwobase().toIEEE754() ==
                   0x7FEFFFFFFFFFFFFF);
 }
+
+// Reference bit-by-bit normalization (the historical convertTwobase loop), for equivalence tests.
+template<typename N>
+constexpr auto normalizeLoop(bool negative,
+                             typename IEEE754Number<N, 10>::ReducedMantissa varmantissa,
+                             typename IEEE754Number<N, 10>::Exponent twoexponent)
+{
+    using Number = IEEE754Number<N, 10>;
+    using ReducedMantissa = typename Number::ReducedMantissa;
+    using Exponent = typename Number::Exponent;
+    using BinaryNumber = IEEE754BinaryNumber<N>;
+
+    if (varmantissa == 0) {
+        return IEEE754Number<N, 2>(negative, 0, 0);
+    }
+
+    constexpr std::size_t mantissaBitsKept = Number::Traits::mantissaBits + 1;
+    Exponent position = mantissaBitsKept - 1;
+    while (varmantissa >= (ReducedMantissa{ 1 } << mantissaBitsKept)) {
+        divideBy(varmantissa, ReducedMantissa{ 2 });
+        position++;
+    }
+    while (varmantissa < (ReducedMantissa{ 1 } << (mantissaBitsKept - 1)) &&
+           twoexponent + position > BinaryNumber::exponentMin) {
+        varmantissa *= 2;
+        position--;
+    }
+    twoexponent += position;
+    while (twoexponent < BinaryNumber::exponentMin) {
+        divideBy(varmantissa, ReducedMantissa{ 2 });
+        twoexponent++;
+    }
+    return IEEE754Number<N, 2>(negative, varmantissa, twoexponent);
+}
+
+// Check normalize() against the reference loop, for mantissas of any width across the exponent limits.
+// The loop rounds at each dropped bit, which is only correct up to two dropped bits (double rounding otherwise).
+template<typename N>
+constexpr bool checkNormalizeEquivalence()
+{
+    using Number = IEEE754Number<N, 10>;
+    using ReducedMantissa = typename Number::ReducedMantissa;
+    using Exponent = typename Number::Exponent;
+    using BinaryNumber = IEEE754BinaryNumber<N>;
+
+    constexpr Exponent mantissaBits = Number::Traits::mantissaBits;
+    constexpr Exponent widths[] = {
+        1, 2, 3, 17, mantissaBits, mantissaBits + 1, mantissaBits + 2, mantissaBits + 3,
+    };
+    constexpr std::uint64_t patterns[] = { 0, ~std::uint64_t{ 0 }, 0x5555555555555555, 0x9E3779B97F4A7C15 };
+    constexpr Exponent lowest = BinaryNumber::exponentSubnormalMin - mantissaBits - 8;
+    constexpr Exponent exponents[] = { -8, 0, 8, BinaryNumber::exponentMax - mantissaBits, lowest, lowest + 4,
+                                       BinaryNumber::exponentSubnormalMin - 2, BinaryNumber::exponentSubnormalMin,
+                                       BinaryNumber::exponentMin - mantissaBits - 1,
+                                       BinaryNumber::exponentMin - mantissaBits };
+
+    for (const auto width : widths) {
+        for (const auto pattern : patterns) {
+            // Leading bit, and pattern below
+            const ReducedMantissa leading = ReducedMantissa{ 1 } << (width - 1);
+            const ReducedMantissa varmantissa = leading | (ReducedMantissa{ pattern } & (leading - 1));
+            for (const auto twoexponent : exponents) {
+                const auto expected = normalizeLoop<N>(false, varmantissa, twoexponent);
+                const auto number = Number::normalize(false, varmantissa, twoexponent);
+
+                // Number of dropped bits
+                const Exponent dropped = number.exponent - mantissaBits - twoexponent;
+                if (dropped > 2) {
+                    continue;
+                }
+                if (number.mantissa != expected.mantissa || number.exponent != expected.exponent) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void testNormalizeStatic()
+{
+    static_assert(checkNormalizeEquivalence<double>());
+    static_assert(checkNormalizeEquivalence<float>());
+
+    // Exact numbers
+    static_assert(IEEE754Number<double, 10>::normalize(false, 1, 0).toIEEE754() == 0x3FF0000000000000);
+    static_assert(IEEE754Number<double, 10>::normalize(true, 5, 0).toIEEE754() == 0xC014000000000000);
+    static_assert(IEEE754Number<double, 10>::normalize(false, __uint128_t{ 1 } << 127, -127).toIEEE754() ==
+                  0x3FF0000000000000);
+    static_assert(IEEE754Number<double, 10>::normalize(false, 1, -1074).toIEEE754() == 0x1);
+    static_assert(IEEE754Number<double, 10>::normalize(false, 1, 1024).toIEEE754() == 0x7FF0000000000000);
+
+    // Half-way cases, rounded to even
+    static_assert(IEEE754Number<double, 10>::normalize(false, 1, -1075).toIEEE754() == 0x0);
+    static_assert(IEEE754Number<double, 10>::normalize(false, 3, -1075).toIEEE754() == 0x2);
+    static_assert(IEEE754Number<double, 10>::normalize(false, (std::uint64_t{ 1 } << 54) | 0b01, -54)
+                      .toIEEE754() == 0x3FF0000000000000);
+    static_assert(IEEE754Number<double, 10>::normalize(false, (std::uint64_t{ 1 } << 54) | 0b11, -54)
+                      .toIEEE754() == 0x3FF0000000000001);
+    static_assert(IEEE754Number<double, 10>::normalize(false, (std::uint64_t{ 1 } << 54) | 0b110, -54)
+                      .toIEEE754() == 0x3FF0000000000002);
+
+    // Rounding carry to the next exponent
+    static_assert(IEEE754Number<double, 10>::normalize(false, (std::uint64_t{ 1 } << 54) - 1, -53).toIEEE754() ==
+                  0x4000000000000000);
+
+    // Sticky bits: the reference loop suffers from double rounding here (0b0111 is rounded to 0b1000, and
+    // then rounded again to even), while the dropped bits 0b0111 are below half-way
+    static_assert(normalizeLoop<double>(false, (std::uint64_t{ 1 } << 56) | 0b10111, -56).toIEEE754() ==
+                  0x3FF0000000000002);
+    static_assert(IEEE754Number<double, 10>::normalize(false, (std::uint64_t{ 1 } << 56) | 0b10111, -56)
+                      .toIEEE754() == 0x3FF0000000000001);
+    static_assert(IEEE754Number<double, 10>::normalize(false, (__uint128_t{ 1 } << 120) | 1, -120).toIEEE754() ==
+                  0x3FF0000000000000);
+    static_assert(IEEE754Number<double, 10>::normalize(false, (__uint128_t{ 3 } << 67) | 1, -120).toIEEE754() ==
+                  0x3CB8000000000000);
+}
+
+void testParseDoubleStaticExact()
+{
+    static_assert(toMantissaExponent(toArray("12.5")).exactConversion());
+    static_assert(toMantissaExponent(toArray("0.001")).exactConversion());
+    static_assert(toMantissaExponent(toArray("1234.56")).exactConversion());
+    static_assert(toMantissaExponent(toArray("9007199254740992")).exactConversion());
+    static_assert(not toMantissaExponent(toArray("9007199254740993")).exactConversion());
+    static_assert(not toMantissaExponent(toArray("1e23")).exactConversion());
+    static_assert(not toMantissaExponent(toArray("1e-23")).exactConversion());
+
+    static_assert(toMantissaExponent(toArray("0")).convertTwobaseExact().toIEEE754() == 0x0);
+    static_assert(toMantissaExponent(toArray("-0")).convertTwobaseExact().toIEEE754() == 0x8000000000000000);
+    static_assert(toMantissaExponent(toArray("1")).convertTwobaseExact().toIEEE754() == 0x3FF0000000000000);
+    static_assert(toMantissaExponent(toArray("-5")).convertTwobaseExact().toIEEE754() == 0xC014000000000000);
+    static_assert(toMantissaExponent(toArray("12.5")).convertTwobaseExact().toIEEE754() == 0x4029000000000000);
+    static_assert(toMantissaExponent(toArray("0.1")).convertTwobaseExact().toIEEE754() == 0x3FB999999999999A);
+    static_assert(toMantissaExponent(toArray("0.001")).convertTwobaseExact().toIEEE754() == 0x3F50624DD2F1A9FC);
+    static_assert(toMantissaExponent(toArray("1234.56")).convertTwobaseExact().toIEEE754() == 0x40934A3D70A3D70A);
+    static_assert(toMantissaExponent(toArray("3.141592653589793")).convertTwobaseExact().toIEEE754() ==
+                  0x400921FB54442D18);
+    static_assert(toMantissaExponent(toArray("1e22")).convertTwobaseExact().toIEEE754() == 0x4480F0CF064DD592);
+    static_assert(toMantissaExponent(toArray("9007199254740992e-22")).convertTwobaseExact().toIEEE754() ==
+                  toMantissaExponent(toArray("9007199254740992e-22")).convertTwobase().toIEEE754());
+    static_assert(toMantissaExponent(toArray("4503599627370497e22")).convertTwobaseExact().toIEEE754() ==
+                  toMantissaExponent(toArray("4503599627370497e22")).convertTwobase().toIEEE754());
+
+    // Single precision
+    static_assert(std::get<1>(NumericalParser<const char>(toArray("0.1")).parseMantissaExponent<float>())
+                      .convertTwobaseExact()
+                      .toIEEE754() == 0x3DCCCCCD);
+    static_assert(std::get<1>(NumericalParser<const char>(toArray("16777216e-10")).parseMantissaExponent<float>())
+                      .convertTwobaseExact()
+                      .toIEEE754() == 0x3ADBE6FF);
+    static_assert(std::get<1>(NumericalParser<const char>(toArray("16777217")).parseMantissaExponent<float>())
+                      .convertTwobaseExact()
+                      .toIEEE754() == 0x4B800000);
+    static_assert(std::get<1>(NumericalParser<const char>(toArray("16777219")).parseMantissaExponent<float>())
+                      .convertTwobaseExact()
+                      .toIEEE754() == 0x4B800002);
+    static_assert(
+        std::get<1>(NumericalParser<const char>(toArray("9007199254740991e-22")).parseMantissaExponent<float>())
+            .convertTwobaseExact()
+            .toIEEE754() == 0x3571C901);
+
+    // Exactness of the conversion (see NumericalParser::parse())
+    static_assert(toMantissaExponent(toArray("0")).exactlyConverted(0x0));
+    static_assert(toMantissaExponent(toArray("12.5")).exactlyConverted(0x4029000000000000));
+    static_assert(toMantissaExponent(toArray("12.500")).exactlyConverted(0x4029000000000000));
+    static_assert(toMantissaExponent(toArray("1e22")).exactlyConverted(0x4480F0CF064DD592));
+    static_assert(toMantissaExponent(toArray("3.0517578125e-05")).exactlyConverted(0x3F00000000000000));
+    static_assert(toMantissaExponent(toArray("9007199254740992")).exactlyConverted(0x4340000000000000));
+    static_assert(not toMantissaExponent(toArray("9007199254740993")).exactlyConverted(0x4340000000000000));
+    static_assert(not toMantissaExponent(toArray("0.1")).exactlyConverted(0x3FB999999999999A));
+    static_assert(not toMantissaExponent(toArray("1e23")).exactlyConverted(0x44B52D02C7E14AF6));
+    static_assert(not toMantissaExponent(toArray("1e-400")).exactlyConverted(0x0));
+    static_assert(not toMantissaExponent(toArray("1e400")).exactlyConverted(0x7FF0000000000000));
+    static_assert(
+        IEEE754Number<double, 10>::exactDigits(0x4450000000000000, BigInteger<2>::powerOfTwo(70), 0, false));
+    static_assert(IEEE754Number<double, 10>::exactDigits(0x3FF8000000000000, BigInteger<2>(15), -1, false));
+    static_assert(not IEEE754Number<double, 10>::exactDigits(0x3FF8000000000000, BigInteger<2>(15), -1, true));
+    static_assert(not IEEE754Number<double, 10>::exactDigits(0x3FF199999999999A, BigInteger<2>(11), -1, false));
+    static_assert(std::get<1>(NumericalParser<const char>(toArray("0.5")).parseMantissaExponent<float>())
+                      .exactlyConverted(0x3F000000));
+    static_assert(not std::get<1>(NumericalParser<const char>(toArray("0.1")).parseMantissaExponent<float>())
+                      .exactlyConverted(0x3DCCCCCD));
+}
+
+// Parse and convert to any IEEE754 type
+template<typename N, typename T>
+constexpr inline auto toIEEE754Any(const T& s)
+{
+    const NumericalParser<const char> parser(s);
+    const auto [parsed, number] = parser.parseMantissaExponent<N>();
+    return number.convertTwobase().toIEEE754();
+}
+
+#ifdef __SIZEOF_FLOAT128__
+// 128-bit integer from two 64-bit halves
+constexpr __uint128_t toUInt128(std::uint64_t high, std::uint64_t low)
+{
+    return (__uint128_t{ high } << 64) | low;
+}
+#endif
+
+void testParseStaticExtendedTypes()
+{
+#ifdef __FLT16_MANT_DIG__
+    // Half precision
+    static_assert(toIEEE754Any<_Float16>(toArray("1")) == 0x3C00);
+    static_assert(toIEEE754Any<_Float16>(toArray("0.1")) == 0x2E66);
+    static_assert(toIEEE754Any<_Float16>(toArray("-2.5")) == 0xC100);
+    static_assert(toIEEE754Any<_Float16>(toArray("65504")) == 0x7BFF);
+    static_assert(toIEEE754Any<_Float16>(toArray("65520")) == 0x7C00);
+    static_assert(toIEEE754Any<_Float16>(toArray("1e-5")) == 0x00A8);
+    static_assert(toIEEE754Any<_Float16>(toArray("6e-8")) == 0x0001);
+    static_assert(toIEEE754Any<_Float16>(toArray("1e-8")) == 0x0000);
+#endif
+
+    // Brain floating-point
+    static_assert(toIEEE754Any<BFloat16>(toArray("1")) == 0x3F80);
+    static_assert(toIEEE754Any<BFloat16>(toArray("0.1")) == 0x3DCD);
+    static_assert(toIEEE754Any<BFloat16>(toArray("-2.5")) == 0xC020);
+    static_assert(toIEEE754Any<BFloat16>(toArray("1e39")) == 0x7F80);
+    static_assert(static_cast<float>(BFloat16{ 0x3DCD }) == 0.10009765625f);
+
+#ifdef __SIZEOF_FLOAT128__
+    // Quadruple precision
+    static_assert(toIEEE754Any<__float128>(toArray("1")) == toUInt128(0x3FFF000000000000, 0x0000000000000000));
+    static_assert(toIEEE754Any<__float128>(toArray("0.1")) == toUInt128(0x3FFB999999999999, 0x999999999999999A));
+    static_assert(toIEEE754Any<__float128>(toArray("-2.5")) == toUInt128(0xC000400000000000, 0x0000000000000000));
+    static_assert(toIEEE754Any<__float128>(toArray("1e-300")) ==
+                  toUInt128(0x3C1A56E1FC2F8F35, 0x8D94DB7AC6149156));
+    static_assert(toIEEE754Any<__float128>(toArray("123456789012345678901234567890123456")) ==
+                  toUInt128(0x40737C6E3BFD70FD, 0xEEAEC417172DCBAC));
+    static_assert(toIEEE754Any<__float128>(toArray("1e4932")) ==
+                  toUInt128(0x7FFEAE596552B8FD, 0xED99D037E3D04B75));
+    static_assert(toIEEE754Any<__float128>(toArray("1.2e4932")) ==
+                  toUInt128(0x7FFF000000000000, 0x0000000000000000));
+    static_assert(toIEEE754Any<__float128>(toArray("6.4751751194380251109244389582276465e-4966")) ==
+                  toUInt128(0x0000000000000000, 0x0000000000000001));
+    static_assert(toIEEE754Any<__float128>(toArray("3e-4966")) ==
+                  toUInt128(0x0000000000000000, 0x0000000000000000));
+#endif
+}
+
+// Format an IEEE754 value, and compare with the expected string
+template<typename N, typename T = char>
+constexpr bool formatsTo(typename IEEE754Traits<N>::IntegerType value, std::basic_string_view<T> expected)
+{
+    std::array<T, NumericalFormatter<T>::maxLength> buffer{};
+    const std::size_t length =
+        NumericalFormatter<T>(buffer.data(), buffer.size()).template formatIEEE754<N>(value);
+    return std::basic_string_view<T>(buffer.data(), length) == expected;
+}
+
+// Format an IEEE754 value, and check it parses back to the same value
+template<typename N>
+constexpr bool roundTrips(typename IEEE754Traits<N>::IntegerType value)
+{
+    std::array<char, NumericalFormatter<char>::maxLength> buffer{};
+    const std::size_t length = NumericalFormatter<char>(buffer.data(), buffer.size()).formatIEEE754<N>(value);
+    const auto [parsed, number] = NumericalParser<const char>(buffer.data(), length).parseMantissaExponent<N>();
+    return parsed == length && number.convertTwobase().toIEEE754() == value;
+}
+
+void testFormatStatic()
+{
+    // Shortest decimal
+    static_assert(toShortestDecimal<double>(0x3FB999999999999A).mantissa == 1);
+    static_assert(toShortestDecimal<double>(0x3FB999999999999A).exponent == -1);
+    static_assert(toShortestDecimal<double>(0x4059000000000000).mantissa == 1);
+    static_assert(toShortestDecimal<double>(0x4059000000000000).exponent == 2);
+    static_assert(toShortestDecimal<double>(0x1).mantissa == 5);
+    static_assert(toShortestDecimal<double>(0x1).exponent == -324);
+    static_assert(toShortestDecimal<float>(0x3DCCCCCD).mantissa == 1);
+    static_assert(toShortestDecimal<float>(0x3DCCCCCD).exponent == -1);
+
+    // Formatting rules
+    static_assert(formatsTo<double>(0x0, std::string_view("0")));
+    static_assert(formatsTo<double>(0x8000000000000000, std::string_view("-0")));
+    static_assert(formatsTo<double>(0x3FF0000000000000, std::string_view("1")));
+    static_assert(formatsTo<double>(0x3FB999999999999A, std::string_view("0.1")));
+    static_assert(formatsTo<double>(0x3FD3333333333333, std::string_view("0.3")));
+    static_assert(formatsTo<double>(0x3FD5555555555555, std::string_view("0.3333333333333333")));
+    static_assert(formatsTo<double>(0x40934A3D70A3D70A, std::string_view("1234.56")));
+    static_assert(formatsTo<double>(0xC029000000000000, std::string_view("-12.5")));
+    static_assert(formatsTo<double>(0x3EB0C6F7A0B5ED8D, std::string_view("0.000001")));
+    static_assert(formatsTo<double>(0x3E7AD7F29ABCAF48, std::string_view("1e-7")));
+    static_assert(formatsTo<double>(0x444B1AE4D6E2EF50, std::string_view("1e+21")));
+    static_assert(formatsTo<double>(0x4415AF1D78B58C40, std::string_view("100000000000000000000")));
+    static_assert(formatsTo<double>(0x7E41EB2D66005835, std::string_view("1.5e+300")));
+    static_assert(formatsTo<double>(0x1, std::string_view("5e-324")));
+    static_assert(formatsTo<double>(0x0010000000000000, std::string_view("2.2250738585072014e-308")));
+    static_assert(formatsTo<double>(0x7FEFFFFFFFFFFFFF, std::string_view("1.7976931348623157e+308")));
+    static_assert(formatsTo<double>(0x7FF0000000000000, std::string_view("Inf")));
+    static_assert(formatsTo<double>(0xFFF0000000000000, std::string_view("-Inf")));
+    static_assert(formatsTo<double>(0x7FF8000000000000, std::string_view("NaN")));
+    static_assert(formatsTo<float>(0x3DCCCCCD, std::string_view("0.1")));
+    static_assert(formatsTo<float>(0x4B800000, std::string_view("16777216")));
+    static_assert(formatsTo<float>(0x7F7FFFFF, std::string_view("3.4028235e+38")));
+    static_assert(formatsTo<float>(0x1, std::string_view("1e-45")));
+    static_assert(formatsTo<double, char16_t>(0x3FB999999999999A, std::u16string_view(u"0.1")));
+    static_assert(formatsTo<double, char32_t>(0xC029000000000000, std::u32string_view(U"-12.5")));
+
+    // Too small buffer
+    static_assert(NumericalFormatter<char>(static_cast<char*>(nullptr), 0).format(1.0) == 0);
+
+    // Round-trips
+    static_assert(roundTrips<double>(0x3FB999999999999A));
+    static_assert(roundTrips<double>(0x400921FB54442D18));
+    static_assert(roundTrips<double>(0x0000000000000001));
+    static_assert(roundTrips<double>(0x000FFFFFFFFFFFFF));
+    static_assert(roundTrips<double>(0x44B52D02C7E14AF6));
+    static_assert(roundTrips<float>(0x3DCCCCCD));
+    static_assert(roundTrips<float>(0x00000001));
+}
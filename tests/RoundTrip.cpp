@@ -0,0 +1,121 @@
+/*
+ * IEEE754 constexpr parser toy. Exhaustive float round-trip test.
+ * Thanks to Algolia for giving me the opportunity to develop this toy!
+ * @maintainer Xavier Roche (xavier dot roche at algolia.com)
+ */
+
+/**
+ * Check that every finite float bit pattern round-trips through its shortest decimal representation.
+ * Usage: ieee754toy-roundtrip [--stride <n>] [--threads <n>]
+ * A stride of n only checks one bit pattern out of n; the default (1) is exhaustive.
+ */
+
+#include "NumericalParser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/** Test results. **/
+struct Results
+{
+    std::atomic<std::uint64_t> values = 0;
+    std::atomic<std::uint64_t> bytes = 0;
+    std::atomic<std::uint64_t> failures = 0;
+};
+
+/** Reported failures, at most. **/
+constexpr std::uint64_t maxReportedFailures = 16;
+
+/** Check bit patterns within [begin, end), by stride. **/
+void check(std::uint64_t begin, std::uint64_t end, std::uint64_t stride, Results& results, std::mutex& lock)
+{
+    std::uint64_t values = 0;
+    std::uint64_t bytes = 0;
+    for (std::uint64_t bits = begin; bits < end; bits += stride) {
+        const float value = std::bit_cast<float>(static_cast<std::uint32_t>(bits));
+        if (not std::isfinite(value)) {
+            continue;
+        }
+
+        // Shortest round-trip representation
+        char buffer[64];
+        const auto [last, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        const std::size_t length = last - buffer;
+
+        bool error = false;
+        const float parsed = ieee754toy::NumericalParser(buffer, length).toAnyDouble<float>(error);
+        if (error || std::bit_cast<std::uint32_t>(parsed) != bits) {
+            if (results.failures++ < maxReportedFailures) {
+                std::lock_guard<std::mutex> guard(lock);
+                std::fprintf(stderr,
+                             "failure: %.*s: expected 0x%08X, got 0x%08X%s\n",
+                             static_cast<int>(length),
+                             buffer,
+                             static_cast<unsigned>(bits),
+                             std::bit_cast<std::uint32_t>(parsed),
+                             error ? " (error)" : "");
+            }
+        }
+        values++;
+        bytes += length;
+    }
+    results.values += values;
+    results.bytes += bytes;
+}
+
+}; // namespace
+
+int main(int argc, char** argv)
+{
+    std::uint64_t stride = 1;
+    unsigned threads = std::max(std::thread::hardware_concurrency(), 1u);
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--stride") == 0) {
+            stride = std::max<std::uint64_t>(std::strtoull(argv[i + 1], nullptr, 10), 1);
+        } else if (std::strcmp(argv[i], "--threads") == 0) {
+            threads = std::max<unsigned>(std::strtoul(argv[i + 1], nullptr, 10), 1);
+        } else {
+            std::fprintf(stderr, "Usage: %s [--stride <n>] [--threads <n>]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // Split the bit patterns space into stride-aligned slices, one per thread
+    constexpr std::uint64_t patterns = std::uint64_t(1) << 32;
+    const std::uint64_t slice = (patterns / threads + stride - 1) / stride * stride;
+    Results results;
+    std::mutex lock;
+    {
+        std::vector<std::jthread> workers;
+        for (std::uint64_t begin = 0; begin < patterns; begin += slice) {
+            workers.emplace_back(check, begin, std::min(begin + slice, patterns), stride, std::ref(results),
+                                 std::ref(lock));
+        }
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%llu values checked, %llu failures, %.1f s, %.2f ns/value per thread, %.1f MB/s (%u threads)\n",
+                static_cast<unsigned long long>(results.values),
+                static_cast<unsigned long long>(results.failures),
+                seconds,
+                seconds * 1e9 * threads / std::max<std::uint64_t>(results.values, 1),
+                results.bytes / seconds / 1e6,
+                threads);
+
+    return results.failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}